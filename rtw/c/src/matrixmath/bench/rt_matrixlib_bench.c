@@ -0,0 +1,583 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matrixlib_bench.c
+ *
+ * Abstract:
+ *      Microbenchmark for the routines of rtw/c/src/matrixmath. Every
+ *      variant of MatMult, MatMultAndInc, MatDiv, lu and the forward and
+ *      backward substitutions (RR/RC/CR/CC x Dbl/Sgl where they exist) is
+ *      timed over a sweep of square sizes. One CSV record is written per
+ *      variant and size:
+ *
+ *        routine,variant,precision,n,p,isa,calls,ns_per_call,gflops,
+ *        allocs_per_call
+ *
+ *      n is the order of the square operand and p the number of columns
+ *      of the right-hand operand (n unless -rhs is given). ns_per_call is
+ *      the best of RT_BENCH_TRIALS timed batches; each batch runs for at
+ *      least -mintime milliseconds. The GFLOP/s figure counts a complex
+ *      multiply-add as 8 real operations and a real-by-complex one as 4.
+ *      allocs_per_call counts malloc/calloc/realloc calls made by one call
+ *      when the program is built with RT_BENCH_COUNT_ALLOCS (which needs a
+ *      linker that supports --wrap); it is -1 otherwise.
+ *
+ *      Usage: rt_matrixlib_bench [-sizes n1,n2,...] [-maxn n] [-rhs p]
+ *                                [-mintime ms] [-filter text] [-isa level]
+ *
+ *      -filter keeps the variants whose name (routine, variant, "_" and
+ *      precision, as in MatMultRR_Dbl or luC_Sgl) contains text, for
+ *      example -filter MatMultRR or -filter _Sgl.
+ *      -isa forces the kernel level of rt_MatrixLibSetIsa.
+ *
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+# define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rt_matrixlib.h"
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
+#ifndef CREAL_T
+# error "rt_matrixlib_bench needs the complex types of rtwtypes.h (CREAL_T)"
+#endif
+
+#define RT_BENCH_TRIALS   5
+#define RT_BENCH_MAX_SIZES 64
+
+/*==================*
+ * Allocation count *
+ *==================*/
+
+static long rtBenchAllocs = 0;
+
+#ifdef RT_BENCH_COUNT_ALLOCS
+/* Link with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc */
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t nmemb, size_t size);
+extern void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+  rtBenchAllocs++;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+  rtBenchAllocs++;
+  return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  rtBenchAllocs++;
+  return __real_realloc(ptr, size);
+}
+#endif
+
+/*===========*
+ * Variants  *
+ *===========*/
+
+typedef enum {
+  RT_BENCH_MATMULT = 0,
+  RT_BENCH_MATMULTINC,
+  RT_BENCH_MATDIV,
+  RT_BENCH_LU,
+  RT_BENCH_FWDSUB,
+  RT_BENCH_BWDSUB
+} rtBenchKind;
+
+static const char *rtBenchRoutine[] = {
+  "MatMult", "MatMultAndInc", "MatDiv", "lu",
+  "ForwardSubstitution", "BackwardSubstitution"
+};
+
+/* Operands shared by every variant; sized for the largest n and complex
+ * double elements. */
+typedef struct {
+  int_T    n;
+  int_T    p;
+  int_T    dims[3];
+  void    *a;      /* n x n, diagonally dominant   */
+  void    *b;      /* n x p                        */
+  void    *y;      /* n x p result                 */
+  void    *lu;     /* n x n work                   */
+  void    *x;      /* n x p work                   */
+  int32_T *piv;
+} rtBenchArgs;
+
+typedef void (*rtBenchFcn)(rtBenchArgs *g);
+
+typedef struct {
+  rtBenchKind kind;
+  const char *variant;
+  boolean_T   single;
+  boolean_T   aCplx;   /* left (or only) operand complex */
+  boolean_T   bCplx;   /* right operand complex          */
+  rtBenchFcn  fcn;
+} rtBenchCase;
+
+#define RT_BENCH_MATMULT_FCN(FN, TY, TA, TB)                            \
+  static void bench_##FN(rtBenchArgs *g)                                \
+  {                                                                     \
+    FN((TY *)g->y, (const TA *)g->a, (const TB *)g->b, g->dims);        \
+  }
+
+#define RT_BENCH_MATDIV_FCN(FN, TY, TA, TB, TL)                         \
+  static void bench_##FN(rtBenchArgs *g)                                \
+  {                                                                     \
+    FN((TY *)g->y, (const TA *)g->a, (const TB *)g->b, (TL *)g->lu,     \
+       g->piv, (TY *)g->x, g->dims);                                    \
+  }
+
+#define RT_BENCH_LU_FCN(FN, TA)                                         \
+  static void bench_##FN(rtBenchArgs *g)                                \
+  {                                                                     \
+    FN((TA *)g->lu, g->n, g->piv);                                      \
+  }
+
+#define RT_BENCH_FWDSUB_FCN(FN, TY, TA, TB)                             \
+  static void bench_##FN(rtBenchArgs *g)                                \
+  {                                                                     \
+    FN((TA *)g->a, (const TB *)g->b, (TY *)g->y, g->n, g->p, g->piv,    \
+       true);                                                           \
+  }
+
+#define RT_BENCH_BWDSUB_FCN(FN, TY, TA, TB)                             \
+  static void bench_##FN(rtBenchArgs *g)                                \
+  {                                                                     \
+    FN((TA *)g->a + g->n*g->n - 1, (const TB *)g->b + g->n*g->p - 1,    \
+       (TY *)g->y, g->n, g->p, false);                                  \
+  }
+
+RT_BENCH_MATMULT_FCN(rt_MatMultRR_Dbl, real_T, real_T, real_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultRC_Dbl, creal_T, real_T, creal_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultCR_Dbl, creal_T, creal_T, real_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultCC_Dbl, creal_T, creal_T, creal_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultRR_Sgl, real32_T, real32_T, real32_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultRC_Sgl, creal32_T, real32_T, creal32_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultCR_Sgl, creal32_T, creal32_T, real32_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultCC_Sgl, creal32_T, creal32_T, creal32_T)
+
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncRR_Dbl, real_T, real_T, real_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncRC_Dbl, creal_T, real_T, creal_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncCR_Dbl, creal_T, creal_T, real_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncCC_Dbl, creal_T, creal_T, creal_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncRR_Sgl, real32_T, real32_T, real32_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncRC_Sgl, creal32_T, real32_T, creal32_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncCR_Sgl, creal32_T, creal32_T, real32_T)
+RT_BENCH_MATMULT_FCN(rt_MatMultAndIncCC_Sgl, creal32_T, creal32_T, creal32_T)
+
+RT_BENCH_MATDIV_FCN(rt_MatDivRR_Dbl, real_T, real_T, real_T, real_T)
+RT_BENCH_MATDIV_FCN(rt_MatDivRC_Dbl, creal_T, real_T, creal_T, real_T)
+RT_BENCH_MATDIV_FCN(rt_MatDivCR_Dbl, creal_T, creal_T, real_T, creal_T)
+RT_BENCH_MATDIV_FCN(rt_MatDivCC_Dbl, creal_T, creal_T, creal_T, creal_T)
+RT_BENCH_MATDIV_FCN(rt_MatDivRR_Sgl, real32_T, real32_T, real32_T, real32_T)
+RT_BENCH_MATDIV_FCN(rt_MatDivRC_Sgl, creal32_T, real32_T, creal32_T, real32_T)
+RT_BENCH_MATDIV_FCN(rt_MatDivCR_Sgl, creal32_T, creal32_T, real32_T, creal32_T)
+RT_BENCH_MATDIV_FCN(rt_MatDivCC_Sgl, creal32_T, creal32_T, creal32_T, creal32_T)
+
+RT_BENCH_LU_FCN(rt_lu_real, real_T)
+RT_BENCH_LU_FCN(rt_lu_cplx, creal_T)
+RT_BENCH_LU_FCN(rt_lu_real_sgl, real32_T)
+RT_BENCH_LU_FCN(rt_lu_cplx_sgl, creal32_T)
+
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionRR_Dbl, real_T, real_T, real_T)
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionRC_Dbl, creal_T, real_T, creal_T)
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionCR_Dbl, creal_T, creal_T, real_T)
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionCC_Dbl, creal_T, creal_T, creal_T)
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionRR_Sgl, real32_T, real32_T, real32_T)
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionRC_Sgl, creal32_T, real32_T,
+                    creal32_T)
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionCR_Sgl, creal32_T, creal32_T,
+                    real32_T)
+RT_BENCH_FWDSUB_FCN(rt_ForwardSubstitutionCC_Sgl, creal32_T, creal32_T,
+                    creal32_T)
+
+RT_BENCH_BWDSUB_FCN(rt_BackwardSubstitutionRR_Dbl, real_T, real_T, real_T)
+RT_BENCH_BWDSUB_FCN(rt_BackwardSubstitutionRC_Dbl, creal_T, real_T, creal_T)
+RT_BENCH_BWDSUB_FCN(rt_BackwardSubstitutionCC_Dbl, creal_T, creal_T, creal_T)
+RT_BENCH_BWDSUB_FCN(rt_BackwardSubstitutionRR_Sgl, real32_T, real32_T,
+                    real32_T)
+RT_BENCH_BWDSUB_FCN(rt_BackwardSubstitutionRC_Sgl, creal32_T, real32_T,
+                    creal32_T)
+RT_BENCH_BWDSUB_FCN(rt_BackwardSubstitutionCC_Sgl, creal32_T, creal32_T,
+                    creal32_T)
+
+static const rtBenchCase rtBenchCases[] = {
+  {RT_BENCH_MATMULT,    "RR", false, false, false, bench_rt_MatMultRR_Dbl},
+  {RT_BENCH_MATMULT,    "RC", false, false, true,  bench_rt_MatMultRC_Dbl},
+  {RT_BENCH_MATMULT,    "CR", false, true,  false, bench_rt_MatMultCR_Dbl},
+  {RT_BENCH_MATMULT,    "CC", false, true,  true,  bench_rt_MatMultCC_Dbl},
+  {RT_BENCH_MATMULT,    "RR", true,  false, false, bench_rt_MatMultRR_Sgl},
+  {RT_BENCH_MATMULT,    "RC", true,  false, true,  bench_rt_MatMultRC_Sgl},
+  {RT_BENCH_MATMULT,    "CR", true,  true,  false, bench_rt_MatMultCR_Sgl},
+  {RT_BENCH_MATMULT,    "CC", true,  true,  true,  bench_rt_MatMultCC_Sgl},
+
+  {RT_BENCH_MATMULTINC, "RR", false, false, false,
+   bench_rt_MatMultAndIncRR_Dbl},
+  {RT_BENCH_MATMULTINC, "RC", false, false, true,
+   bench_rt_MatMultAndIncRC_Dbl},
+  {RT_BENCH_MATMULTINC, "CR", false, true,  false,
+   bench_rt_MatMultAndIncCR_Dbl},
+  {RT_BENCH_MATMULTINC, "CC", false, true,  true,
+   bench_rt_MatMultAndIncCC_Dbl},
+  {RT_BENCH_MATMULTINC, "RR", true,  false, false,
+   bench_rt_MatMultAndIncRR_Sgl},
+  {RT_BENCH_MATMULTINC, "RC", true,  false, true,
+   bench_rt_MatMultAndIncRC_Sgl},
+  {RT_BENCH_MATMULTINC, "CR", true,  true,  false,
+   bench_rt_MatMultAndIncCR_Sgl},
+  {RT_BENCH_MATMULTINC, "CC", true,  true,  true,
+   bench_rt_MatMultAndIncCC_Sgl},
+
+  {RT_BENCH_MATDIV,     "RR", false, false, false, bench_rt_MatDivRR_Dbl},
+  {RT_BENCH_MATDIV,     "RC", false, false, true,  bench_rt_MatDivRC_Dbl},
+  {RT_BENCH_MATDIV,     "CR", false, true,  false, bench_rt_MatDivCR_Dbl},
+  {RT_BENCH_MATDIV,     "CC", false, true,  true,  bench_rt_MatDivCC_Dbl},
+  {RT_BENCH_MATDIV,     "RR", true,  false, false, bench_rt_MatDivRR_Sgl},
+  {RT_BENCH_MATDIV,     "RC", true,  false, true,  bench_rt_MatDivRC_Sgl},
+  {RT_BENCH_MATDIV,     "CR", true,  true,  false, bench_rt_MatDivCR_Sgl},
+  {RT_BENCH_MATDIV,     "CC", true,  true,  true,  bench_rt_MatDivCC_Sgl},
+
+  {RT_BENCH_LU,         "R",  false, false, false, bench_rt_lu_real},
+  {RT_BENCH_LU,         "C",  false, true,  false, bench_rt_lu_cplx},
+  {RT_BENCH_LU,         "R",  true,  false, false, bench_rt_lu_real_sgl},
+  {RT_BENCH_LU,         "C",  true,  true,  false, bench_rt_lu_cplx_sgl},
+
+  {RT_BENCH_FWDSUB,     "RR", false, false, false,
+   bench_rt_ForwardSubstitutionRR_Dbl},
+  {RT_BENCH_FWDSUB,     "RC", false, false, true,
+   bench_rt_ForwardSubstitutionRC_Dbl},
+  {RT_BENCH_FWDSUB,     "CR", false, true,  false,
+   bench_rt_ForwardSubstitutionCR_Dbl},
+  {RT_BENCH_FWDSUB,     "CC", false, true,  true,
+   bench_rt_ForwardSubstitutionCC_Dbl},
+  {RT_BENCH_FWDSUB,     "RR", true,  false, false,
+   bench_rt_ForwardSubstitutionRR_Sgl},
+  {RT_BENCH_FWDSUB,     "RC", true,  false, true,
+   bench_rt_ForwardSubstitutionRC_Sgl},
+  {RT_BENCH_FWDSUB,     "CR", true,  true,  false,
+   bench_rt_ForwardSubstitutionCR_Sgl},
+  {RT_BENCH_FWDSUB,     "CC", true,  true,  true,
+   bench_rt_ForwardSubstitutionCC_Sgl},
+
+  {RT_BENCH_BWDSUB,     "RR", false, false, false,
+   bench_rt_BackwardSubstitutionRR_Dbl},
+  {RT_BENCH_BWDSUB,     "RC", false, false, true,
+   bench_rt_BackwardSubstitutionRC_Dbl},
+  {RT_BENCH_BWDSUB,     "CC", false, true,  true,
+   bench_rt_BackwardSubstitutionCC_Dbl},
+  {RT_BENCH_BWDSUB,     "RR", true,  false, false,
+   bench_rt_BackwardSubstitutionRR_Sgl},
+  {RT_BENCH_BWDSUB,     "RC", true,  false, true,
+   bench_rt_BackwardSubstitutionRC_Sgl},
+  {RT_BENCH_BWDSUB,     "CC", true,  true,  true,
+   bench_rt_BackwardSubstitutionCC_Sgl}
+};
+
+#define RT_BENCH_NUM_CASES \
+  ((int_T)(sizeof(rtBenchCases)/sizeof(rtBenchCases[0])))
+
+static const int_T rtBenchDefaultSizes[] = {
+  2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512
+};
+
+/*=========*
+ * Helpers *
+ *=========*/
+
+/* Function: rt_BenchNow =======================================================
+ * Abstract: Monotonic time in seconds.
+ */
+static double rt_BenchNow(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER freq, count;
+  (void)QueryPerformanceFrequency(&freq);
+  (void)QueryPerformanceCounter(&count);
+  return (double)count.QuadPart/(double)freq.QuadPart;
+#else
+  struct timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1.0e-9*(double)ts.tv_nsec;
+#endif
+}
+
+/* Function: rt_BenchFill ======================================================
+ * Abstract: Fill the rows x cols matrix m (real or complex, single or
+ *           double) with values in [-0.5,0.5]. When dominant is true the
+ *           real part of the diagonal is raised by rows so that the
+ *           matrix is safely nonsingular.
+ */
+static void rt_BenchFill(void      *m,
+                         int_T      rows,
+                         int_T      cols,
+                         boolean_T  single,
+                         boolean_T  cplx,
+                         boolean_T  dominant)
+{
+  const int_T stride = cplx ? 2 : 1;
+  const int_T count  = rows*cols*stride;
+  int_T i;
+
+  for (i = 0; i < count; i++) {
+    const double v = (double)rand()/(double)RAND_MAX - 0.5;
+    if (single) {
+      ((real32_T *)m)[i] = (real32_T)v;
+    } else {
+      ((real_T *)m)[i] = v;
+    }
+  }
+  if (dominant) {
+    for (i = 0; i < rows && i < cols; i++) {
+      const int_T k = (i + i*rows)*stride;
+      if (single) {
+        ((real32_T *)m)[k] += (real32_T)rows;
+      } else {
+        ((real_T *)m)[k] += (real_T)rows;
+      }
+    }
+  }
+}
+
+/* Function: rt_BenchFlops =====================================================
+ * Abstract: Real floating-point operations done by one call.
+ */
+static double rt_BenchFlops(const rtBenchCase *c, int_T n, int_T p)
+{
+  const double nn = (double)n;
+  const double pp = (double)p;
+  const double mix = (c->aCplx && c->bCplx) ? 4.0 :
+                     (c->aCplx || c->bCplx) ? 2.0 : 1.0;
+  const double luw = (c->aCplx ? 4.0 : 1.0)*(2.0*nn*nn*nn/3.0);
+
+  switch (c->kind) {
+    case RT_BENCH_MATMULT:
+      return 2.0*mix*nn*nn*pp;
+    case RT_BENCH_MATMULTINC:
+      return 2.0*mix*nn*nn*pp + (c->aCplx || c->bCplx ? 2.0 : 1.0)*nn*pp;
+    case RT_BENCH_MATDIV:
+      return luw + 2.0*mix*nn*nn*pp;
+    case RT_BENCH_LU:
+      return luw;
+    default:
+      return mix*nn*nn*pp;
+  }
+}
+
+/* Function: rt_BenchReset =====================================================
+ * Abstract: Restore the operand an in-place routine overwrites.
+ */
+static void rt_BenchReset(const rtBenchCase *c, rtBenchArgs *g)
+{
+  if (c->kind == RT_BENCH_LU) {
+    const size_t el = (c->single ? sizeof(real32_T) : sizeof(real_T)) *
+                      (c->aCplx ? 2U : 1U);
+    (void)memcpy(g->lu, g->a, (size_t)(g->n*g->n)*el);
+  }
+}
+
+/* Function: rt_BenchBatch =====================================================
+ * Abstract: Seconds taken by reps calls (each preceded by the reset of
+ *           the operands), or by reps resets alone when resetOnly is true.
+ */
+static double rt_BenchBatch(const rtBenchCase *c,
+                            rtBenchArgs       *g,
+                            long               reps,
+                            boolean_T          resetOnly)
+{
+  const double t0 = rt_BenchNow();
+  long r;
+
+  for (r = 0; r < reps; r++) {
+    rt_BenchReset(c, g);
+    if (!resetOnly) {
+      c->fcn(g);
+    }
+  }
+  return rt_BenchNow() - t0;
+}
+
+/* Function: rt_BenchRun =======================================================
+ * Abstract: Time one variant at one size and print its record.
+ */
+static void rt_BenchRun(const rtBenchCase *c,
+                        rtBenchArgs       *g,
+                        int_T              n,
+                        int_T              p,
+                        double             minTime)
+{
+  const boolean_T resets = (boolean_T)(c->kind == RT_BENCH_LU);
+  double best = -1.0;
+  double bestReset = 0.0;
+  long   reps = 1;
+  long   allocs;
+  double flops;
+  int_T  t;
+
+  g->n       = n;
+  g->p       = p;
+  g->dims[0] = n;
+  g->dims[1] = n;
+  g->dims[2] = p;
+
+  rt_BenchFill(g->a, n, n, c->single, c->aCplx, true);
+  rt_BenchFill(g->b, n, p, c->single, c->bCplx, false);
+  rt_BenchFill(g->y, n, p, c->single, c->aCplx || c->bCplx, false);
+  for (t = 0; t < n; t++) {
+    g->piv[t] = n - 1 - t;
+  }
+
+  /* warm up, count allocations of a single call */
+  rt_BenchReset(c, g);
+  allocs = rtBenchAllocs;
+  c->fcn(g);
+  allocs = rtBenchAllocs - allocs;
+#ifndef RT_BENCH_COUNT_ALLOCS
+  allocs = -1;
+#endif
+
+  while (rt_BenchBatch(c, g, reps, false) < minTime && reps < (1L << 30)) {
+    reps *= 2;
+  }
+
+  for (t = 0; t < RT_BENCH_TRIALS; t++) {
+    const double s = rt_BenchBatch(c, g, reps, false)/(double)reps;
+    if (best < 0.0 || s < best) best = s;
+    if (resets) {
+      const double r = rt_BenchBatch(c, g, reps, true)/(double)reps;
+      if (t == 0 || r < bestReset) bestReset = r;
+    }
+  }
+  best -= bestReset;
+  if (best < 1.0e-12) best = 1.0e-12;
+
+  flops = rt_BenchFlops(c, n, p);
+  (void)printf("%s,%s,%s,%d,%d,%d,%ld,%.1f,%.4f,%ld\n",
+               rtBenchRoutine[c->kind], c->variant,
+               c->single ? "Sgl" : "Dbl", (int)n, (int)p,
+               (int)rt_MatrixLibGetIsa(), reps, best*1.0e9,
+               flops/best*1.0e-9, allocs);
+  (void)fflush(stdout);
+}
+
+/* Function: rt_BenchParseSizes ================================================
+ * Abstract: Parse a comma separated list of sizes; returns the count.
+ */
+static int_T rt_BenchParseSizes(const char *s, int_T *sizes)
+{
+  int_T count = 0;
+  while (*s != '\0' && count < RT_BENCH_MAX_SIZES) {
+    char *end;
+    const long v = strtol(s, &end, 10);
+    if (end == s) break;
+    if (v > 0) sizes[count++] = (int_T)v;
+    s = (*end == ',') ? end + 1 : end;
+  }
+  return count;
+}
+
+int main(int argc, char *argv[])
+{
+  int_T       sizes[RT_BENCH_MAX_SIZES];
+  int_T       nSizes  = 0;
+  int_T       maxN    = 512;
+  int_T       rhs     = 0;
+  double      minTime = 0.02;
+  const char *filter  = NULL;
+  int_T       largest = 0;
+  rtBenchArgs g;
+  size_t      bytes;
+  int_T       i, s;
+
+  for (i = 0; i < (int_T)(sizeof(rtBenchDefaultSizes)/sizeof(int_T)); i++) {
+    sizes[nSizes++] = rtBenchDefaultSizes[i];
+  }
+
+  for (i = 1; i < argc; i++) {
+    const char *opt = argv[i];
+    const char *val = (i + 1 < argc) ? argv[i+1] : NULL;
+    if (val == NULL) {
+      (void)fprintf(stderr, "missing value for %s\n", opt);
+      return 1;
+    }
+    if (strcmp(opt, "-sizes") == 0) {
+      nSizes = rt_BenchParseSizes(val, sizes);
+    } else if (strcmp(opt, "-maxn") == 0) {
+      maxN = (int_T)atoi(val);
+    } else if (strcmp(opt, "-rhs") == 0) {
+      rhs = (int_T)atoi(val);
+    } else if (strcmp(opt, "-mintime") == 0) {
+      minTime = atof(val)*1.0e-3;
+    } else if (strcmp(opt, "-filter") == 0) {
+      filter = val;
+    } else if (strcmp(opt, "-isa") == 0) {
+      (void)rt_MatrixLibSetIsa((int_T)atoi(val));
+    } else {
+      (void)fprintf(stderr, "unknown option %s\n", opt);
+      return 1;
+    }
+    i++;
+  }
+
+  for (s = 0; s < nSizes; s++) {
+    if (sizes[s] <= maxN && sizes[s] > largest) largest = sizes[s];
+    if (rhs > 0 && rhs > largest) largest = rhs;
+  }
+  if (largest == 0) {
+    (void)fprintf(stderr, "no sizes to run\n");
+    return 1;
+  }
+
+  bytes = (size_t)largest*(size_t)largest*sizeof(creal_T);
+  g.a   = malloc(bytes);
+  g.b   = malloc(bytes);
+  g.y   = malloc(bytes);
+  g.lu  = malloc(bytes);
+  g.x   = malloc(bytes);
+  g.piv = (int32_T *)malloc((size_t)largest*sizeof(int32_T));
+  if (g.a == NULL || g.b == NULL || g.y == NULL || g.lu == NULL ||
+      g.x == NULL || g.piv == NULL) {
+    (void)fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  (void)printf("routine,variant,precision,n,p,isa,calls,ns_per_call,"
+               "gflops,allocs_per_call\n");
+
+  for (i = 0; i < RT_BENCH_NUM_CASES; i++) {
+    const rtBenchCase *c = &rtBenchCases[i];
+    if (filter != NULL) {
+      char name[64];
+      (void)sprintf(name, "%s%s_%s", rtBenchRoutine[c->kind], c->variant,
+                    c->single ? "Sgl" : "Dbl");
+      if (strstr(name, filter) == NULL) continue;
+    }
+    for (s = 0; s < nSizes; s++) {
+      const int_T n = sizes[s];
+      if (n > maxN) continue;
+      rt_BenchRun(c, &g, n, (rhs > 0) ? rhs : n, minTime);
+    }
+  }
+
+  free(g.a);
+  free(g.b);
+  free(g.y);
+  free(g.lu);
+  free(g.x);
+  free(g.piv);
+  return 0;
+}
+
+/* [EOF] rt_matrixlib_bench.c */
@@ -29,6 +29,20 @@ void rt_BackwardSubstitutionRR_Dbl(real_T          *pU,
                                    boolean_T        unit_upper)
 {
   int_T i,k;
+
+  /* pU and pb point at the last element of U and b */
+#ifdef RT_MATRIXLIB_USE_BLAS
+  if (rt_BlasTrsmRR_Dbl(pU - (N*N-1), pb - (N*P-1), x, N, P, NULL,
+                        false, unit_upper)) {
+    return;
+  }
+#endif
+
+  if (P >= RT_TRSM_MIN_RHS) {
+    rt_TrsmUpperRR_Dbl(pU - (N*N-1), pb - (N*P-1), x, N, P, unit_upper);
+    return;
+  }
+
   for(k=P; k>0; k--) {
     real_T *pUcol = pU;
     for(i=0; i<N; i++) {
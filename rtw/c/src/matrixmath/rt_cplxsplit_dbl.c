@@ -0,0 +1,463 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_cplxsplit_dbl.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines which run the complex double
+ *      precision matrix multiply and matrix division on split real/imag
+ *      panels. Interleaved creal_T operands are packed into separate
+ *      real and imaginary arrays at the API boundary so that the inner
+ *      loops are plain unit-stride multiply-adds the compiler can
+ *      vectorize, and the results are unpacked again on the way out.
+ *
+ *      The split kernels use the textbook complex product. That matches
+ *      rt_ComplexTimes_Dbl for finite operands only, so each entry point
+ *      first scans its inputs and returns false (leaving every output
+ *      untouched) when it finds Inf or NaN, or when the problem is too
+ *      small for packing to pay off. Callers then run the scalar path.
+ *
+ */
+
+#include <math.h>
+#include "rt_matrixlib.h"
+
+#ifdef CREAL_T
+
+/* Logical definitions */
+#if (!defined(__cplusplus))
+#  ifndef false
+#   define false                       (0U)
+#  endif
+#  ifndef true
+#   define true                        (1U)
+#  endif
+#endif
+
+#define RT_SPLIT_MIN(a,b) ((a) < (b) ? (a) : (b))
+
+/* Function: rt_SplitAllFinite_Dbl =============================================
+ * Abstract: Return true if none of the n doubles at x is Inf or NaN.
+ */
+static boolean_T rt_SplitAllFinite_Dbl(const real_T *x, int_T n)
+{
+  real_T s = 0.0;
+  int_T  i;
+
+  /* x-x is 0 for finite x and NaN otherwise; NaN is sticky under + */
+  for (i = 0; i < n; i++) {
+    s += x[i] - x[i];
+  }
+  return (boolean_T)(s == 0.0);
+}
+
+/* Function: rt_SplitPackPanel_Dbl =============================================
+ * Abstract: Copy the mb x kb block of the column-major matrix starting at
+ *           src (leading dimension ld) into the split panel pre/pim, one
+ *           column of RT_CPLX_SPLIT_PANEL entries per block column. src is
+ *           either interleaved complex (cplx) or real, in which case pim is
+ *           not touched.
+ */
+static void rt_SplitPackPanel_Dbl(real_T       *pre,
+                                  real_T       *pim,
+                                  const real_T *src,
+                                  boolean_T     cplx,
+                                  int_T         ld,
+                                  int_T         mb,
+                                  int_T         kb)
+{
+  int_T i, j;
+  if (cplx) {
+    for (j = 0; j < kb; j++) {
+      const real_T *s = src + 2*j*ld;
+      real_T *dre = pre + j*RT_CPLX_SPLIT_PANEL;
+      real_T *dim = pim + j*RT_CPLX_SPLIT_PANEL;
+      for (i = 0; i < mb; i++) {
+        dre[i] = s[2*i];
+        dim[i] = s[2*i+1];
+      }
+    }
+  } else {
+    for (j = 0; j < kb; j++) {
+      const real_T *s = src + j*ld;
+      real_T *dre = pre + j*RT_CPLX_SPLIT_PANEL;
+      for (i = 0; i < mb; i++) {
+        dre[i] = s[i];
+      }
+    }
+  }
+}
+
+/* Function: rt_MatMultSplit_Dbl ===============================================
+ * Abstract: y = A*B (or y += A*B when accumulate is true) for an MxK
+ *           operand A and a KxN operand B, at least one of them complex.
+ *           Pass the operand through the complex pointer (Ac, Bc) or the
+ *           real pointer (Ar, Br); the other one must be NULL.
+ *
+ *           The product is computed in MBxNB tiles of split accumulators,
+ *           walking K in panels of RT_CPLX_SPLIT_PANEL columns of A, so
+ *           every output element sums its K products in the same order as
+ *           the scalar routines.
+ *
+ *           Returns false without touching y if the operands are too small
+ *           or not all finite.
+ */
+boolean_T rt_MatMultSplit_Dbl(creal_T       *y,
+                              const creal_T *Ac,
+                              const real_T  *Ar,
+                              const creal_T *Bc,
+                              const real_T  *Br,
+                              const int_T    dims[3],
+                              boolean_T      accumulate)
+{
+  const int_T M = dims[0];
+  const int_T K = dims[1];
+  const int_T N = dims[2];
+  const boolean_T cplxA = (boolean_T)(Ac != NULL);
+  const boolean_T cplxB = (boolean_T)(Bc != NULL);
+  const real_T *A = cplxA ? (const real_T *)Ac : Ar;
+  const real_T *B = cplxB ? (const real_T *)Bc : Br;
+  real_T apre[RT_CPLX_SPLIT_PANEL*RT_CPLX_SPLIT_PANEL];
+  real_T apim[RT_CPLX_SPLIT_PANEL*RT_CPLX_SPLIT_PANEL];
+  real_T accre[RT_CPLX_SPLIT_PANEL*RT_CPLX_SPLIT_PANEL];
+  real_T accim[RT_CPLX_SPLIT_PANEL*RT_CPLX_SPLIT_PANEL];
+  int_T i0, j0, k0;
+
+  if (M < RT_CPLX_SPLIT_MIN_ROWS ||
+      (real_T)M * (real_T)K * (real_T)N < (real_T)RT_CPLX_SPLIT_MIN_WORK) {
+    return false;
+  }
+  if (!rt_SplitAllFinite_Dbl(A, (cplxA ? 2 : 1) * M * K) ||
+      !rt_SplitAllFinite_Dbl(B, (cplxB ? 2 : 1) * K * N)) {
+    return false;
+  }
+
+  for (i0 = 0; i0 < M; i0 += RT_CPLX_SPLIT_PANEL) {
+    const int_T mb = RT_SPLIT_MIN(RT_CPLX_SPLIT_PANEL, M - i0);
+
+    for (k0 = 0; k0 < N; k0 += RT_CPLX_SPLIT_PANEL) {
+      const int_T nb = RT_SPLIT_MIN(RT_CPLX_SPLIT_PANEL, N - k0);
+      int_T ii, kk;
+
+      for (kk = 0; kk < nb; kk++) {
+        for (ii = 0; ii < mb; ii++) {
+          accre[kk*RT_CPLX_SPLIT_PANEL+ii] = 0.0;
+          accim[kk*RT_CPLX_SPLIT_PANEL+ii] = 0.0;
+        }
+      }
+
+      for (j0 = 0; j0 < K; j0 += RT_CPLX_SPLIT_PANEL) {
+        const int_T kb = RT_SPLIT_MIN(RT_CPLX_SPLIT_PANEL, K - j0);
+        const int_T aoff = cplxA ? 2*(i0 + j0*M) : (i0 + j0*M);
+
+        rt_SplitPackPanel_Dbl(apre, apim, A + aoff, cplxA, M, mb, kb);
+
+        for (kk = 0; kk < nb; kk++) {
+          real_T *cre = accre + kk*RT_CPLX_SPLIT_PANEL;
+          real_T *cim = accim + kk*RT_CPLX_SPLIT_PANEL;
+          const int_T boff = j0 + (k0+kk)*K;
+          int_T jj;
+
+          for (jj = 0; jj < kb; jj++) {
+            const real_T *are = apre + jj*RT_CPLX_SPLIT_PANEL;
+            const real_T *aim = apim + jj*RT_CPLX_SPLIT_PANEL;
+
+            if (cplxA && cplxB) {
+              const real_T bre = B[2*(boff+jj)];
+              const real_T bim = B[2*(boff+jj)+1];
+              for (ii = 0; ii < mb; ii++) {
+                cre[ii] += are[ii]*bre - aim[ii]*bim;
+                cim[ii] += are[ii]*bim + aim[ii]*bre;
+              }
+            } else if (cplxA) {
+              const real_T b = B[boff+jj];
+              for (ii = 0; ii < mb; ii++) {
+                cre[ii] += are[ii]*b;
+                cim[ii] += aim[ii]*b;
+              }
+            } else {
+              const real_T bre = B[2*(boff+jj)];
+              const real_T bim = B[2*(boff+jj)+1];
+              for (ii = 0; ii < mb; ii++) {
+                cre[ii] += are[ii]*bre;
+                cim[ii] += are[ii]*bim;
+              }
+            }
+          }
+        }
+      }
+
+      /* unpack the tile into the interleaved output */
+      for (kk = 0; kk < nb; kk++) {
+        creal_T *yc = y + i0 + (k0+kk)*M;
+        const real_T *cre = accre + kk*RT_CPLX_SPLIT_PANEL;
+        const real_T *cim = accim + kk*RT_CPLX_SPLIT_PANEL;
+        if (accumulate) {
+          for (ii = 0; ii < mb; ii++) {
+            yc[ii].re += cre[ii];
+            yc[ii].im += cim[ii];
+          }
+        } else {
+          for (ii = 0; ii < mb; ii++) {
+            yc[ii].re = cre[ii];
+            yc[ii].im = cim[ii];
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/* Function: rt_SplitLU_Dbl ====================================================
+ * Abstract: In-place LU factorization of the n x n split matrix re/im with
+ *           partial pivoting. Pivot selection, row swaps and the recorded
+ *           pivot vector are identical to rt_lu_cplx; the column scaling
+ *           and trailing update run on unit-stride real and imaginary
+ *           columns.
+ */
+static void rt_SplitLU_Dbl(real_T *re, real_T *im, const int_T n, int32_T *piv)
+{
+  int_T k;
+
+  for (k = 0; k < n; k++) {
+    piv[k] = k;
+  }
+
+  for (k = 0; k < n; k++) {
+    const int_T kn = k*n;
+    int_T p = k;
+
+    /* pivot search, same metric as rt_lu_cplx */
+    {
+      int_T i;
+      real_T Amax = fabs(re[p+kn]) + fabs(im[p+kn]);
+      for (i = k+1; i < n; i++) {
+        real_T q = rt_Hypot_Dbl(re[i+kn], im[i+kn]);
+        q *= q;
+        if (q > Amax) {p = i; Amax = q;}
+      }
+    }
+
+    if (p != k) {
+      int_T j;
+      for (j = 0; j < n; j++) {
+        const int_T pjn = p+j*n;
+        const int_T kjn = k+j*n;
+        real_T t;
+        t = re[pjn]; re[pjn] = re[kjn]; re[kjn] = t;
+        t = im[pjn]; im[pjn] = im[kjn]; im[kjn] = t;
+      }
+      {
+        int32_T t = piv[p]; piv[p] = piv[k]; piv[k] = t;
+      }
+    }
+
+    if (!((re[k+kn] == 0.0) && (im[k+kn] == 0.0))) {
+      real_T *lre = re + kn;
+      real_T *lim = im + kn;
+      creal_T Adiag;
+      int_T i, j;
+
+      Adiag.re = re[k+kn];
+      Adiag.im = im[k+kn];
+      rt_ComplexReciprocal_Dbl(&Adiag, Adiag);
+
+      for (i = k+1; i < n; i++) {
+        const real_T r = lre[i];
+        lre[i] = r*Adiag.re - lim[i]*Adiag.im;
+        lim[i] = r*Adiag.im + lim[i]*Adiag.re;
+      }
+
+      for (j = k+1; j < n; j++) {
+        real_T *cre = re + j*n;
+        real_T *cim = im + j*n;
+        const real_T ure = cre[k];
+        const real_T uim = cim[k];
+        for (i = k+1; i < n; i++) {
+          cre[i] -= lre[i]*ure - lim[i]*uim;
+          cim[i] -= lre[i]*uim + lim[i]*ure;
+        }
+      }
+    }
+  }
+}
+
+/* Function: rt_SplitSolve_Dbl =================================================
+ * Abstract: Solve LUx = b in place for P right-hand sides with unit lower L
+ *           and non-unit upper U, both stored in the n x n factor lre/lim
+ *           (lim is NULL for a real factor). The right-hand sides are held
+ *           transposed, xre[k + i*P], so that every update of row i is a
+ *           unit-stride loop over the P columns. sre/sim are P-element
+ *           scratch rows. Each element accumulates its dot product in the
+ *           same order as the scalar substitution routines.
+ */
+static void rt_SplitSolve_Dbl(const real_T *lre,
+                              const real_T *lim,
+                              real_T       *xre,
+                              real_T       *xim,
+                              real_T       *sre,
+                              real_T       *sim,
+                              int_T         N,
+                              int_T         P)
+{
+  int_T i, j, k;
+
+  /* forward substitution, unit lower */
+  for (i = 0; i < N; i++) {
+    real_T *bre = xre + i*P;
+    real_T *bim = xim + i*P;
+    for (k = 0; k < P; k++) {
+      sre[k] = 0.0;
+      sim[k] = 0.0;
+    }
+    for (j = 0; j < i; j++) {
+      const real_T *yre = xre + j*P;
+      const real_T *yim = xim + j*P;
+      const real_T  l   = lre[i+j*N];
+      if (lim != NULL) {
+        const real_T li = lim[i+j*N];
+        for (k = 0; k < P; k++) {
+          sre[k] += l*yre[k] - li*yim[k];
+          sim[k] += l*yim[k] + li*yre[k];
+        }
+      } else {
+        for (k = 0; k < P; k++) {
+          sre[k] += l*yre[k];
+          sim[k] += l*yim[k];
+        }
+      }
+    }
+    for (k = 0; k < P; k++) {
+      bre[k] -= sre[k];
+      bim[k] -= sim[k];
+    }
+  }
+
+  /* backward substitution, non-unit upper */
+  for (i = N-1; i >= 0; i--) {
+    real_T *bre = xre + i*P;
+    real_T *bim = xim + i*P;
+    creal_T u;
+    for (k = 0; k < P; k++) {
+      sre[k] = 0.0;
+      sim[k] = 0.0;
+    }
+    for (j = N-1; j > i; j--) {
+      const real_T *yre = xre + j*P;
+      const real_T *yim = xim + j*P;
+      const real_T  l   = lre[i+j*N];
+      if (lim != NULL) {
+        const real_T li = lim[i+j*N];
+        for (k = 0; k < P; k++) {
+          sre[k] += l*yre[k] - li*yim[k];
+          sim[k] += l*yim[k] + li*yre[k];
+        }
+      } else {
+        for (k = 0; k < P; k++) {
+          sre[k] += l*yre[k];
+          sim[k] += l*yim[k];
+        }
+      }
+    }
+    u.re = lre[i+i*N];
+    u.im = (lim != NULL) ? lim[i+i*N] : 0.0;
+    for (k = 0; k < P; k++) {
+      creal_T cdiff;
+      creal_T c;
+      cdiff.re = bre[k] - sre[k];
+      cdiff.im = bim[k] - sim[k];
+      rt_ComplexRDivide_Dbl(&c, cdiff, u);
+      bre[k] = c.re;
+      bim[k] = c.im;
+    }
+  }
+}
+
+/* Function: rt_MatDivSplit_Dbl ================================================
+ * Abstract: Out = inv(In1)*In2 for an NxN In1 and an NxP In2, at least one of
+ *           them complex, using the caller's lu, piv and x work buffers (the
+ *           same ones rt_MatDivCC_Dbl and friends take). Each operand is
+ *           passed through its complex or its real pointer, the other being
+ *           NULL; lu must hold N*N elements of In1's type.
+ *
+ *           A complex In1 is factored in split form in the lu buffer (real
+ *           parts then imaginary parts). The right-hand sides are permuted
+ *           and packed transposed into the x buffer, solved in place, and
+ *           unpacked into Out. Once In2 has been packed, Out doubles as
+ *           scratch for two rows of P elements.
+ *
+ *           Returns false without touching Out if N is too small or any
+ *           input is not finite.
+ */
+boolean_T rt_MatDivSplit_Dbl(creal_T       *Out,
+                             const creal_T *In1c,
+                             const real_T  *In1r,
+                             const creal_T *In2c,
+                             const real_T  *In2r,
+                             real_T        *lu,
+                             int32_T       *piv,
+                             creal_T       *x,
+                             const int_T    dims[3])
+{
+  const int_T N  = dims[0];
+  const int_T P  = dims[2];
+  const int_T N2 = N * N;
+  const int_T NP = N * P;
+  real_T *lre = lu;
+  real_T *lim = NULL;
+  real_T *xre = (real_T *)x;
+  real_T *xim = xre + NP;
+  int_T i, k;
+
+  if (N < RT_CPLX_SPLIT_MIN_ROWS || P < 1) {
+    return false;
+  }
+  if (!(In1c != NULL ? rt_SplitAllFinite_Dbl((const real_T *)In1c, 2*N2)
+                     : rt_SplitAllFinite_Dbl(In1r, N2)) ||
+      !(In2c != NULL ? rt_SplitAllFinite_Dbl((const real_T *)In2c, 2*NP)
+                     : rt_SplitAllFinite_Dbl(In2r, NP))) {
+    return false;
+  }
+
+  if (In1c != NULL) {
+    lim = lre + N2;
+    for (i = 0; i < N2; i++) {
+      lre[i] = In1c[i].re;
+      lim[i] = In1c[i].im;
+    }
+    rt_SplitLU_Dbl(lre, lim, N, piv);
+  } else {
+    for (i = 0; i < N2; i++) {
+      lre[i] = In1r[i];
+    }
+    rt_lu_real(lre, N, piv);
+  }
+
+  /* permute and pack the right-hand sides transposed */
+  for (k = 0; k < P; k++) {
+    for (i = 0; i < N; i++) {
+      const int_T src = piv[i] + k*N;
+      if (In2c != NULL) {
+        xre[k + i*P] = In2c[src].re;
+        xim[k + i*P] = In2c[src].im;
+      } else {
+        xre[k + i*P] = In2r[src];
+        xim[k + i*P] = 0.0;
+      }
+    }
+  }
+
+  rt_SplitSolve_Dbl(lre, lim, xre, xim,
+                    (real_T *)Out, (real_T *)Out + P, N, P);
+
+  for (k = 0; k < P; k++) {
+    for (i = 0; i < N; i++) {
+      Out[i + k*N].re = xre[k + i*P];
+      Out[i + k*N].im = xim[k + i*P];
+    }
+  }
+  return true;
+}
+
+#endif
+/* [EOF] rt_cplxsplit_dbl.c */
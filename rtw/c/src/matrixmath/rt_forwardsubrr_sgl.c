@@ -30,6 +30,18 @@ void rt_ForwardSubstitutionRR_Sgl(real32_T       *pL,
 {
   /* Real inputs: */
   int_T i, k;
+
+#ifdef RT_MATRIXLIB_USE_BLAS
+  if (rt_BlasTrsmRR_Sgl(pL, pb, x, N, P, piv, true, unit_lower)) {
+    return;
+  }
+#endif
+
+  if (P >= RT_TRSM_MIN_RHS) {
+    rt_TrsmLowerRR_Sgl(pL, pb, x, N, P, piv, unit_lower);
+    return;
+  }
+
   for(k=0; k<P; k++) {
     real32_T *pLcol = pL;
     for(i=0; i<N; i++) {
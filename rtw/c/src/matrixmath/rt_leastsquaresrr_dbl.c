@@ -0,0 +1,178 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_leastsquaresrr_dbl.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines which solve real double precision
+ *      linear least-squares problems with the Householder QR factorization
+ *      of rt_qr_real, optionally damped (Tikhonov / Levenberg-Marquardt):
+ *
+ *        minimize ||A X - B||^2 + lambda^2 ||X||^2
+ *
+ *      for the m x n matrix A and the m x p matrix B. A may have more rows
+ *      than columns (overdetermined) or fewer (underdetermined, as for the
+ *      Jacobian of a redundant manipulator):
+ *
+ *        m >= n:  [A; lambda I] = QR,    X = R \ (Q' [B; 0])(1:n,:)
+ *        m <  n:  [A'; lambda I] = QR,   X = (Q [R' \ B; 0])(1:n,:)
+ *
+ *      With lambda = 0 the first gives the least-squares solution and the
+ *      second the minimum-norm solution; neither forms A'A or AA', so the
+ *      conditioning is that of A rather than its square.
+ *
+ *      The factorization lives in a caller-supplied rtQRWork together with
+ *      an exact copy of the A (and lambda) it was computed from. A later
+ *      call with an equal A reuses it, so a loop that solves several
+ *      right-hand sides against one Jacobian pays for one factorization.
+ *
+ *      A rank-deficient A (with lambda = 0) leads to a zero on the diagonal
+ *      of R and Inf/NaN in X, as rt_MatDivRR_Dbl does for singular input.
+ *
+ */
+
+#include <string.h>   /* needed for memcpy, memcmp */
+#include "rt_matrixlib.h"
+
+#define RT_LS_MIN(a,b) ((a) < (b) ? (a) : (b))
+
+/* Function: rt_LeastSquaresFactor =============================================
+ * Abstract: Factor [A; lambda I] (m >= n) or [A'; lambda I] (m < n) into
+ *           the work buffer unless the one stored there was computed from
+ *           the same A and lambda.
+ */
+static void rt_LeastSquaresFactor(const real_T *A,
+                                  real_T        lambda,
+                                  int_T         m,
+                                  int_T         n,
+                                  rtQRWork     *ws)
+{
+  const int_T k  = RT_LS_MIN(m, n);
+  const int_T r  = (m >= n) ? m : n;            /* rows of A or A'  */
+  const int_T mf = r + ((lambda != 0.0) ? k : 0);
+  real_T *acopy = ws->buf;
+  real_T *qr    = acopy + m*n;
+  real_T *tau   = qr + (m+n)*k;
+  int_T i, j;
+
+  if (ws->m == m && ws->n == n && ws->lambda == lambda &&
+      memcmp(acopy, A, m*n*sizeof(real_T)) == 0) {
+    return;
+  }
+
+  (void)memcpy(acopy, A, m*n*sizeof(real_T));
+  for (j = 0; j < k; j++) {
+    real_T *col = qr + j*mf;
+    if (m >= n) {
+      (void)memcpy(col, A + j*m, m*sizeof(real_T));
+    } else {
+      for (i = 0; i < n; i++) {
+        col[i] = A[j + i*m];
+      }
+    }
+    for (i = r; i < mf; i++) {
+      col[i] = (i - r == j) ? lambda : 0.0;
+    }
+  }
+
+  rt_qr_real(qr, mf, k, tau);
+
+  ws->m      = m;
+  ws->n      = n;
+  ws->lambda = lambda;
+  ws->numFactorizations++;
+}
+
+/* Function: rt_DampedLeastSquaresRR_Dbl =======================================
+ * Abstract: X (n x p) = argmin ||A X - B||^2 + lambda^2 ||X||^2 for the
+ *           m x n matrix A and the m x p matrix B. ws->buf must hold
+ *           RT_QR_WORK_LEN(m,n,p) elements; set ws->m to 0 before the
+ *           first call (or whenever buf is reassigned).
+ */
+void rt_DampedLeastSquaresRR_Dbl(real_T       *X,
+                                 const real_T *A,
+                                 const real_T *B,
+                                 real_T        lambda,
+                                 int_T         m,
+                                 int_T         n,
+                                 int_T         p,
+                                 rtQRWork     *ws)
+{
+  const int_T k  = RT_LS_MIN(m, n);
+  const int_T r  = (m >= n) ? m : n;
+  const int_T mf = r + ((lambda != 0.0) ? k : 0);
+  real_T *qr, *tau, *w;
+  int_T i, j, c;
+
+  if (m <= 0 || n <= 0 || p <= 0) {
+    return;
+  }
+
+  rt_LeastSquaresFactor(A, lambda, m, n, ws);
+  qr  = ws->buf + m*n;
+  tau = qr + (m+n)*k;
+  w   = tau + k;
+
+  if (m >= n) {
+    /* w = Q' [B; 0] */
+    for (c = 0; c < p; c++) {
+      real_T *wc = w + c*mf;
+      (void)memcpy(wc, B + c*m, m*sizeof(real_T));
+      for (i = m; i < mf; i++) {
+        wc[i] = 0.0;
+      }
+    }
+    rt_QRApplyQt_Dbl(qr, tau, w, mf, k, p);
+
+    /* X = R \ w(0:n-1,:) */
+    for (c = 0; c < p; c++) {
+      const real_T *wc = w + c*mf;
+      real_T       *xc = X + c*n;
+      for (i = n-1; i >= 0; i--) {
+        real_T s = wc[i];
+        for (j = i+1; j < n; j++) {
+          s -= qr[i + j*mf]*xc[j];
+        }
+        xc[i] = s/qr[i + i*mf];
+      }
+    }
+  } else {
+    /* w(0:m-1,:) = R' \ B, rest zero */
+    for (c = 0; c < p; c++) {
+      const real_T *bc = B + c*m;
+      real_T       *wc = w + c*mf;
+      for (i = 0; i < m; i++) {
+        real_T s = bc[i];
+        for (j = 0; j < i; j++) {
+          s -= qr[j + i*mf]*wc[j];
+        }
+        wc[i] = s/qr[i + i*mf];
+      }
+      for (i = m; i < mf; i++) {
+        wc[i] = 0.0;
+      }
+    }
+
+    /* X = (Q w)(0:n-1,:) */
+    rt_QRApplyQ_Dbl(qr, tau, w, mf, k, p);
+    for (c = 0; c < p; c++) {
+      (void)memcpy(X + c*n, w + c*mf, n*sizeof(real_T));
+    }
+  }
+}
+
+/* Function: rt_LeastSquaresRR_Dbl =============================================
+ * Abstract: Least-squares (m >= n) or minimum-norm (m < n) solution of
+ *           A X = B; rt_DampedLeastSquaresRR_Dbl with lambda = 0.
+ */
+void rt_LeastSquaresRR_Dbl(real_T       *X,
+                           const real_T *A,
+                           const real_T *B,
+                           int_T         m,
+                           int_T         n,
+                           int_T         p,
+                           rtQRWork     *ws)
+{
+  rt_DampedLeastSquaresRR_Dbl(X, A, B, 0.0, m, n, p, ws);
+}
+
+/* [EOF] rt_leastsquaresrr_dbl.c */
@@ -10,6 +10,8 @@
 #include <math.h>
 #include "rt_matrixlib.h"
 
+#define RT_PAR_LU_MIN(a,b) ((a) < (b) ? (a) : (b))
+
 /* Function: rt_lu_real  =======================================================
  * Abstract: A is real.
  *
@@ -20,6 +22,12 @@ void rt_lu_real(real_T      *A,    /* in and out                         */
 {
   int_T k;
 
+#ifdef RT_MATRIXLIB_USE_BLAS
+  if (rt_BlasLU_Dbl(A, n, piv)) {
+    return;
+  }
+#endif
+
   /* initialize row-pivot indices: */
   for (k = 0; k < n; k++) {
     piv[k] = k;
@@ -29,6 +37,12 @@ void rt_lu_real(real_T      *A,    /* in and out                         */
   for (k = 0; k < n; k++) {
     const int_T kn = k*n;
     int_T p = k;
+#ifdef RT_MATRIXLIB_THREADS
+    /* Columns k1 and up are updated once per panel of columns */
+    const int_T k0 = k - k % RT_MATRIXLIB_LU_PANEL;
+    const int_T k1 = (n < RT_KERNEL_MIN_ROWS) ? n :
+                     RT_PAR_LU_MIN(k0 + RT_MATRIXLIB_LU_PANEL, n);
+#endif
 
     /* Scan the lower triangular part of this column only
      * Record row of largest value
@@ -68,14 +82,29 @@ void rt_lu_real(real_T      *A,    /* in and out                         */
         }
 
         /* subtract multiple of column from remaining columns */
-        for (j = k+1; j < n; j++) {
-          int_T j_n = j*n;
-          for (i = k+1; i < n; i++) {
-            A[i+j_n] -= A[i+kn]*A[k+j_n];
+        if (n >= RT_KERNEL_MIN_ROWS) {
+#ifdef RT_MATRIXLIB_THREADS
+          rt_MatrixLibKernels()->luUpdateTile_Dbl(A, n, k, k+1, n, k+1, k1);
+#else
+          rt_MatrixLibKernels()->luUpdate_Dbl(A, n, k);
+#endif
+        } else {
+          for (j = k+1; j < n; j++) {
+            int_T j_n = j*n;
+            for (i = k+1; i < n; i++) {
+              A[i+j_n] -= A[i+kn]*A[k+j_n];
+            }
           }
         }
       }
     }
+
+#ifdef RT_MATRIXLIB_THREADS
+    /* panel done: update the columns to its right */
+    if (k == k1-1 && k1 < n) {
+      rt_ParLuPanelUpdate_Dbl(A, n, k0, k1);
+    }
+#endif
   }
 }
 
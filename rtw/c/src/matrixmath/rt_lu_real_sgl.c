@@ -20,6 +20,12 @@ void rt_lu_real_sgl(real32_T      *A,    /* in and out                         *
 {
   int_T k;
 
+#ifdef RT_MATRIXLIB_USE_BLAS
+  if (rt_BlasLU_Sgl(A, n, piv)) {
+    return;
+  }
+#endif
+
   /* initialize row-pivot indices: */
   for (k = 0; k < n; k++) {
     piv[k] = k;
@@ -68,10 +74,14 @@ void rt_lu_real_sgl(real32_T      *A,    /* in and out                         *
         }
 
         /* subtract multiple of column from remaining columns */
-        for (j = k+1; j < n; j++) {
-          int_T j_n = j*n;
-          for (i = k+1; i < n; i++) {
-            A[i+j_n] -= A[i+kn]*A[k+j_n];
+        if (n >= RT_KERNEL_MIN_ROWS) {
+          rt_MatrixLibKernels()->luUpdate_Sgl(A, n, k);
+        } else {
+          for (j = k+1; j < n; j++) {
+            int_T j_n = j*n;
+            for (i = k+1; i < n; i++) {
+              A[i+j_n] -= A[i+kn]*A[k+j_n];
+            }
           }
         }
       }
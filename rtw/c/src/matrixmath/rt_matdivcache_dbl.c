@@ -0,0 +1,173 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matdivcache_dbl.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines for a small LU factorization cache
+ *      used by rt_MatDivRR_Dbl when RT_MATDIV_LU_CACHE is defined.
+ *
+ *      Each slot is keyed on the address and order of the left operand
+ *      and keeps an exact copy of its contents next to the LU factors and
+ *      pivots computed from it. A lookup only hits when the operand at
+ *      that address still compares equal to the copy, so a tunable or
+ *      slowly changing matrix costs an O(n^2) compare on the fast path
+ *      instead of an O(n^3) factorization. Operands larger than
+ *      RT_MATDIV_LU_CACHE_MAXN are never cached. A hit copies the factors
+ *      into the caller's work buffers, so those always hold the LU of
+ *      In1 after the call, as they do without the cache.
+ *
+ *      The cache is static storage shared by every caller. When
+ *      RT_MATRIXLIB_THREADS is defined on a POSIX platform it is guarded
+ *      by a mutex, so several model instances or the matrix library pool
+ *      may use it at once; otherwise it must only be used from one thread.
+ *
+ */
+
+#if defined(RT_MATRIXLIB_THREADS) && !defined(_WIN32)
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# define RT_LUC_PTHREADS
+# include <pthread.h>
+#endif
+
+#include <string.h>   /* needed for memcpy, memcmp */
+#include "rt_matrixlib.h"
+
+#ifdef RT_LUC_PTHREADS
+static pthread_mutex_t rtLUCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+# define RT_LUC_LOCK()   (void)pthread_mutex_lock(&rtLUCacheMutex)
+# define RT_LUC_UNLOCK() (void)pthread_mutex_unlock(&rtLUCacheMutex)
+#else
+# define RT_LUC_LOCK()
+# define RT_LUC_UNLOCK()
+#endif
+
+#define RT_LUC_N2 (RT_MATDIV_LU_CACHE_MAXN*RT_MATDIV_LU_CACHE_MAXN)
+
+typedef struct {
+  const real_T *key;                             /* address of In1     */
+  int_T         n;                               /* 0 when slot unused */
+  uint32_T      lastUse;
+  real_T        a[RT_LUC_N2];                    /* copy of In1        */
+  real_T        lu[RT_LUC_N2];
+  int32_T       piv[RT_MATDIV_LU_CACHE_MAXN];
+} rtMatDivLUCacheSlot;
+
+static rtMatDivLUCacheSlot rtLUCache[RT_MATDIV_LU_CACHE_SLOTS];
+static uint32_T            rtLUCacheTick   = 0U;
+static uint32_T            rtLUCacheHits   = 0U;
+static uint32_T            rtLUCacheMisses = 0U;
+
+/* Function: rt_MatDivRRCacheLookup_Dbl ========================================
+ * Abstract: If a slot for the NxN matrix In1 holds a copy equal to its
+ *           current contents, copy the cached LU factors into lu and the
+ *           pivots into piv and return true, otherwise return false and
+ *           leave lu and piv untouched. Operands that are never cached
+ *           return false without counting a miss.
+ */
+boolean_T rt_MatDivRRCacheLookup_Dbl(const real_T *In1,
+                                     int_T         N,
+                                     real_T       *lu,
+                                     int32_T      *piv)
+{
+  boolean_T hit = false;
+  int_T s;
+
+  if (N <= 0 || N > RT_MATDIV_LU_CACHE_MAXN) {
+    return false;
+  }
+
+  RT_LUC_LOCK();
+  for (s = 0; s < RT_MATDIV_LU_CACHE_SLOTS; s++) {
+    rtMatDivLUCacheSlot *slot = &rtLUCache[s];
+    if (slot->key == In1 && slot->n == N) {
+      if (memcmp(slot->a, In1, N*N*sizeof(real_T)) == 0) {
+        slot->lastUse = ++rtLUCacheTick;
+        (void)memcpy(lu, slot->lu, N*N*sizeof(real_T));
+        (void)memcpy(piv, slot->piv, N*sizeof(int32_T));
+        hit = true;
+      }
+      break;
+    }
+  }
+  if (hit) {
+    rtLUCacheHits++;
+  } else {
+    rtLUCacheMisses++;
+  }
+  RT_LUC_UNLOCK();
+  return hit;
+}
+
+/* Function: rt_MatDivRRCacheStore_Dbl =========================================
+ * Abstract: Remember lu/piv as the factorization of the NxN matrix In1,
+ *           replacing the slot already keyed on In1 or else the least
+ *           recently used one.
+ */
+void rt_MatDivRRCacheStore_Dbl(const real_T  *In1,
+                               const real_T  *lu,
+                               const int32_T *piv,
+                               int_T          N)
+{
+  rtMatDivLUCacheSlot *slot = &rtLUCache[0];
+  int_T s;
+
+  if (N <= 0 || N > RT_MATDIV_LU_CACHE_MAXN) {
+    return;
+  }
+
+  RT_LUC_LOCK();
+  for (s = 0; s < RT_MATDIV_LU_CACHE_SLOTS; s++) {
+    if (rtLUCache[s].key == In1) {
+      slot = &rtLUCache[s];
+      break;
+    }
+    if (rtLUCache[s].lastUse < slot->lastUse) {
+      slot = &rtLUCache[s];
+    }
+  }
+
+  slot->key     = In1;
+  slot->n       = N;
+  slot->lastUse = ++rtLUCacheTick;
+  (void)memcpy(slot->a, In1, N*N*sizeof(real_T));
+  (void)memcpy(slot->lu, lu, N*N*sizeof(real_T));
+  (void)memcpy(slot->piv, piv, N*sizeof(int32_T));
+  RT_LUC_UNLOCK();
+}
+
+/* Function: rt_MatDivRRCacheStats_Dbl =========================================
+ * Abstract: Report the number of lookups that reused a factorization and
+ *           the number of misses. A miss is a lookup of a cacheable
+ *           operand (1 <= N <= RT_MATDIV_LU_CACHE_MAXN) whose address is
+ *           not cached or whose contents changed, so that In1 had to be
+ *           factored again. Larger operands are not counted.
+ */
+void rt_MatDivRRCacheStats_Dbl(uint32_T *hits, uint32_T *misses)
+{
+  RT_LUC_LOCK();
+  if (hits != NULL) *hits = rtLUCacheHits;
+  if (misses != NULL) *misses = rtLUCacheMisses;
+  RT_LUC_UNLOCK();
+}
+
+/* Function: rt_MatDivRRCacheReset_Dbl =========================================
+ * Abstract: Drop every cached factorization and clear the counters.
+ */
+void rt_MatDivRRCacheReset_Dbl(void)
+{
+  int_T s;
+  RT_LUC_LOCK();
+  for (s = 0; s < RT_MATDIV_LU_CACHE_SLOTS; s++) {
+    rtLUCache[s].key     = NULL;
+    rtLUCache[s].n       = 0;
+    rtLUCache[s].lastUse = 0U;
+  }
+  rtLUCacheTick   = 0U;
+  rtLUCacheHits   = 0U;
+  rtLUCacheMisses = 0U;
+  RT_LUC_UNLOCK();
+}
+
+/* [EOF] rt_matdivcache_dbl.c */
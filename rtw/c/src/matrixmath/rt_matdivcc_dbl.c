@@ -41,6 +41,11 @@ void rt_MatDivCC_Dbl(creal_T       *Out,
   const boolean_T unit_upper = false;
   const boolean_T unit_lower = true;
 
+  if (rt_MatDivSplit_Dbl(Out, In1, NULL, In2, NULL,
+                         (real_T *)lu, piv, x, dims)) {
+    return;
+  }
+
   (void)memcpy(lu, In1, N2*sizeof(real_T)*2);
 
   rt_lu_cplx(lu, N, piv);
@@ -31,6 +31,11 @@ void rt_MatDivCR_Dbl(creal_T       *Out,
   const boolean_T unit_upper = false;
   const boolean_T unit_lower = true;
 
+  if (rt_MatDivSplit_Dbl(Out, In1, NULL, NULL, In2,
+                         (real_T *)lu, piv, x, dims)) {
+    return;
+  }
+
   (void)memcpy(lu, In1, N2*sizeof(real_T)*2);
 
   rt_lu_cplx(lu, N, piv);
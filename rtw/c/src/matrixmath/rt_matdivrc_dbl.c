@@ -31,6 +31,10 @@ void rt_MatDivRC_Dbl(creal_T       *Out,
   const boolean_T unit_upper = false;
   const boolean_T unit_lower = true;
 
+  if (rt_MatDivSplit_Dbl(Out, NULL, In1, In2, NULL, lu, piv, x, dims)) {
+    return;
+  }
+
   (void)memcpy(lu, In1, N2*sizeof(real_T));
 
   rt_lu_real(lu, N, piv);
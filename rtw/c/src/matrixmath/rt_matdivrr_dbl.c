@@ -15,6 +15,9 @@
  * Function: rt_MatDivRR_Dbl
  * Abstract:
  *      2-real double input matrix division function
+ *      With RT_MATDIV_LU_CACHE defined, the LU factors of an In1 whose
+ *      address and contents match a cached one are copied into lu/piv
+ *      and only the triangular solves are performed.
  */
 void rt_MatDivRR_Dbl(real_T        *Out,
                      const real_T  *In1,
@@ -31,9 +34,26 @@ void rt_MatDivRR_Dbl(real_T        *Out,
   const boolean_T unit_upper = false;
   const boolean_T unit_lower = true;
 
+#if defined(RT_MATDIV_MIXED_PRECISION) && !defined(RT_MATDIV_LU_CACHE)
+  /* Single precision LU plus refinement, double LU if that stalls */
+  if (N >= RT_MATDIV_MIXED_MIN_N &&
+      rt_MatDivRRMixed_Dbl(Out, In1, In2, lu, piv, x, dims)) {
+    return;
+  }
+#endif
+
+#ifdef RT_MATDIV_LU_CACHE
+  /* Reuse the factorization of an unchanged In1 if one is cached */
+  if (!rt_MatDivRRCacheLookup_Dbl(In1, N, lu, piv)) {
+    (void)memcpy(lu, In1, N2*sizeof(real_T));
+    rt_lu_real(lu, N, piv);
+    rt_MatDivRRCacheStore_Dbl(In1, lu, piv, N);
+  }
+#else
   (void)memcpy(lu, In1, N2*sizeof(real_T));
 
   rt_lu_real(lu, N, piv);
+#endif
 
   rt_ForwardSubstitutionRR_Dbl(lu, In2, x, N, P, piv, unit_lower);
 
@@ -0,0 +1,205 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matdivrrmixed_dbl.c
+ *
+ * Abstract:
+ *      Simulink Coder support routine which solves In1*Out = In2 for real
+ *      double precision operands by mixed-precision iterative refinement,
+ *      used by rt_MatDivRR_Dbl when RT_MATDIV_MIXED_PRECISION is defined.
+ *
+ *      In1 is rounded to single precision and factored with
+ *      rt_lu_real_sgl, which runs at twice the SIMD width of the double
+ *      factorization. The single precision solution is then corrected
+ *      with residuals In2 - In1*Out computed in double precision by
+ *      rt_MatMultRR_Dbl until every column satisfies the backward error
+ *      test of LAPACK DSGESV:
+ *
+ *        ||r||_inf <= ||x||_inf * ||In1||_inf * eps * sqrt(N)
+ *
+ *      The routine gives up (returns false) when an operand does not fit
+ *      in single precision, the single precision factor is singular, the
+ *      residual stops decreasing or RT_MATDIV_MIXED_MAX_ITER corrections
+ *      were not enough; the caller then solves with a double precision
+ *      LU factorization. This is the case for ill-conditioned In1
+ *      (roughly cond(In1) > 1e6), so only well-conditioned systems take
+ *      the fast path.
+ *
+ *      No memory is allocated: the single precision factor and two
+ *      single precision column vectors live in the caller's lu buffer
+ *      (N*N doubles) and the residuals in x.
+ *
+ */
+
+#include <math.h>
+#include <float.h>
+#include "rt_matrixlib.h"
+
+/* Logical definitions */
+#if (!defined(__cplusplus))
+#  ifndef false
+#   define false                       (0U)
+#  endif
+#  ifndef true
+#   define true                        (1U)
+#  endif
+#endif
+
+/* Function: rt_MixedToSgl =====================================================
+ * Abstract: dst = single(src) for n elements; false if one overflows.
+ */
+static boolean_T rt_MixedToSgl(real32_T *dst, const real_T *src, int_T n)
+{
+  int_T i;
+  for (i = 0; i < n; i++) {
+    if (fabs(src[i]) > (real_T)FLT_MAX) {
+      return false;
+    }
+    dst[i] = (real32_T)src[i];
+  }
+  return true;
+}
+
+/* Function: rt_MixedSolveSgl ==================================================
+ * Abstract: Solve (LU) d = r for one column in single precision and add
+ *           (accumulate true) or store d into the double column x.
+ */
+static boolean_T rt_MixedSolveSgl(const real32_T *luS,
+                                  const int32_T  *piv,
+                                  real32_T       *bs,
+                                  real32_T       *ys,
+                                  const real_T   *r,
+                                  real_T         *x,
+                                  int_T           N,
+                                  boolean_T       accumulate)
+{
+  int_T i;
+
+  if (!rt_MixedToSgl(bs, r, N)) {
+    return false;
+  }
+  rt_ForwardSubstitutionRR_Sgl((real32_T *)luS, bs, ys, N, 1, piv, true);
+  rt_BackwardSubstitutionRR_Sgl((real32_T *)luS + N*N - 1, ys + N - 1, bs,
+                                N, 1, false);
+  for (i = 0; i < N; i++) {
+    if (accumulate) {
+      x[i] += (real_T)bs[i];
+    } else {
+      x[i] = (real_T)bs[i];
+    }
+  }
+  return true;
+}
+
+/* Function: rt_MatDivRRMixed_Dbl ==============================================
+ * Abstract: Out (NxP) = In1 (NxN) \ In2 (NxP) to double precision accuracy
+ *           from a single precision factorization. Returns false, with
+ *           Out, lu, piv and x clobbered, if refinement does not converge.
+ */
+boolean_T rt_MatDivRRMixed_Dbl(real_T        *Out,
+                               const real_T  *In1,
+                               const real_T  *In2,
+                               real_T        *lu,
+                               int32_T       *piv,
+                               real_T        *x,
+                               const int_T    dims[3])
+{
+  const int_T N  = dims[0];
+  const int_T P  = dims[2];
+  int_T mmDims[3];
+  real32_T *luS = (real32_T *)lu;
+  real32_T *bs  = luS + N*N;
+  real32_T *ys  = bs + N;
+  real_T anrm = 0.0;
+  real_T cte;
+  real_T prevRnrm = -1.0;
+  int_T i, j, c, iter;
+
+  if (N < 2) {
+    return false;
+  }
+
+  /* ||In1||_inf */
+  for (i = 0; i < N; i++) {
+    real_T s = 0.0;
+    for (j = 0; j < N; j++) {
+      s += fabs(In1[i + j*N]);
+    }
+    if (!(s <= anrm)) anrm = s;
+  }
+  if (!(anrm <= (real_T)FLT_MAX)) {
+    return false;                       /* overflow or NaN */
+  }
+  cte = anrm*(DBL_EPSILON/2.0)*sqrt((real_T)N);
+
+  /* single precision factorization */
+  if (!rt_MixedToSgl(luS, In1, N*N)) {
+    return false;
+  }
+  rt_lu_real_sgl(luS, N, piv);
+  for (i = 0; i < N; i++) {
+    if (luS[i + i*N] == 0.0F) {
+      return false;
+    }
+  }
+
+  /* initial solution */
+  for (c = 0; c < P; c++) {
+    if (!rt_MixedSolveSgl(luS, piv, bs, ys, In2 + c*N, Out + c*N, N,
+                          false)) {
+      return false;
+    }
+  }
+
+  mmDims[0] = N;
+  mmDims[1] = N;
+  mmDims[2] = P;
+
+  for (iter = 0; iter <= RT_MATDIV_MIXED_MAX_ITER; iter++) {
+    boolean_T converged = true;
+    real_T rnrmMax = 0.0;
+
+    /* x = In2 - In1*Out in double precision */
+    rt_MatMultRR_Dbl(x, In1, Out, mmDims);
+    for (i = 0; i < N*P; i++) {
+      x[i] = In2[i] - x[i];
+    }
+
+    for (c = 0; c < P; c++) {
+      const real_T *rc = x + c*N;
+      const real_T *xc = Out + c*N;
+      real_T rnrm = 0.0;
+      real_T xnrm = 0.0;
+      for (i = 0; i < N; i++) {
+        const real_T ar = fabs(rc[i]);
+        const real_T ax = fabs(xc[i]);
+        if (!(ar <= rnrm)) rnrm = ar;
+        if (!(ax <= xnrm)) xnrm = ax;
+      }
+      if (!(rnrm <= xnrm*cte)) {
+        converged = false;
+      }
+      if (!(rnrm <= rnrmMax)) rnrmMax = rnrm;
+    }
+
+    if (converged) {
+      return true;
+    }
+    if (iter == RT_MATDIV_MIXED_MAX_ITER ||
+        !(rnrmMax == rnrmMax) ||        /* NaN */
+        (prevRnrm >= 0.0 && rnrmMax > 0.5*prevRnrm)) {
+      return false;                     /* stalled */
+    }
+    prevRnrm = rnrmMax;
+
+    /* Out += LU \ r */
+    for (c = 0; c < P; c++) {
+      if (!rt_MixedSolveSgl(luS, piv, bs, ys, x + c*N, Out + c*N, N,
+                            true)) {
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
+/* [EOF] rt_matdivrrmixed_dbl.c */
@@ -25,6 +25,11 @@ void rt_MatMultAndIncCC_Dbl(creal_T       *y,
                             const int_T     dims[3])
 {
   int_T k;
+
+  if (rt_MatMultSplit_Dbl(y, A, NULL, B, NULL, dims, true)) {
+    return;
+  }
+
   for(k=dims[2]; k-- > 0; ) {
     const creal_T *A1 = A;
     int_T i;
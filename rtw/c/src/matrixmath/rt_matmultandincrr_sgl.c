@@ -23,6 +23,18 @@ void rt_MatMultAndIncRR_Sgl(real32_T       *y,
                             const int_T      dims[3])
 {
   int_T k;
+
+#ifdef RT_MATRIXLIB_USE_BLAS
+  if (rt_BlasMatMultRR_Sgl(y, A, B, dims, true)) {
+    return;
+  }
+#endif
+
+  if (dims[0] >= RT_KERNEL_MIN_ROWS) {
+    rt_MatrixLibKernels()->gemmRR_Sgl(y, A, B, dims, true);
+    return;
+  }
+
   for(k=dims[2]; k-- > 0; ) {
     const real32_T *A1 = A;
     int_T i;
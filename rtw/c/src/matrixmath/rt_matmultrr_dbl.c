@@ -23,6 +23,24 @@ void rt_MatMultRR_Dbl(real_T       *y,
                    const int_T    dims[3])
 {
   int_T k;
+
+#ifdef RT_MATRIXLIB_USE_BLAS
+  if (rt_BlasMatMultRR_Dbl(y, A, B, dims, false)) {
+    return;
+  }
+#endif
+
+#ifdef RT_MATRIXLIB_THREADS
+  if (rt_ParMatMultRR_Dbl(y, A, B, dims, false)) {
+    return;
+  }
+#endif
+
+  if (dims[0] >= RT_KERNEL_MIN_ROWS) {
+    rt_MatrixLibKernels()->gemmRR_Dbl(y, A, B, dims, false);
+    return;
+  }
+
   for(k=dims[2]; k-- > 0; ) {
     const real_T *A1 = A;
     int_T i;
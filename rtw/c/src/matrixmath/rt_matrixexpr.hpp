@@ -0,0 +1,743 @@
+#ifndef rt_matrixexpr_hpp
+#define rt_matrixexpr_hpp
+
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File    : rt_matrixexpr.hpp
+ * Abstract:
+ *     Header-only C++ front-end to the real routines of rt_matrixlib.h.
+ *     Matrix expressions are built lazily and evaluated when assigned, so
+ *     a chain such as
+ *
+ *       tau = J.transpose()*K*(xd - x) + D*(vd - v);
+ *
+ *     runs as one loop nest per product, with the sums, differences,
+ *     scalings and transposes fused into the loops that read them, instead
+ *     of one rt_MatMult* call and one temporary buffer per operation.
+ *     Products of at least RT_MATRIX_EXPR_KERNEL_WORK multiply-adds are
+ *     handed to rt_MatMultRR_* / rt_MatMultAndIncRR_* instead, so large
+ *     sizes keep the blocked, ISA-dispatched (and, with
+ *     RT_MATRIXLIB_THREADS, threaded) kernels.
+ *
+ *     Element types are real_T and real32_T; storage is column major as in
+ *     the generated code. Three kinds of matrices hold data:
+ *
+ *       rt_matrix::Matrix<T,R,C>          R x C, storage inside the object
+ *       rt_matrix::BoundedMatrix<T,MR,MC> run-time size up to MR x MC,
+ *                                         storage inside the object
+ *       rt_matrix::MatrixMap<T,MR,MC>     run-time size up to MR x MC over
+ *       rt_matrix::ConstMatrixMap<T,MR,MC> a caller's buffer (for example a
+ *                                         block input, output or DWork)
+ *
+ *     Nothing allocates from the heap. The few temporaries an expression
+ *     needs (the value of a product used as an operand of another product,
+ *     or of an expression that reads its own destination through a
+ *     product or transpose) are BoundedMatrix objects on the stack, sized
+ *     from the compile-time bounds of the operands.
+ *
+ *     Requires a C++98 compiler. Operands of a + or - must have the same
+ *     size; sizes known at compile time are checked by the compiler and
+ *     the others with assert. A map may share memory with the destination
+ *     only if it is the destination itself (x = x + dx).
+ *
+ */
+
+#ifndef __cplusplus
+# error rt_matrixexpr.hpp must be compiled as C++
+#endif
+
+#include <cassert>
+#include "rt_matrixlib.h"
+
+/* Products of at least this many multiply-adds call rt_MatMultRR_* */
+#ifndef RT_MATRIX_EXPR_KERNEL_WORK
+#define RT_MATRIX_EXPR_KERNEL_WORK 4096
+#endif
+
+namespace rt_matrix {
+
+/*====================*
+ * Compile-time tools *
+ *====================*/
+
+template <bool Cond> struct StaticCheck;
+template <> struct StaticCheck<true> { enum { ok = 1 }; };
+
+template <class A, class B> struct SameType { enum { value = 0 }; };
+template <class A> struct SameType<A, A> { enum { value = 1 }; };
+
+/* Sizes agree when they are equal or one is known only at run time (0) */
+template <int_T A, int_T B> struct SizesAgree {
+  enum { value = (A == 0 || B == 0 || A == B) };
+};
+
+template <int_T A, int_T B> struct MinSize {
+  enum { value = (A < B) ? A : B };
+};
+
+template <int_T A, int_T B> struct FixedSize {
+  enum { value = (A != 0) ? A : B };
+};
+
+/* Library kernels per element type */
+template <class T> struct Kernels;
+
+template <> struct Kernels<real_T> {
+  static void mult(real_T *y, const real_T *A, const real_T *B,
+                   const int_T dims[3]) {
+    rt_MatMultRR_Dbl(y, A, B, dims);
+  }
+  static void multInc(real_T *y, const real_T *A, const real_T *B,
+                      const int_T dims[3]) {
+    rt_MatMultAndIncRR_Dbl(y, A, B, dims);
+  }
+};
+
+template <> struct Kernels<real32_T> {
+  static void mult(real32_T *y, const real32_T *A, const real32_T *B,
+                   const int_T dims[3]) {
+    rt_MatMultRR_Sgl(y, A, B, dims);
+  }
+  static void multInc(real32_T *y, const real32_T *A, const real32_T *B,
+                      const int_T dims[3]) {
+    rt_MatMultAndIncRR_Sgl(y, A, B, dims);
+  }
+};
+
+/* How a value is stored into the destination. PlusOp (MinusOp) is the
+ * operation for a term added to (subtracted from) the first one.
+ */
+struct AssignOp;
+struct AddAssignOp;
+struct SubAssignOp;
+
+struct AssignOp {
+  typedef AddAssignOp PlusOp;
+  typedef SubAssignOp MinusOp;
+  enum { HasKernel = 1 };
+  template <class T> static void apply(T &d, const T &s) { d = s; }
+  template <class T> static void mult(T *y, const T *A, const T *B,
+                                      const int_T dims[3]) {
+    Kernels<T>::mult(y, A, B, dims);
+  }
+};
+
+struct AddAssignOp {
+  typedef AddAssignOp PlusOp;
+  typedef SubAssignOp MinusOp;
+  enum { HasKernel = 1 };
+  template <class T> static void apply(T &d, const T &s) { d += s; }
+  template <class T> static void mult(T *y, const T *A, const T *B,
+                                      const int_T dims[3]) {
+    Kernels<T>::multInc(y, A, B, dims);
+  }
+};
+
+struct SubAssignOp {
+  typedef SubAssignOp PlusOp;
+  typedef AddAssignOp MinusOp;
+  enum { HasKernel = 0 };
+  template <class T> static void apply(T &d, const T &s) { d -= s; }
+  template <class T> static void mult(T *, const T *, const T *,
+                                      const int_T *) {}
+};
+
+template <class E> class Transpose;
+template <class T, int_T MaxR, int_T MaxC> class BoundedMatrix;
+
+/* Class: MatrixBase ===========================================================
+ * Abstract: Base of every matrix and expression type (CRTP). A derived
+ *           type E provides
+ *
+ *             Scalar, Nested            element type; how a parent holds E
+ *             Rows, Cols                compile-time size, 0 if run time
+ *             MaxRows, MaxCols          compile-time upper bound of the size
+ *             HasProduct, HasTranspose  E contains such a node
+ *             IsDirect                  E is contiguous column-major data
+ *             rows(), cols(), coeff(i,j)
+ *             aliases(lo, hi)           E reads memory in [lo, hi)
+ *             evalTo(dst, op)           dst op= E for a matrix dst
+ */
+template <class Derived> class MatrixBase {
+ public:
+  const Derived &derived() const {
+    return *static_cast<const Derived *>(this);
+  }
+
+  const Transpose<Derived> transpose() const {
+    return Transpose<Derived>(derived());
+  }
+};
+
+/* Function: rt_EvalCoeffwise ==================================================
+ * Abstract: d(i,j) op= e(i,j), one fused pass over the destination.
+ */
+template <class E, class Dst, class Op>
+inline void rt_EvalCoeffwise(const E &e, Dst &d, Op) {
+  const int_T M = e.rows();
+  const int_T N = e.cols();
+  int_T i, j;
+
+  assert(d.rows() == M && d.cols() == N);
+  for (j = 0; j < N; j++) {
+    for (i = 0; i < M; i++) {
+      Op::apply(d.coeffRef(i, j), e.coeff(i, j));
+    }
+  }
+}
+
+/* Function: rt_Assign =========================================================
+ * Abstract: d op= e. An expression that reads d through a product or a
+ *           transpose is first evaluated into a stack temporary.
+ */
+template <class Dst, class E, class Op>
+inline void rt_Assign(Dst &d, const E &e, Op op) {
+  typedef typename E::Scalar T;
+  enum { ok = StaticCheck<SameType<T, typename Dst::Scalar>::value>::ok +
+              StaticCheck<SizesAgree<Dst::Rows, E::Rows>::value>::ok +
+              StaticCheck<SizesAgree<Dst::Cols, E::Cols>::value>::ok };
+  const T *lo = d.data();
+  const T *hi = lo + d.rows()*d.cols();
+
+  if ((E::HasProduct || E::HasTranspose) && e.aliases(lo, hi)) {
+    BoundedMatrix<T, E::MaxRows, E::MaxCols> t(e.rows(), e.cols());
+    e.evalTo(t, AssignOp());
+    rt_EvalCoeffwise(t, d, op);
+  } else {
+    e.evalTo(d, op);
+  }
+}
+
+/* Class: DenseBase ============================================================
+ * Abstract: Element access and assignment shared by the types that hold or
+ *           map contiguous column-major data.
+ */
+template <class Derived, class T, int_T R, int_T C, int_T MaxR, int_T MaxC>
+class DenseBase : public MatrixBase<Derived> {
+ public:
+  typedef T Scalar;
+  typedef const Derived &Nested;
+  enum { Rows = R, Cols = C, MaxRows = MaxR, MaxCols = MaxC,
+         HasProduct = 0, HasTranspose = 0, IsDirect = 1 };
+
+  T coeff(int_T i, int_T j) const {
+    return self().data()[i + j*self().rows()];
+  }
+  T &coeffRef(int_T i, int_T j) {
+    return self().data()[i + j*self().rows()];
+  }
+  T operator()(int_T i, int_T j) const { return coeff(i, j); }
+  T &operator()(int_T i, int_T j) { return coeffRef(i, j); }
+
+  /* linear (column-major) index, for vectors */
+  T operator[](int_T k) const { return self().data()[k]; }
+  T &operator[](int_T k) { return self().data()[k]; }
+
+  boolean_T aliases(const T *lo, const T *hi) const {
+    const T *p = self().data();
+    return (p < hi && lo < p + self().rows()*self().cols());
+  }
+
+  template <class Dst, class Op> void evalTo(Dst &d, Op op) const {
+    rt_EvalCoeffwise(self(), d, op);
+  }
+
+  void setZero() { setConstant(T(0)); }
+
+  void setConstant(T v) {
+    const int_T n = self().rows()*self().cols();
+    int_T k;
+    for (k = 0; k < n; k++) {
+      self().data()[k] = v;
+    }
+  }
+
+  void setIdentity() {
+    const int_T n = (self().rows() < self().cols()) ?
+        self().rows() : self().cols();
+    int_T k;
+    setZero();
+    for (k = 0; k < n; k++) {
+      coeffRef(k, k) = T(1);
+    }
+  }
+
+ private:
+  const Derived &self() const { return *static_cast<const Derived *>(this); }
+  Derived &self() { return *static_cast<Derived *>(this); }
+};
+
+/* Class: Matrix ===============================================================
+ * Abstract: R x C matrix with its elements inside the object. The default
+ *           constructor leaves them uninitialized, like a C array.
+ */
+template <class T, int_T R, int_T C>
+class Matrix : public DenseBase<Matrix<T, R, C>, T, R, C, R, C> {
+  typedef DenseBase<Matrix<T, R, C>, T, R, C, R, C> Base;
+ public:
+  Matrix() {}
+
+  explicit Matrix(const T *src) {
+    int_T k;
+    for (k = 0; k < R*C; k++) {
+      data_[k] = src[k];
+    }
+  }
+
+  template <class E> Matrix(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), AssignOp());
+  }
+
+  template <class E> Matrix &operator=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), AssignOp());
+    return *this;
+  }
+  template <class E> Matrix &operator+=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), AddAssignOp());
+    return *this;
+  }
+  template <class E> Matrix &operator-=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), SubAssignOp());
+    return *this;
+  }
+
+  int_T rows() const { return R; }
+  int_T cols() const { return C; }
+  T *data() { return data_; }
+  const T *data() const { return data_; }
+
+ private:
+  T data_[R*C];
+};
+
+/* Class: BoundedMatrix ========================================================
+ * Abstract: Matrix of run-time size up to MaxR x MaxC with its elements
+ *           inside the object. Assigning an expression resizes it.
+ */
+template <class T, int_T MaxR, int_T MaxC>
+class BoundedMatrix
+    : public DenseBase<BoundedMatrix<T, MaxR, MaxC>, T, 0, 0, MaxR, MaxC> {
+ public:
+  BoundedMatrix() : rows_(0), cols_(0) {}
+
+  BoundedMatrix(int_T r, int_T c) : rows_(0), cols_(0) { resize(r, c); }
+
+  template <class E> BoundedMatrix(const MatrixBase<E> &e)
+      : rows_(0), cols_(0) {
+    resize(e.derived().rows(), e.derived().cols());
+    rt_Assign(*this, e.derived(), AssignOp());
+  }
+
+  template <class E> BoundedMatrix &operator=(const MatrixBase<E> &e) {
+    resize(e.derived().rows(), e.derived().cols());
+    rt_Assign(*this, e.derived(), AssignOp());
+    return *this;
+  }
+  template <class E> BoundedMatrix &operator+=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), AddAssignOp());
+    return *this;
+  }
+  template <class E> BoundedMatrix &operator-=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), SubAssignOp());
+    return *this;
+  }
+
+  void resize(int_T r, int_T c) {
+    assert(r >= 0 && r <= MaxR && c >= 0 && c <= MaxC);
+    rows_ = r;
+    cols_ = c;
+  }
+
+  int_T rows() const { return rows_; }
+  int_T cols() const { return cols_; }
+  T *data() { return data_; }
+  const T *data() const { return data_; }
+
+ private:
+  int_T rows_;
+  int_T cols_;
+  T     data_[(MaxR*MaxC > 0) ? MaxR*MaxC : 1];
+};
+
+/* Class: MatrixMap ============================================================
+ * Abstract: Writable view of rows x cols elements of a caller's buffer.
+ *           MaxR and MaxC bound the size for the temporaries of the
+ *           expressions that read the view.
+ */
+template <class T, int_T MaxR, int_T MaxC>
+class MatrixMap
+    : public DenseBase<MatrixMap<T, MaxR, MaxC>, T, 0, 0, MaxR, MaxC> {
+ public:
+  explicit MatrixMap(T *p, int_T r = MaxR, int_T c = MaxC)
+      : p_(p), rows_(r), cols_(c) {
+    assert(r >= 0 && r <= MaxR && c >= 0 && c <= MaxC);
+  }
+
+  /* assignment copies elements, not the view */
+  MatrixMap &operator=(const MatrixMap &m) {
+    rt_Assign(*this, m, AssignOp());
+    return *this;
+  }
+  template <class E> MatrixMap &operator=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), AssignOp());
+    return *this;
+  }
+  template <class E> MatrixMap &operator+=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), AddAssignOp());
+    return *this;
+  }
+  template <class E> MatrixMap &operator-=(const MatrixBase<E> &e) {
+    rt_Assign(*this, e.derived(), SubAssignOp());
+    return *this;
+  }
+
+  int_T rows() const { return rows_; }
+  int_T cols() const { return cols_; }
+  T *data() { return p_; }
+  const T *data() const { return p_; }
+
+ private:
+  T     *p_;
+  int_T  rows_;
+  int_T  cols_;
+};
+
+/* Class: ConstMatrixMap =======================================================
+ * Abstract: Read-only view of rows x cols elements of a caller's buffer.
+ */
+template <class T, int_T MaxR, int_T MaxC>
+class ConstMatrixMap : public MatrixBase<ConstMatrixMap<T, MaxR, MaxC> > {
+ public:
+  typedef T Scalar;
+  typedef const ConstMatrixMap &Nested;
+  enum { Rows = 0, Cols = 0, MaxRows = MaxR, MaxCols = MaxC,
+         HasProduct = 0, HasTranspose = 0, IsDirect = 1 };
+
+  explicit ConstMatrixMap(const T *p, int_T r = MaxR, int_T c = MaxC)
+      : p_(p), rows_(r), cols_(c) {
+    assert(r >= 0 && r <= MaxR && c >= 0 && c <= MaxC);
+  }
+
+  int_T rows() const { return rows_; }
+  int_T cols() const { return cols_; }
+  const T *data() const { return p_; }
+  T coeff(int_T i, int_T j) const { return p_[i + j*rows_]; }
+  T operator()(int_T i, int_T j) const { return coeff(i, j); }
+  T operator[](int_T k) const { return p_[k]; }
+
+  boolean_T aliases(const T *lo, const T *hi) const {
+    return (p_ < hi && lo < p_ + rows_*cols_);
+  }
+
+  template <class Dst, class Op> void evalTo(Dst &d, Op op) const {
+    rt_EvalCoeffwise(*this, d, op);
+  }
+
+ private:
+  const T *p_;
+  int_T    rows_;
+  int_T    cols_;
+};
+
+/*=============*
+ * Expressions *
+ *=============*/
+
+/* Class: Evaluated ============================================================
+ * Abstract: Operand of a product: a reference to E, or (Eval true) the
+ *           value of E in a stack temporary.
+ */
+template <class E, bool Eval> class Evaluated;
+
+template <class E> class Evaluated<E, false> {
+ public:
+  typedef typename E::Scalar T;
+  explicit Evaluated(const E &e) : e_(e) {}
+  T coeff(int_T i, int_T j) const { return e_.coeff(i, j); }
+  const T *data() const { return e_.data(); }
+ private:
+  const E &e_;
+};
+
+template <class E> class Evaluated<E, true> {
+ public:
+  typedef typename E::Scalar T;
+  explicit Evaluated(const E &e) : t_(e.rows(), e.cols()) {
+    e.evalTo(t_, AssignOp());
+  }
+  T coeff(int_T i, int_T j) const { return t_.coeff(i, j); }
+  const T *data() const { return t_.data(); }
+ private:
+  BoundedMatrix<T, E::MaxRows, E::MaxCols> t_;
+};
+
+/* Class: CwiseBinary ==========================================================
+ * Abstract: L + R (Sign 1) or L - R (Sign -1).
+ */
+template <class L, class R, int Sign>
+class CwiseBinary : public MatrixBase<CwiseBinary<L, R, Sign> > {
+ public:
+  typedef typename L::Scalar T;
+  typedef T Scalar;
+  typedef const CwiseBinary Nested;
+  enum { Rows = FixedSize<L::Rows, R::Rows>::value,
+         Cols = FixedSize<L::Cols, R::Cols>::value,
+         MaxRows = MinSize<L::MaxRows, R::MaxRows>::value,
+         MaxCols = MinSize<L::MaxCols, R::MaxCols>::value,
+         HasProduct = L::HasProduct || R::HasProduct,
+         HasTranspose = L::HasTranspose || R::HasTranspose,
+         IsDirect = 0,
+         ok = StaticCheck<SameType<T, typename R::Scalar>::value>::ok +
+              StaticCheck<SizesAgree<L::Rows, R::Rows>::value>::ok +
+              StaticCheck<SizesAgree<L::Cols, R::Cols>::value>::ok };
+
+  CwiseBinary(const L &l, const R &r) : l_(l), r_(r) {
+    assert(l.rows() == r.rows() && l.cols() == r.cols());
+  }
+
+  int_T rows() const { return l_.rows(); }
+  int_T cols() const { return l_.cols(); }
+  T coeff(int_T i, int_T j) const {
+    return (Sign > 0) ? l_.coeff(i, j) + r_.coeff(i, j)
+                      : l_.coeff(i, j) - r_.coeff(i, j);
+  }
+
+  boolean_T aliases(const T *lo, const T *hi) const {
+    return l_.aliases(lo, hi) || r_.aliases(lo, hi);
+  }
+
+  /* A product operand is evaluated into the destination directly and the
+   * other term added (subtracted) to it; otherwise one fused pass.
+   */
+  template <class Dst, class Op> void evalTo(Dst &d, Op op) const {
+    if (HasProduct) {
+      l_.evalTo(d, op);
+      if (Sign > 0) {
+        r_.evalTo(d, typename Op::PlusOp());
+      } else {
+        r_.evalTo(d, typename Op::MinusOp());
+      }
+    } else {
+      rt_EvalCoeffwise(*this, d, op);
+    }
+  }
+
+ private:
+  typename L::Nested l_;
+  typename R::Nested r_;
+};
+
+/* Class: Scaled ===============================================================
+ * Abstract: s * E (also -E, with s = -1).
+ */
+template <class E> class Scaled : public MatrixBase<Scaled<E> > {
+ public:
+  typedef typename E::Scalar T;
+  typedef T Scalar;
+  typedef const Scaled Nested;
+  enum { Rows = E::Rows, Cols = E::Cols,
+         MaxRows = E::MaxRows, MaxCols = E::MaxCols,
+         HasProduct = E::HasProduct, HasTranspose = E::HasTranspose,
+         IsDirect = 0 };
+
+  Scaled(T s, const E &e) : s_(s), e_(e) {}
+
+  int_T rows() const { return e_.rows(); }
+  int_T cols() const { return e_.cols(); }
+  T coeff(int_T i, int_T j) const { return s_*e_.coeff(i, j); }
+
+  boolean_T aliases(const T *lo, const T *hi) const {
+    return e_.aliases(lo, hi);
+  }
+
+  template <class Dst, class Op> void evalTo(Dst &d, Op) const {
+    const Evaluated<E, E::HasProduct> e(e_);
+    const int_T M = rows();
+    const int_T N = cols();
+    int_T i, j;
+
+    assert(d.rows() == M && d.cols() == N);
+    for (j = 0; j < N; j++) {
+      for (i = 0; i < M; i++) {
+        Op::apply(d.coeffRef(i, j), T(s_*e.coeff(i, j)));
+      }
+    }
+  }
+
+ private:
+  T s_;
+  typename E::Nested e_;
+};
+
+/* Class: Transpose ============================================================
+ * Abstract: E'.
+ */
+template <class E> class Transpose : public MatrixBase<Transpose<E> > {
+ public:
+  typedef typename E::Scalar T;
+  typedef T Scalar;
+  typedef const Transpose Nested;
+  enum { Rows = E::Cols, Cols = E::Rows,
+         MaxRows = E::MaxCols, MaxCols = E::MaxRows,
+         HasProduct = E::HasProduct, HasTranspose = 1, IsDirect = 0 };
+
+  explicit Transpose(const E &e) : e_(e) {}
+
+  int_T rows() const { return e_.cols(); }
+  int_T cols() const { return e_.rows(); }
+  T coeff(int_T i, int_T j) const { return e_.coeff(j, i); }
+
+  boolean_T aliases(const T *lo, const T *hi) const {
+    return e_.aliases(lo, hi);
+  }
+
+  template <class Dst, class Op> void evalTo(Dst &d, Op) const {
+    const Evaluated<E, E::HasProduct> e(e_);
+    const int_T M = rows();
+    const int_T N = cols();
+    int_T i, j;
+
+    assert(d.rows() == M && d.cols() == N);
+    for (j = 0; j < N; j++) {
+      for (i = 0; i < M; i++) {
+        Op::apply(d.coeffRef(i, j), e.coeff(j, i));
+      }
+    }
+  }
+
+ private:
+  typename E::Nested e_;
+};
+
+/* Class: Product ==============================================================
+ * Abstract: L * R. Operands that are themselves products are evaluated
+ *           once into stack temporaries; the rest are read in place.
+ *           Small products run as a fused loop nest over the operand
+ *           expressions, large ones call rt_MatMultRR_* (or
+ *           rt_MatMultAndIncRR_* for +=) on contiguous operands.
+ */
+template <class L, class R> class Product : public MatrixBase<Product<L, R> > {
+ public:
+  typedef typename L::Scalar T;
+  typedef T Scalar;
+  typedef const Product Nested;
+  enum { Rows = L::Rows, Cols = R::Cols,
+         MaxRows = L::MaxRows, MaxCols = R::MaxCols,
+         HasProduct = 1,
+         HasTranspose = L::HasTranspose || R::HasTranspose,
+         IsDirect = 0,
+         ok = StaticCheck<SameType<T, typename R::Scalar>::value>::ok +
+              StaticCheck<SizesAgree<L::Cols, R::Rows>::value>::ok };
+
+  Product(const L &l, const R &r) : l_(l), r_(r) {
+    assert(l.cols() == r.rows());
+  }
+
+  int_T rows() const { return l_.rows(); }
+  int_T cols() const { return r_.cols(); }
+
+  /* Element access recomputes an inner product; evalTo is the fast path */
+  T coeff(int_T i, int_T j) const {
+    const int_T K = l_.cols();
+    T acc = T(0);
+    int_T k;
+    for (k = 0; k < K; k++) {
+      acc += l_.coeff(i, k)*r_.coeff(k, j);
+    }
+    return acc;
+  }
+
+  boolean_T aliases(const T *lo, const T *hi) const {
+    return l_.aliases(lo, hi) || r_.aliases(lo, hi);
+  }
+
+  template <class Dst, class Op> void evalTo(Dst &d, Op op) const {
+    const int_T M = rows();
+    const int_T K = l_.cols();
+    const int_T N = cols();
+
+    assert(d.rows() == M && d.cols() == N);
+    if ((real_T)M*K*N >= (real_T)RT_MATRIX_EXPR_KERNEL_WORK) {
+      const Evaluated<L, !L::IsDirect> l(l_);
+      const Evaluated<R, !R::IsDirect> r(r_);
+      int_T dims[3];
+      dims[0] = M;
+      dims[1] = K;
+      dims[2] = N;
+      if (Op::HasKernel) {
+        Op::mult(d.data(), l.data(), r.data(), dims);
+      } else {
+        BoundedMatrix<T, MaxRows, MaxCols> t(M, N);
+        Kernels<T>::mult(t.data(), l.data(), r.data(), dims);
+        rt_EvalCoeffwise(t, d, op);
+      }
+    } else {
+      const Evaluated<L, L::HasProduct> l(l_);
+      const Evaluated<R, R::HasProduct> r(r_);
+      int_T i, j, k;
+      for (j = 0; j < N; j++) {
+        for (i = 0; i < M; i++) {
+          T acc = T(0);
+          for (k = 0; k < K; k++) {
+            acc += l.coeff(i, k)*r.coeff(k, j);
+          }
+          Op::apply(d.coeffRef(i, j), acc);
+        }
+      }
+    }
+  }
+
+ private:
+  typename L::Nested l_;
+  typename R::Nested r_;
+};
+
+/*===========*
+ * Operators *
+ *===========*/
+
+template <class L, class R>
+inline const CwiseBinary<L, R, 1> operator+(const MatrixBase<L> &l,
+                                            const MatrixBase<R> &r) {
+  return CwiseBinary<L, R, 1>(l.derived(), r.derived());
+}
+
+template <class L, class R>
+inline const CwiseBinary<L, R, -1> operator-(const MatrixBase<L> &l,
+                                             const MatrixBase<R> &r) {
+  return CwiseBinary<L, R, -1>(l.derived(), r.derived());
+}
+
+template <class L, class R>
+inline const Product<L, R> operator*(const MatrixBase<L> &l,
+                                     const MatrixBase<R> &r) {
+  return Product<L, R>(l.derived(), r.derived());
+}
+
+template <class E>
+inline const Scaled<E> operator*(typename E::Scalar s,
+                                 const MatrixBase<E> &e) {
+  return Scaled<E>(s, e.derived());
+}
+
+template <class E>
+inline const Scaled<E> operator*(const MatrixBase<E> &e,
+                                 typename E::Scalar s) {
+  return Scaled<E>(s, e.derived());
+}
+
+template <class E>
+inline const Scaled<E> operator-(const MatrixBase<E> &e) {
+  return Scaled<E>(typename E::Scalar(-1), e.derived());
+}
+
+template <class E>
+inline const Transpose<E> transpose(const MatrixBase<E> &e) {
+  return Transpose<E>(e.derived());
+}
+
+} /* namespace rt_matrix */
+
+#endif /* rt_matrixexpr_hpp */
+
+/* [EOF] rt_matrixexpr.hpp */
@@ -313,6 +313,339 @@ extern void rt_MatDivCC_Sgl(creal32_T       *Out,
                             const int_T      dims[3]);
 #endif
 
+/* Optional BLAS/LAPACK backend (rt_matrixlib_blas.c).
+ * Define RT_MATRIXLIB_USE_BLAS to route real multiply, LU and triangular
+ * solve calls whose dimensions reach RT_BLAS_MIN_DIM (adjustable at run
+ * time with rt_MatrixLibSetBlasMinDim) to the system BLAS/LAPACK.
+ */
+#ifdef RT_MATRIXLIB_USE_BLAS
+
+/* Fortran INTEGER of the BLAS/LAPACK build (int for LP64 libraries).
+ * LU factorizations are only routed when it has the size of int32_T.
+ */
+#ifndef RT_BLAS_INT
+#define RT_BLAS_INT              int
+#endif
+
+#ifndef RT_BLAS_MIN_DIM
+#define RT_BLAS_MIN_DIM          64
+#endif
+
+extern void rt_MatrixLibSetBlasMinDim(int_T n);
+
+extern int_T rt_MatrixLibGetBlasMinDim(void);
+
+extern boolean_T rt_BlasMatMultRR_Dbl(real_T       *y,
+                                      const real_T *A,
+                                      const real_T *B,
+                                      const int_T   dims[3],
+                                      boolean_T     accumulate);
+
+extern boolean_T rt_BlasMatMultRR_Sgl(real32_T       *y,
+                                      const real32_T *A,
+                                      const real32_T *B,
+                                      const int_T     dims[3],
+                                      boolean_T       accumulate);
+
+extern boolean_T rt_BlasLU_Dbl(real_T      *A,
+                               const int_T n,
+                               int32_T     *piv);
+
+extern boolean_T rt_BlasLU_Sgl(real32_T    *A,
+                               const int_T n,
+                               int32_T     *piv);
+
+extern boolean_T rt_BlasTrsmRR_Dbl(const real_T  *T,
+                                   const real_T  *B,
+                                   real_T        *X,
+                                   int_T          N,
+                                   int_T          P,
+                                   const int32_T *piv,
+                                   boolean_T      lower,
+                                   boolean_T      unit);
+
+extern boolean_T rt_BlasTrsmRR_Sgl(const real32_T *T,
+                                   const real32_T *B,
+                                   real32_T       *X,
+                                   int_T           N,
+                                   int_T           P,
+                                   const int32_T  *piv,
+                                   boolean_T       lower,
+                                   boolean_T       unit);
+#endif
+
+/* Householder QR and least-squares solves (rt_qr_real.c,
+ * rt_leastsquaresrr_dbl.c)
+ */
+
+/* Columns per panel of the blocked factorization */
+#ifndef RT_QR_BLOCK
+#define RT_QR_BLOCK              16
+#endif
+
+/* real_T elements of rtQRWork.buf for an m x n A and p right-hand sides */
+#define RT_QR_WORK_LEN(m,n,p) \
+  ((m)*(n) + ((m)+(n)+1)*((m) < (n) ? (m) : (n)) + ((m)+(n))*(p))
+
+typedef struct {
+  real_T   *buf;                /* RT_QR_WORK_LEN(m,n,p) elements       */
+  int_T     m;                  /* size of the stored factorization,    */
+  int_T     n;                  /*   m = 0 when there is none           */
+  real_T    lambda;             /* damping of the stored factorization  */
+  uint32_T  numFactorizations;
+} rtQRWork;
+
+extern void rt_qr_real(real_T      *A,
+                       const int_T  m,
+                       const int_T  n,
+                       real_T      *tau);
+
+extern void rt_QRApplyQt_Dbl(const real_T *qr,
+                             const real_T *tau,
+                             real_T       *B,
+                             int_T         m,
+                             int_T         k,
+                             int_T         p);
+
+extern void rt_QRApplyQ_Dbl(const real_T *qr,
+                            const real_T *tau,
+                            real_T       *B,
+                            int_T         m,
+                            int_T         k,
+                            int_T         p);
+
+extern void rt_LeastSquaresRR_Dbl(real_T       *X,
+                                  const real_T *A,
+                                  const real_T *B,
+                                  int_T         m,
+                                  int_T         n,
+                                  int_T         p,
+                                  rtQRWork     *ws);
+
+extern void rt_DampedLeastSquaresRR_Dbl(real_T       *X,
+                                        const real_T *A,
+                                        const real_T *B,
+                                        real_T        lambda,
+                                        int_T         m,
+                                        int_T         n,
+                                        int_T         p,
+                                        rtQRWork     *ws);
+
+/* Blocked multi-RHS triangular solves (rt_trsmrr_dbl.c, rt_trsmrr_sgl.c) */
+
+/* Rows per diagonal block */
+#ifndef RT_TRSM_BLOCK
+#define RT_TRSM_BLOCK            64
+#endif
+
+/* The substitution routines switch to the blocked solve at this many RHS */
+#ifndef RT_TRSM_MIN_RHS
+#define RT_TRSM_MIN_RHS          4
+#endif
+
+extern void rt_TrsmLowerRR_Dbl(const real_T  *L,
+                               const real_T  *B,
+                               real_T        *X,
+                               int_T          N,
+                               int_T          P,
+                               const int32_T *piv,
+                               boolean_T      unit_lower);
+
+extern void rt_TrsmUpperRR_Dbl(const real_T *U,
+                               const real_T *B,
+                               real_T       *X,
+                               int_T         N,
+                               int_T         P,
+                               boolean_T     unit_upper);
+
+extern void rt_TrsmLowerRR_Sgl(const real32_T *L,
+                               const real32_T *B,
+                               real32_T       *X,
+                               int_T           N,
+                               int_T           P,
+                               const int32_T  *piv,
+                               boolean_T       unit_lower);
+
+extern void rt_TrsmUpperRR_Sgl(const real32_T *U,
+                               const real32_T *B,
+                               real32_T       *X,
+                               int_T           N,
+                               int_T           P,
+                               boolean_T       unit_upper);
+
+/* Run-time ISA dispatch of the real kernels (rt_matrixlib_dispatch.c).
+ * rt_MatrixLibSetIsa takes one of the RT_ISA_* levels of rt_cpufeatures.h.
+ */
+
+/* Rows accumulated per stack buffer in the matrix multiply kernel */
+#ifndef RT_KERNEL_ROWS
+#define RT_KERNEL_ROWS           256
+#endif
+
+/* Below this many rows the routines keep their scalar loops */
+#ifndef RT_KERNEL_MIN_ROWS
+#define RT_KERNEL_MIN_ROWS       8
+#endif
+
+typedef struct {
+  int_T isa;
+  void (*gemmRR_Dbl)(real_T *y, const real_T *A, const real_T *B,
+                     const int_T dims[3], boolean_T accumulate);
+  void (*gemmRR_Sgl)(real32_T *y, const real32_T *A, const real32_T *B,
+                     const int_T dims[3], boolean_T accumulate);
+  void (*luUpdate_Dbl)(real_T *A, int_T n, int_T k);
+  void (*luUpdate_Sgl)(real32_T *A, int_T n, int_T k);
+  void (*trsmUpdateRR_Dbl)(real_T *X, const real_T *T, int_T N,
+                           int_T rlo, int_T rhi, int_T jlo, int_T jhi,
+                           int_T k0, int_T kb);
+  void (*trsmUpdateRR_Sgl)(real32_T *X, const real32_T *T, int_T N,
+                           int_T rlo, int_T rhi, int_T jlo, int_T jhi,
+                           int_T k0, int_T kb);
+  void (*gemmTileRR_Dbl)(real_T *y, const real_T *A, const real_T *B,
+                         const int_T dims[3], int_T i0, int_T i1,
+                         int_T c0, int_T c1, boolean_T accumulate);
+  void (*gemmTileRR_Sgl)(real32_T *y, const real32_T *A, const real32_T *B,
+                         const int_T dims[3], int_T i0, int_T i1,
+                         int_T c0, int_T c1, boolean_T accumulate);
+  void (*luUpdateTile_Dbl)(real_T *A, int_T n, int_T k,
+                           int_T i0, int_T i1, int_T j0, int_T j1);
+  void (*luUpdateTile_Sgl)(real32_T *A, int_T n, int_T k,
+                           int_T i0, int_T i1, int_T j0, int_T j1);
+} rtMatrixLibKernels;
+
+extern const rtMatrixLibKernels *rt_MatrixLibKernels(void);
+
+extern int_T rt_MatrixLibSetIsa(int_T isa);
+
+extern int_T rt_MatrixLibGetIsa(void);
+
+/* Thread pool for large real double products and LU trailing updates
+ * (rt_matrixlib_threads.c). Define RT_MATRIXLIB_THREADS, and link with
+ * -lpthread, to spread them over up to RT_MATRIXLIB_MAX_THREADS threads.
+ */
+#ifdef RT_MATRIXLIB_THREADS
+
+#ifndef RT_MATRIXLIB_MAX_THREADS
+#define RT_MATRIXLIB_MAX_THREADS 8
+#endif
+
+/* Rows per tile; at most RT_KERNEL_ROWS */
+#ifndef RT_MATRIXLIB_TILE_ROWS
+#define RT_MATRIXLIB_TILE_ROWS   64
+#endif
+
+/* Smallest product, in multiply-adds, handed to the pool */
+#ifndef RT_MATRIXLIB_PAR_MIN_WORK
+#define RT_MATRIXLIB_PAR_MIN_WORK 262144
+#endif
+
+/* Smallest LU trailing update, in elements, handed to the pool */
+#ifndef RT_MATRIXLIB_PAR_MIN_LU
+#define RT_MATRIXLIB_PAR_MIN_LU  16384
+#endif
+
+/* Columns per LU panel; the columns right of a panel are updated once */
+#ifndef RT_MATRIXLIB_LU_PANEL
+#define RT_MATRIXLIB_LU_PANEL    32
+#endif
+
+extern void rt_MatrixLibSetMaxThreads(int_T n);
+
+extern int_T rt_MatrixLibGetMaxThreads(void);
+
+extern boolean_T rt_ParMatMultRR_Dbl(real_T       *y,
+                                     const real_T *A,
+                                     const real_T *B,
+                                     const int_T   dims[3],
+                                     boolean_T     accumulate);
+
+extern void rt_ParLuPanelUpdate_Dbl(real_T *A, int_T n, int_T k0, int_T k1);
+#endif
+
+/* LU factorization cache for rt_MatDivRR_Dbl (rt_matdivcache_dbl.c).
+ * Define RT_MATDIV_LU_CACHE to let rt_MatDivRR_Dbl reuse the factorization
+ * of an unchanged left operand.
+ */
+#ifndef RT_MATDIV_LU_CACHE_SLOTS
+#define RT_MATDIV_LU_CACHE_SLOTS 4
+#endif
+
+#ifndef RT_MATDIV_LU_CACHE_MAXN
+#define RT_MATDIV_LU_CACHE_MAXN  32
+#endif
+
+extern boolean_T rt_MatDivRRCacheLookup_Dbl(const real_T *In1,
+                                            int_T         N,
+                                            real_T       *lu,
+                                            int32_T      *piv);
+
+extern void rt_MatDivRRCacheStore_Dbl(const real_T  *In1,
+                                      const real_T  *lu,
+                                      const int32_T *piv,
+                                      int_T          N);
+
+extern void rt_MatDivRRCacheStats_Dbl(uint32_T *hits,
+                                      uint32_T *misses);
+
+extern void rt_MatDivRRCacheReset_Dbl(void);
+
+/* Mixed-precision iterative refinement for rt_MatDivRR_Dbl
+ * (rt_matdivrrmixed_dbl.c). Define RT_MATDIV_MIXED_PRECISION to factor
+ * In1 in single precision from RT_MATDIV_MIXED_MIN_N upward; the LU cache
+ * (RT_MATDIV_LU_CACHE) takes precedence when both are defined.
+ */
+#ifndef RT_MATDIV_MIXED_MIN_N
+#define RT_MATDIV_MIXED_MIN_N    64
+#endif
+
+#ifndef RT_MATDIV_MIXED_MAX_ITER
+#define RT_MATDIV_MIXED_MAX_ITER 30
+#endif
+
+extern boolean_T rt_MatDivRRMixed_Dbl(real_T        *Out,
+                                      const real_T  *In1,
+                                      const real_T  *In2,
+                                      real_T        *lu,
+                                      int32_T       *piv,
+                                      real_T        *x,
+                                      const int_T    dims[3]);
+
+/* Split-complex kernels (rt_cplxsplit_dbl.c) */
+
+/* Rows/columns per packed panel; panels live on the stack */
+#ifndef RT_CPLX_SPLIT_PANEL
+#define RT_CPLX_SPLIT_PANEL      32
+#endif
+
+/* Below these sizes the scalar complex routines are used as they are */
+#ifndef RT_CPLX_SPLIT_MIN_ROWS
+#define RT_CPLX_SPLIT_MIN_ROWS   4
+#endif
+
+#ifndef RT_CPLX_SPLIT_MIN_WORK
+#define RT_CPLX_SPLIT_MIN_WORK   512
+#endif
+
+#ifdef CREAL_T
+extern boolean_T rt_MatMultSplit_Dbl(creal_T       *y,
+                                     const creal_T *Ac,
+                                     const real_T  *Ar,
+                                     const creal_T *Bc,
+                                     const real_T  *Br,
+                                     const int_T    dims[3],
+                                     boolean_T      accumulate);
+
+extern boolean_T rt_MatDivSplit_Dbl(creal_T       *Out,
+                                    const creal_T *In1c,
+                                    const real_T  *In1r,
+                                    const creal_T *In2c,
+                                    const real_T  *In2r,
+                                    real_T        *lu,
+                                    int32_T       *piv,
+                                    creal_T       *x,
+                                    const int_T    dims[3]);
+#endif
+
 
 /* Matrix multiplication defines */
 
@@ -0,0 +1,263 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matrixlib_blas.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines which route large real matrix
+ *      multiply, LU factorization and triangular solve calls to a system
+ *      BLAS/LAPACK (for example OpenBLAS). Compiled only when
+ *      RT_MATRIXLIB_USE_BLAS is defined; the program must then be linked
+ *      against the BLAS/LAPACK libraries.
+ *
+ *      Each routine returns false when the problem is smaller than the
+ *      current threshold, in which case the caller runs its own inline
+ *      kernel. rt_MatDivRR_Dbl/Sgl are built from rt_lu_real and the
+ *      substitution routines, so they are routed through the same entry
+ *      points. The pivot vector returned for an LU factorization keeps the
+ *      rt_lu_real convention (row permutation, zero based) rather than the
+ *      LAPACK sequence of row interchanges.
+ *
+ */
+
+#include <string.h>   /* needed for memcpy */
+#include "rt_matrixlib.h"
+
+#ifdef RT_MATRIXLIB_USE_BLAS
+
+/* Logical definitions */
+#if (!defined(__cplusplus))
+#  ifndef false
+#   define false                       (0U)
+#  endif
+#  ifndef true
+#   define true                        (1U)
+#  endif
+#endif
+
+/* Fortran BLAS/LAPACK entry points */
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void dgemm_(const char *transa, const char *transb,
+                   const RT_BLAS_INT *m, const RT_BLAS_INT *n,
+                   const RT_BLAS_INT *k, const real_T *alpha,
+                   const real_T *a, const RT_BLAS_INT *lda,
+                   const real_T *b, const RT_BLAS_INT *ldb,
+                   const real_T *beta, real_T *c, const RT_BLAS_INT *ldc);
+extern void sgemm_(const char *transa, const char *transb,
+                   const RT_BLAS_INT *m, const RT_BLAS_INT *n,
+                   const RT_BLAS_INT *k, const real32_T *alpha,
+                   const real32_T *a, const RT_BLAS_INT *lda,
+                   const real32_T *b, const RT_BLAS_INT *ldb,
+                   const real32_T *beta, real32_T *c, const RT_BLAS_INT *ldc);
+extern void dtrsm_(const char *side, const char *uplo, const char *transa,
+                   const char *diag, const RT_BLAS_INT *m,
+                   const RT_BLAS_INT *n, const real_T *alpha,
+                   const real_T *a, const RT_BLAS_INT *lda,
+                   real_T *b, const RT_BLAS_INT *ldb);
+extern void strsm_(const char *side, const char *uplo, const char *transa,
+                   const char *diag, const RT_BLAS_INT *m,
+                   const RT_BLAS_INT *n, const real32_T *alpha,
+                   const real32_T *a, const RT_BLAS_INT *lda,
+                   real32_T *b, const RT_BLAS_INT *ldb);
+extern void dgetrf_(const RT_BLAS_INT *m, const RT_BLAS_INT *n, real_T *a,
+                    const RT_BLAS_INT *lda, RT_BLAS_INT *ipiv,
+                    RT_BLAS_INT *info);
+extern void sgetrf_(const RT_BLAS_INT *m, const RT_BLAS_INT *n, real32_T *a,
+                    const RT_BLAS_INT *lda, RT_BLAS_INT *ipiv,
+                    RT_BLAS_INT *info);
+#ifdef __cplusplus
+}
+#endif
+
+static int_T rtBlasMinDim = RT_BLAS_MIN_DIM;
+
+/* Function: rt_MatrixLibSetBlasMinDim =========================================
+ * Abstract: Set the smallest matrix dimension routed to BLAS/LAPACK.
+ *           A product is routed when all of M, K and N reach it; an LU
+ *           factorization or triangular solve when N does.
+ */
+void rt_MatrixLibSetBlasMinDim(int_T n)
+{
+  rtBlasMinDim = (n < 1) ? 1 : n;
+}
+
+int_T rt_MatrixLibGetBlasMinDim(void)
+{
+  return rtBlasMinDim;
+}
+
+/* Function: rt_BlasPermFromIpiv ===============================================
+ * Abstract: Convert, in place, the LAPACK row interchanges in piv (one
+ *           based, as written by ?getrf) into the zero based row
+ *           permutation returned by rt_lu_real.
+ *
+ *           The permutation is the product t(0)t(1)...t(n-1) of the
+ *           interchanges t(k) = (k ipiv[k]-1). Building it from the back,
+ *           the partial product of t(k+1)...t(n-1) only moves rows k+1 and
+ *           up, so it fits in piv[k+1..n-1] while piv[0..k] still hold the
+ *           interchanges. Prepending t(k) relabels the row ipiv[k]-1 as k.
+ */
+static void rt_BlasPermFromIpiv(int32_T *piv, int_T n)
+{
+  int_T k;
+  for (k = n-1; k >= 0; k--) {
+    const int32_T p = piv[k] - 1;
+    int_T j;
+    for (j = k+1; j < n && p != k; j++) {
+      if (piv[j] == p) {
+        piv[j] = k;
+        break;
+      }
+    }
+    piv[k] = p;
+  }
+}
+
+/* Function: rt_BlasMatMultRR_Dbl ==============================================
+ * Abstract: y = A*B, or y += A*B when accumulate is true, via dgemm.
+ */
+boolean_T rt_BlasMatMultRR_Dbl(real_T       *y,
+                               const real_T *A,
+                               const real_T *B,
+                               const int_T   dims[3],
+                               boolean_T     accumulate)
+{
+  const RT_BLAS_INT m = dims[0];
+  const RT_BLAS_INT k = dims[1];
+  const RT_BLAS_INT n = dims[2];
+  const real_T one  = 1.0;
+  const real_T beta = accumulate ? 1.0 : 0.0;
+
+  if (dims[0] < rtBlasMinDim || dims[1] < rtBlasMinDim ||
+      dims[2] < rtBlasMinDim) {
+    return false;
+  }
+  dgemm_("N", "N", &m, &n, &k, &one, A, &m, B, &k, &beta, y, &m);
+  return true;
+}
+
+boolean_T rt_BlasMatMultRR_Sgl(real32_T       *y,
+                               const real32_T *A,
+                               const real32_T *B,
+                               const int_T     dims[3],
+                               boolean_T       accumulate)
+{
+  const RT_BLAS_INT m = dims[0];
+  const RT_BLAS_INT k = dims[1];
+  const RT_BLAS_INT n = dims[2];
+  const real32_T one  = 1.0F;
+  const real32_T beta = accumulate ? 1.0F : 0.0F;
+
+  if (dims[0] < rtBlasMinDim || dims[1] < rtBlasMinDim ||
+      dims[2] < rtBlasMinDim) {
+    return false;
+  }
+  sgemm_("N", "N", &m, &n, &k, &one, A, &m, B, &k, &beta, y, &m);
+  return true;
+}
+
+/* Function: rt_BlasLU_Dbl =====================================================
+ * Abstract: In-place LU factorization with partial pivoting via dgetrf.
+ *           A zero pivot is not an error, exactly as for rt_lu_real.
+ *           dgetrf writes its interchanges straight into piv, so no
+ *           workspace is needed. Returns false (A untouched) below the
+ *           threshold or when RT_BLAS_INT is wider than int32_T.
+ */
+boolean_T rt_BlasLU_Dbl(real_T *A, const int_T n, int32_T *piv)
+{
+  const RT_BLAS_INT nn = n;
+  RT_BLAS_INT info = 0;
+
+  if (n < rtBlasMinDim || sizeof(RT_BLAS_INT) != sizeof(int32_T)) {
+    return false;
+  }
+  dgetrf_(&nn, &nn, A, &nn, (RT_BLAS_INT *)piv, &info);
+  rt_BlasPermFromIpiv(piv, n);
+  return true;
+}
+
+boolean_T rt_BlasLU_Sgl(real32_T *A, const int_T n, int32_T *piv)
+{
+  const RT_BLAS_INT nn = n;
+  RT_BLAS_INT info = 0;
+
+  if (n < rtBlasMinDim || sizeof(RT_BLAS_INT) != sizeof(int32_T)) {
+    return false;
+  }
+  sgetrf_(&nn, &nn, A, &nn, (RT_BLAS_INT *)piv, &info);
+  rt_BlasPermFromIpiv(piv, n);
+  return true;
+}
+
+/* Function: rt_BlasTrsmRR_Dbl =================================================
+ * Abstract: Solve TX = B for the NxN lower (lower true) or upper triangular
+ *           matrix T and the NxP matrix B via dtrsm. For a lower solve the
+ *           rows of B are taken in the order given by piv, and X must not
+ *           overlap B; an upper solve ignores piv and may run in place.
+ */
+boolean_T rt_BlasTrsmRR_Dbl(const real_T  *T,
+                            const real_T  *B,
+                            real_T        *X,
+                            int_T          N,
+                            int_T          P,
+                            const int32_T *piv,
+                            boolean_T      lower,
+                            boolean_T      unit)
+{
+  const RT_BLAS_INT n = N;
+  const RT_BLAS_INT p = P;
+  const real_T one = 1.0;
+
+  if (N < rtBlasMinDim || P < 1) {
+    return false;
+  }
+  if (lower) {
+    int_T i, k;
+    for (k = 0; k < P; k++) {
+      for (i = 0; i < N; i++) {
+        X[i + k*N] = B[piv[i] + k*N];
+      }
+    }
+  } else if (X != B) {
+    (void)memcpy(X, B, N*P*sizeof(real_T));
+  }
+  dtrsm_("L", lower ? "L" : "U", "N", unit ? "U" : "N",
+         &n, &p, &one, T, &n, X, &n);
+  return true;
+}
+
+boolean_T rt_BlasTrsmRR_Sgl(const real32_T *T,
+                            const real32_T *B,
+                            real32_T       *X,
+                            int_T           N,
+                            int_T           P,
+                            const int32_T  *piv,
+                            boolean_T       lower,
+                            boolean_T       unit)
+{
+  const RT_BLAS_INT n = N;
+  const RT_BLAS_INT p = P;
+  const real32_T one = 1.0F;
+
+  if (N < rtBlasMinDim || P < 1) {
+    return false;
+  }
+  if (lower) {
+    int_T i, k;
+    for (k = 0; k < P; k++) {
+      for (i = 0; i < N; i++) {
+        X[i + k*N] = B[piv[i] + k*N];
+      }
+    }
+  } else if (X != B) {
+    (void)memcpy(X, B, N*P*sizeof(real32_T));
+  }
+  strsm_("L", lower ? "L" : "U", "N", unit ? "U" : "N",
+         &n, &p, &one, T, &n, X, &n);
+  return true;
+}
+
+#endif /* RT_MATRIXLIB_USE_BLAS */
+
+/* [EOF] rt_matrixlib_blas.c */
@@ -0,0 +1,162 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matrixlib_dispatch.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines which select, at run time, the
+ *      instruction set used by the inner kernels of the real matrix
+ *      library routines (rt_MatMultRR_*, rt_MatMultAndIncRR_*,
+ *      rt_lu_real*, rt_TrsmLowerRR_* and rt_TrsmUpperRR_*).
+ *
+ *      The kernels of rt_matrixlib_kernels.h are compiled once per ISA
+ *      level of rt_cpufeatures.h. The first call to rt_MatrixLibKernels
+ *      resolves the table for the processor the program runs on; the
+ *      level can be lowered with the RT_CPU_ISA environment variable or
+ *      rt_MatrixLibSetIsa, for example to compare results between
+ *      machines. No variant contracts multiplies and adds unless the
+ *      compiler is allowed to (-ffp-contract), so under the default ISO C
+ *      options every level returns the same bits as the generic one.
+ *
+ *      Resolving the table is idempotent; concurrent first calls store the
+ *      same pointer.
+ *
+ */
+
+#include "rt_cpufeatures.h"
+#include "rt_matrixlib.h"
+
+#define RT_K_T        real_T
+#define RT_K_NAME(f)  f##_Dbl_Generic
+#define RT_K_ATTR     RT_TARGET_GENERIC
+#include "rt_matrixlib_kernels.h"
+
+#define RT_K_T        real32_T
+#define RT_K_NAME(f)  f##_Sgl_Generic
+#define RT_K_ATTR     RT_TARGET_GENERIC
+#include "rt_matrixlib_kernels.h"
+
+#if RT_CPU_DISPATCH
+
+#define RT_K_T        real_T
+#define RT_K_NAME(f)  f##_Dbl_Sse42
+#define RT_K_ATTR     RT_TARGET_SSE42
+#include "rt_matrixlib_kernels.h"
+
+#define RT_K_T        real32_T
+#define RT_K_NAME(f)  f##_Sgl_Sse42
+#define RT_K_ATTR     RT_TARGET_SSE42
+#include "rt_matrixlib_kernels.h"
+
+#define RT_K_T        real_T
+#define RT_K_NAME(f)  f##_Dbl_Avx2
+#define RT_K_ATTR     RT_TARGET_AVX2
+#include "rt_matrixlib_kernels.h"
+
+#define RT_K_T        real32_T
+#define RT_K_NAME(f)  f##_Sgl_Avx2
+#define RT_K_ATTR     RT_TARGET_AVX2
+#include "rt_matrixlib_kernels.h"
+
+#define RT_K_T        real_T
+#define RT_K_NAME(f)  f##_Dbl_Avx512
+#define RT_K_ATTR     RT_TARGET_AVX512
+#include "rt_matrixlib_kernels.h"
+
+#define RT_K_T        real32_T
+#define RT_K_NAME(f)  f##_Sgl_Avx512
+#define RT_K_ATTR     RT_TARGET_AVX512
+#include "rt_matrixlib_kernels.h"
+
+#endif /* RT_CPU_DISPATCH */
+
+#define RT_KERNEL_TABLE(ISA, SFX)               \
+  { ISA,                                        \
+    rt_KGemmRR_Dbl_##SFX,                       \
+    rt_KGemmRR_Sgl_##SFX,                       \
+    rt_KLuUpdate_Dbl_##SFX,                     \
+    rt_KLuUpdate_Sgl_##SFX,                     \
+    rt_KTrsmUpdateRR_Dbl_##SFX,                 \
+    rt_KTrsmUpdateRR_Sgl_##SFX,                 \
+    rt_KGemmTileRR_Dbl_##SFX,                   \
+    rt_KGemmTileRR_Sgl_##SFX,                   \
+    rt_KLuUpdateTile_Dbl_##SFX,                 \
+    rt_KLuUpdateTile_Sgl_##SFX }
+
+static const rtMatrixLibKernels rtKernelTables[] = {
+  RT_KERNEL_TABLE(RT_ISA_GENERIC, Generic)
+#if RT_CPU_DISPATCH
+  , RT_KERNEL_TABLE(RT_ISA_SSE42,  Sse42)
+  , RT_KERNEL_TABLE(RT_ISA_AVX2,   Avx2)
+  , RT_KERNEL_TABLE(RT_ISA_AVX512, Avx512)
+#endif
+};
+
+#define RT_NUM_KERNEL_TABLES \
+  ((int_T)(sizeof(rtKernelTables)/sizeof(rtKernelTables[0])))
+
+static const rtMatrixLibKernels *rtKernels = NULL;
+
+/* rtKernels is resolved lazily and may be read from the matrix library
+ * pool threads, so it is published with release/acquire ordering where
+ * the compiler provides atomics.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+# define RT_KERNELS_LOAD()     __atomic_load_n(&rtKernels, __ATOMIC_ACQUIRE)
+# define RT_KERNELS_STORE(tbl) __atomic_store_n(&rtKernels, (tbl), \
+                                                __ATOMIC_RELEASE)
+#else
+# define RT_KERNELS_LOAD()     rtKernels
+# define RT_KERNELS_STORE(tbl) (rtKernels = (tbl))
+#endif
+
+/* Function: rt_MatrixLibResolve ===============================================
+ * Abstract: Point rtKernels at the widest table not above isa.
+ */
+static const rtMatrixLibKernels *rt_MatrixLibResolve(int_T isa)
+{
+  const rtMatrixLibKernels *tbl = &rtKernelTables[0];
+  int_T t;
+
+  for (t = 1; t < RT_NUM_KERNEL_TABLES; t++) {
+    if (rtKernelTables[t].isa <= isa) {
+      tbl = &rtKernelTables[t];
+    }
+  }
+  RT_KERNELS_STORE(tbl);
+  return tbl;
+}
+
+/* Function: rt_MatrixLibKernels ===============================================
+ * Abstract: Return the kernel table for the selected ISA level, resolving
+ *           it from the processor features on the first call. Threads
+ *           racing on the first call resolve the same table.
+ */
+const rtMatrixLibKernels *rt_MatrixLibKernels(void)
+{
+  const rtMatrixLibKernels *tbl = RT_KERNELS_LOAD();
+  if (tbl == NULL) {
+    tbl = rt_MatrixLibResolve(rt_CpuSelectIsa(-1));
+  }
+  return tbl;
+}
+
+/* Function: rt_MatrixLibSetIsa ================================================
+ * Abstract: Use the kernels compiled for the RT_ISA_* level isa, clamped
+ *           to what the processor (and RT_CPU_ISA) allows; a negative isa
+ *           restores automatic selection. Returns the level now in use.
+ *           Must not be called while another thread is inside the library.
+ */
+int_T rt_MatrixLibSetIsa(int_T isa)
+{
+  return rt_MatrixLibResolve(rt_CpuSelectIsa(isa))->isa;
+}
+
+/* Function: rt_MatrixLibGetIsa ================================================
+ * Abstract: Return the RT_ISA_* level of the kernels in use.
+ */
+int_T rt_MatrixLibGetIsa(void)
+{
+  return rt_MatrixLibKernels()->isa;
+}
+
+/* [EOF] rt_matrixlib_dispatch.c */
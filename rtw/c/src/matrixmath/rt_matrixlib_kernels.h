@@ -0,0 +1,180 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File    : rt_matrixlib_kernels.h
+ * Abstract:
+ *     Inner kernels of the real matrix library routines, written once and
+ *     compiled by rt_matrixlib_dispatch.c for every type and ISA level it
+ *     dispatches over. This file has no include guard; define before each
+ *     inclusion
+ *
+ *       RT_K_T        element type (real_T or real32_T)
+ *       RT_K_NAME(f)  kernel name for base name f
+ *       RT_K_ATTR     function attribute selecting the ISA
+ *
+ *     The loops run along contiguous columns so that the compiler can
+ *     vectorize them for the selected ISA. Every element is produced by
+ *     the same sequence of operations as in the reference loops of
+ *     rt_matmultrr_*.c, rt_lu_real*.c and rt_trsmrr_*.c.
+ *
+ */
+
+/* Function: RT_K_NAME(rt_KGemmTileRR) =========================================
+ * Abstract: Rows [i0,i1) of columns [c0,c1) of y = A*B, or of y += A*B when
+ *           accumulate is true, for the MxK matrix A and the KxN matrix B
+ *           (dims = {M,K,N}). Each column of the tile is accumulated
+ *           RT_KERNEL_ROWS rows at a time in a stack buffer.
+ */
+RT_K_ATTR static void RT_K_NAME(rt_KGemmTileRR)(RT_K_T       *y,
+                                                const RT_K_T *A,
+                                                const RT_K_T *B,
+                                                const int_T   dims[3],
+                                                int_T         i0,
+                                                int_T         i1,
+                                                int_T         c0,
+                                                int_T         c1,
+                                                boolean_T     accumulate)
+{
+  const int_T M = dims[0];
+  const int_T K = dims[1];
+  RT_K_T acc[RT_KERNEL_ROWS];
+  int_T r0;
+
+  for (r0 = i0; r0 < i1; r0 += RT_KERNEL_ROWS) {
+    const int_T mb = (i1 - r0 < RT_KERNEL_ROWS) ? i1 - r0 : RT_KERNEL_ROWS;
+    int_T k;
+    for (k = c0; k < c1; k++) {
+      const RT_K_T *b  = B + k*K;
+      RT_K_T       *yk = y + r0 + k*M;
+      int_T i, j;
+      for (i = 0; i < mb; i++) {
+        acc[i] = (RT_K_T)0;
+      }
+      for (j = 0; j < K; j++) {
+        const RT_K_T *a  = A + r0 + j*M;
+        const RT_K_T  bj = b[j];
+        for (i = 0; i < mb; i++) {
+          acc[i] += a[i]*bj;
+        }
+      }
+      if (accumulate) {
+        for (i = 0; i < mb; i++) {
+          yk[i] += acc[i];
+        }
+      } else {
+        for (i = 0; i < mb; i++) {
+          yk[i] = acc[i];
+        }
+      }
+    }
+  }
+}
+
+/* Function: RT_K_NAME(rt_KGemmRR) =============================================
+ * Abstract: y = A*B, or y += A*B when accumulate is true, for the MxK
+ *           matrix A and the KxN matrix B (dims = {M,K,N}).
+ */
+RT_K_ATTR static void RT_K_NAME(rt_KGemmRR)(RT_K_T       *y,
+                                            const RT_K_T *A,
+                                            const RT_K_T *B,
+                                            const int_T   dims[3],
+                                            boolean_T     accumulate)
+{
+  RT_K_NAME(rt_KGemmTileRR)(y, A, B, dims, 0, dims[0], 0, dims[2],
+                            accumulate);
+}
+
+/* Function: RT_K_NAME(rt_KLuUpdateTile) =======================================
+ * Abstract: Rows [i0,i1) of columns [j0,j1) of the trailing update of step
+ *           k of the LU factorization of the nxn matrix A:
+ *           A(i, j) -= A(i, k)*A(k, j), with k < i0 and k < j0.
+ */
+RT_K_ATTR static void RT_K_NAME(rt_KLuUpdateTile)(RT_K_T *A,
+                                                  int_T   n,
+                                                  int_T   k,
+                                                  int_T   i0,
+                                                  int_T   i1,
+                                                  int_T   j0,
+                                                  int_T   j1)
+{
+  const RT_K_T *ak = A + k*n;
+  int_T i, j;
+
+  for (j = j0; j < j1; j++) {
+    RT_K_T      *aj = A + j*n;
+    const RT_K_T akj = aj[k];
+    for (i = i0; i < i1; i++) {
+      aj[i] -= ak[i]*akj;
+    }
+  }
+}
+
+/* Function: RT_K_NAME(rt_KLuUpdate) ===========================================
+ * Abstract: Trailing update of step k of the LU factorization of the nxn
+ *           matrix A: A(k+1:n-1, j) -= A(k+1:n-1, k)*A(k, j) for j > k.
+ */
+RT_K_ATTR static void RT_K_NAME(rt_KLuUpdate)(RT_K_T *A, int_T n, int_T k)
+{
+  RT_K_NAME(rt_KLuUpdateTile)(A, n, k, k+1, n, k+1, n);
+}
+
+/* Function: RT_K_NAME(rt_KTrsmUpdateRR) =======================================
+ * Abstract: X(rlo:rhi-1, k0:k0+kb-1) -= T(rlo:rhi-1, jlo:jhi-1) *
+ *                                      X(jlo:jhi-1, k0:k0+kb-1)
+ *           for the NxN column-major matrix T and the NxP matrix X. The row
+ *           ranges [rlo,rhi) and [jlo,jhi) must not overlap.
+ */
+RT_K_ATTR static void RT_K_NAME(rt_KTrsmUpdateRR)(RT_K_T       *X,
+                                                  const RT_K_T *T,
+                                                  int_T         N,
+                                                  int_T         rlo,
+                                                  int_T         rhi,
+                                                  int_T         jlo,
+                                                  int_T         jhi,
+                                                  int_T         k0,
+                                                  int_T         kb)
+{
+  RT_K_T *x0 = X + k0*N;
+  int_T i, j;
+
+  if (rlo >= rhi) {
+    return;
+  }
+
+  if (kb == 4) {
+    RT_K_T *x1 = x0 + N;
+    RT_K_T *x2 = x1 + N;
+    RT_K_T *x3 = x2 + N;
+    for (j = jlo; j < jhi; j++) {
+      const RT_K_T *t = T + j*N;
+      const RT_K_T a0 = x0[j];
+      const RT_K_T a1 = x1[j];
+      const RT_K_T a2 = x2[j];
+      const RT_K_T a3 = x3[j];
+      for (i = rlo; i < rhi; i++) {
+        const RT_K_T ti = t[i];
+        x0[i] -= ti*a0;
+        x1[i] -= ti*a1;
+        x2[i] -= ti*a2;
+        x3[i] -= ti*a3;
+      }
+    }
+  } else {
+    int_T kk;
+    for (kk = 0; kk < kb; kk++) {
+      RT_K_T *xk = x0 + kk*N;
+      for (j = jlo; j < jhi; j++) {
+        const RT_K_T *t = T + j*N;
+        const RT_K_T a = xk[j];
+        for (i = rlo; i < rhi; i++) {
+          xk[i] -= t[i]*a;
+        }
+      }
+    }
+  }
+}
+
+#undef RT_K_T
+#undef RT_K_NAME
+#undef RT_K_ATTR
+
+/* [EOF] rt_matrixlib_kernels.h */
@@ -0,0 +1,420 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matrixlib_threads.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines which spread the large real double
+ *      precision matrix multiplies (rt_MatMultRR_Dbl,
+ *      rt_MatMultAndIncRR_Dbl) and the trailing updates of rt_lu_real
+ *      over an internal pool of POSIX threads. rt_lu_real defers the
+ *      update of the columns right of each panel of
+ *      RT_MATRIXLIB_LU_PANEL columns and posts it to the pool once per
+ *      panel. Compiled only when
+ *      RT_MATRIXLIB_THREADS is defined; the program must then be linked
+ *      with -lpthread. On other platforms the routines run serially.
+ *
+ *      The output is cut into 2-D tiles of RT_MATRIXLIB_TILE_ROWS rows by
+ *      a number of columns chosen so that every thread gets several
+ *      tiles. The calling thread works on tiles alongside the pool
+ *      threads and returns once all of them are done. Every element is
+ *      computed by the same kernel, in the same order, as in the serial
+ *      routine, so results do not depend on the number of threads.
+ *
+ *      The number of threads taking part (the caller included) is capped
+ *      by RT_MATRIXLIB_MAX_THREADS at compile time, by the number of
+ *      online processors, by the RT_MATRIXLIB_THREADS environment
+ *      variable read when the pool starts, and by
+ *      rt_MatrixLibSetMaxThreads. Set the cap to 1 to keep a model that
+ *      already runs one thread per rate (or per sweep worker) from
+ *      oversubscribing the cores. A call made while the pool is busy
+ *      with another thread's work runs serially instead of waiting.
+ *
+ *      The pool threads start on the first call large enough to use them
+ *      and sleep on a condition variable between calls.
+ *
+ */
+
+#if defined(RT_MATRIXLIB_THREADS) && !defined(_WIN32)
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# define RT_MATRIXLIB_PTHREADS
+# include <pthread.h>
+# include <unistd.h>  /* needed for sysconf */
+#endif
+
+#include <stdlib.h>   /* needed for getenv, atoi */
+#include "rt_matrixlib.h"
+
+#ifdef RT_MATRIXLIB_THREADS
+
+/* Logical definitions */
+#if (!defined(__cplusplus))
+#  ifndef false
+#   define false                       (0U)
+#  endif
+#  ifndef true
+#   define true                        (1U)
+#  endif
+#endif
+
+#define RT_PAR_MIN(a,b) ((a) < (b) ? (a) : (b))
+
+/* Tiles handed out per participating thread */
+#define RT_PAR_TILES_PER_THREAD 4
+
+typedef void (*rtParTileFcn)(const void *job, int_T tile);
+
+typedef struct {
+  rtParTileFcn  fcn;
+  const void   *job;
+  int_T         numTiles;
+  int_T         rowTiles;     /* tile t covers row tile t % rowTiles and */
+  int_T         colWidth;     /*   columns colWidth*(t / rowTiles) on    */
+} rtParWork;
+
+typedef struct {
+  real_T       *y;
+  const real_T *A;
+  const real_T *B;
+  const int_T  *dims;
+  boolean_T     accumulate;
+  const rtParWork *work;
+} rtParGemmJob;
+
+typedef struct {
+  real_T       *A;
+  int_T         n;
+  int_T         k0;           /* panel columns [k0,k1); columns k1 and up */
+  int_T         k1;           /*   are updated                            */
+  const rtParWork *work;
+} rtParLuJob;
+
+/* Thread cap, 0 until the pool starts; accessed under RT_PAR_LOCK only */
+static int_T rtParMaxThreads = 0;
+
+#ifdef RT_MATRIXLIB_PTHREADS
+
+static pthread_t       rtParThreads[RT_MATRIXLIB_MAX_THREADS];
+static pthread_mutex_t rtParMutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  rtParWake     = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  rtParDone     = PTHREAD_COND_INITIALIZER;
+static int_T           rtParNumStarted = 0;  /* pool threads running     */
+static boolean_T       rtParBusy     = false;
+static uint32_T        rtParGen      = 0;    /* bumped per posted job    */
+static uint32_T        rtParStartGen = 0;    /* rtParGen at thread start */
+static const rtParWork *rtParJob     = NULL;
+static int_T           rtParNextTile = 0;
+static int_T           rtParHelpers  = 0;    /* pool threads on this job */
+static int_T           rtParActive   = 0;    /* helpers not yet finished */
+
+#define RT_PAR_LOCK()   (void)pthread_mutex_lock(&rtParMutex)
+#define RT_PAR_UNLOCK() (void)pthread_mutex_unlock(&rtParMutex)
+
+/* Function: rt_ParRunTiles ====================================================
+ * Abstract: Take tiles of the posted job until none are left. Called with
+ *           rtParMutex held; returns with it held.
+ */
+static void rt_ParRunTiles(const rtParWork *work)
+{
+  while (rtParNextTile < work->numTiles) {
+    const int_T t = rtParNextTile++;
+    (void)pthread_mutex_unlock(&rtParMutex);
+    work->fcn(work->job, t);
+    (void)pthread_mutex_lock(&rtParMutex);
+  }
+}
+
+/* Function: rt_ParWorker ======================================================
+ * Abstract: Body of pool thread number id (0 based): sleep until a job is
+ *           posted that wants more than id helpers, then work on its tiles.
+ */
+static void *rt_ParWorker(void *arg)
+{
+  const int_T id = (int_T)(size_t)arg;
+  uint32_T seen;
+
+  (void)pthread_mutex_lock(&rtParMutex);
+  seen = rtParStartGen;                 /* a job may be posted already */
+  for (;;) {
+    while (rtParGen == seen || id >= rtParHelpers) {
+      seen = rtParGen;
+      (void)pthread_cond_wait(&rtParWake, &rtParMutex);
+    }
+    seen = rtParGen;
+    rt_ParRunTiles(rtParJob);
+    if (--rtParActive == 0) {
+      (void)pthread_cond_signal(&rtParDone);
+    }
+  }
+  return NULL;                          /* not reached */
+}
+
+/* Function: rt_ParStart =======================================================
+ * Abstract: Resolve the thread cap and the kernel table and start the pool
+ *           threads. Called with rtParMutex held.
+ */
+static void rt_ParStart(void)
+{
+  long  ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  const char *env = getenv("RT_MATRIXLIB_THREADS");
+  int_T cap = RT_MATRIXLIB_MAX_THREADS;
+
+  if (ncpu > 0 && ncpu < cap) {
+    cap = (int_T)ncpu;
+  }
+  if (env != NULL && atoi(env) > 0 && atoi(env) < cap) {
+    cap = atoi(env);
+  }
+  if (rtParMaxThreads > 0 && rtParMaxThreads < cap) {
+    cap = rtParMaxThreads;              /* set before the pool started */
+  }
+  rtParMaxThreads = (cap < 1) ? 1 : cap;
+  rtParStartGen   = rtParGen;
+
+  (void)rt_MatrixLibKernels();          /* resolved before any job is posted */
+
+  while (rtParNumStarted < rtParMaxThreads - 1) {
+    pthread_attr_t attr;
+    (void)pthread_attr_init(&attr);
+    (void)pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&rtParThreads[rtParNumStarted], &attr, rt_ParWorker,
+                       (void *)(size_t)rtParNumStarted) != 0) {
+      (void)pthread_attr_destroy(&attr);
+      break;                            /* run with the ones we have */
+    }
+    (void)pthread_attr_destroy(&attr);
+    rtParNumStarted++;
+  }
+}
+
+/* Function: rt_ParRun =========================================================
+ * Abstract: Run all tiles of work on the pool and the calling thread.
+ *           Returns false, having done nothing, if fewer than two threads
+ *           are available or the pool is busy.
+ */
+static boolean_T rt_ParRun(const rtParWork *work)
+{
+  int_T helpers;
+
+  (void)pthread_mutex_lock(&rtParMutex);
+  if (rtParBusy) {
+    (void)pthread_mutex_unlock(&rtParMutex);
+    return false;
+  }
+  if (rtParNumStarted == 0 && rtParMaxThreads != 1) {
+    rt_ParStart();
+  }
+  helpers = RT_PAR_MIN(rtParNumStarted, rtParMaxThreads - 1);
+  helpers = RT_PAR_MIN(helpers, work->numTiles - 1);
+  if (helpers < 1) {
+    (void)pthread_mutex_unlock(&rtParMutex);
+    return false;
+  }
+
+  rtParBusy     = true;
+  rtParJob      = work;
+  rtParNextTile = 0;
+  rtParHelpers  = helpers;
+  rtParActive   = helpers;
+  rtParGen++;
+  (void)pthread_cond_broadcast(&rtParWake);
+
+  rt_ParRunTiles(work);
+  while (rtParActive > 0) {
+    (void)pthread_cond_wait(&rtParDone, &rtParMutex);
+  }
+
+  rtParHelpers = 0;
+  rtParJob     = NULL;
+  rtParBusy    = false;
+  (void)pthread_mutex_unlock(&rtParMutex);
+  return true;
+}
+
+#else
+
+#define RT_PAR_LOCK()
+#define RT_PAR_UNLOCK()
+
+/* Function: rt_ParRun =========================================================
+ * Abstract: No thread support on this platform; callers run serially.
+ */
+static boolean_T rt_ParRun(const rtParWork *work)
+{
+  (void)work;
+  return false;
+}
+
+#endif /* RT_MATRIXLIB_PTHREADS */
+
+/* Function: rt_ParThreads =====================================================
+ * Abstract: Upper bound on the threads a job can use, for sizing tiles.
+ */
+static int_T rt_ParThreads(void)
+{
+  int_T n;
+
+  RT_PAR_LOCK();
+  n = (rtParMaxThreads > 0) ? rtParMaxThreads : RT_MATRIXLIB_MAX_THREADS;
+  RT_PAR_UNLOCK();
+  return n;
+}
+
+/* Function: rt_ParPlan ========================================================
+ * Abstract: Cut the rows [0,rows) x cols columns into tiles of
+ *           RT_MATRIXLIB_TILE_ROWS rows and enough column strips to give
+ *           each of threads threads RT_PAR_TILES_PER_THREAD tiles.
+ */
+static void rt_ParPlan(rtParWork *work, int_T rows, int_T cols, int_T threads)
+{
+  const int_T want = threads*RT_PAR_TILES_PER_THREAD;
+  int_T colTiles;
+
+  work->rowTiles = (rows + RT_MATRIXLIB_TILE_ROWS - 1)/RT_MATRIXLIB_TILE_ROWS;
+  colTiles = (want + work->rowTiles - 1)/work->rowTiles;
+  colTiles = RT_PAR_MIN(colTiles, cols);
+  work->colWidth = (cols + colTiles - 1)/colTiles;
+  colTiles = (cols + work->colWidth - 1)/work->colWidth;
+  work->numTiles = work->rowTiles*colTiles;
+}
+
+/* Function: rt_ParGemmTile ====================================================
+ * Abstract: Compute one tile of y = A*B (or y += A*B).
+ */
+static void rt_ParGemmTile(const void *job, int_T t)
+{
+  const rtParGemmJob *g = (const rtParGemmJob *)job;
+  const rtParWork    *w = g->work;
+  const int_T i0 = (t % w->rowTiles)*RT_MATRIXLIB_TILE_ROWS;
+  const int_T c0 = (t / w->rowTiles)*w->colWidth;
+  const int_T i1 = RT_PAR_MIN(i0 + RT_MATRIXLIB_TILE_ROWS, g->dims[0]);
+  const int_T c1 = RT_PAR_MIN(c0 + w->colWidth, g->dims[2]);
+
+  rt_MatrixLibKernels()->gemmTileRR_Dbl(g->y, g->A, g->B, g->dims,
+                                        i0, i1, c0, c1, g->accumulate);
+}
+
+/* Function: rt_ParLuPanelCols ================================================
+ * Abstract: Apply steps [k0,k1) of the LU factorization of the nxn matrix A
+ *           to columns [j0,j1), all at or right of column k1. Each column
+ *           takes the steps in order, so every element sees the same
+ *           operations as in the column by column algorithm.
+ */
+static void rt_ParLuPanelCols(real_T *A, int_T n, int_T k0, int_T k1,
+                              int_T j0, int_T j1)
+{
+  const rtMatrixLibKernels *kern = rt_MatrixLibKernels();
+  int_T j, k;
+
+  for (j = j0; j < j1; j++) {
+    for (k = k0; k < k1; k++) {
+      if (A[k + k*n] != 0.0) {          /* step skipped by rt_lu_real */
+        kern->luUpdateTile_Dbl(A, n, k, k+1, n, j, j+1);
+      }
+    }
+  }
+}
+
+/* Function: rt_ParLuTile ======================================================
+ * Abstract: Compute one column strip of the trailing update of an LU panel.
+ */
+static void rt_ParLuTile(const void *job, int_T t)
+{
+  const rtParLuJob *l = (const rtParLuJob *)job;
+  const int_T j0 = l->k1 + t*l->work->colWidth;
+  const int_T j1 = RT_PAR_MIN(j0 + l->work->colWidth, l->n);
+
+  rt_ParLuPanelCols(l->A, l->n, l->k0, l->k1, j0, j1);
+}
+
+/* Function: rt_MatrixLibSetMaxThreads =========================================
+ * Abstract: Cap the threads used by one matrix library call, the caller
+ *           included (1 disables threading). The cap cannot be raised
+ *           above the number of pool threads started by the first call.
+ *           Calls already running keep the cap they started with.
+ */
+void rt_MatrixLibSetMaxThreads(int_T n)
+{
+  RT_PAR_LOCK();
+  rtParMaxThreads = (n < 1) ? 1 : RT_PAR_MIN(n, RT_MATRIXLIB_MAX_THREADS);
+  RT_PAR_UNLOCK();
+}
+
+/* Function: rt_MatrixLibGetMaxThreads =========================================
+ * Abstract: Return the current thread cap.
+ */
+int_T rt_MatrixLibGetMaxThreads(void)
+{
+  return rt_ParThreads();
+}
+
+/* Function: rt_ParMatMultRR_Dbl ===============================================
+ * Abstract: y = A*B, or y += A*B when accumulate is true, on the thread
+ *           pool. Returns false, having done nothing, when the product is
+ *           smaller than RT_MATRIXLIB_PAR_MIN_WORK multiply-adds or no
+ *           second thread is available.
+ */
+boolean_T rt_ParMatMultRR_Dbl(real_T       *y,
+                              const real_T *A,
+                              const real_T *B,
+                              const int_T   dims[3],
+                              boolean_T     accumulate)
+{
+  rtParWork    work;
+  rtParGemmJob job;
+  int_T        threads;
+
+  if ((real_T)dims[0]*dims[1]*dims[2] < (real_T)RT_MATRIXLIB_PAR_MIN_WORK ||
+      (threads = rt_ParThreads()) == 1) {
+    return false;
+  }
+
+  job.y          = y;
+  job.A          = A;
+  job.B          = B;
+  job.dims       = dims;
+  job.accumulate = accumulate;
+  job.work       = &work;
+  work.fcn       = rt_ParGemmTile;
+  work.job       = &job;
+  rt_ParPlan(&work, dims[0], dims[2], threads);
+
+  return rt_ParRun(&work);
+}
+
+/* Function: rt_ParLuPanelUpdate_Dbl ===========================================
+ * Abstract: Once the panel of columns [k0,k1) of the LU factorization of
+ *           the nxn matrix A has been factored, apply its steps to the
+ *           columns right of it. The columns are cut into strips handed to
+ *           the thread pool when the (n-k1)^2 trailing matrix reaches
+ *           RT_MATRIXLIB_PAR_MIN_LU elements, so the pool is posted once
+ *           per panel rather than once per column.
+ */
+void rt_ParLuPanelUpdate_Dbl(real_T *A, int_T n, int_T k0, int_T k1)
+{
+  const int_T m = n - k1;
+  rtParWork  work;
+  rtParLuJob job;
+  int_T      threads;
+
+  if ((real_T)m*m >= (real_T)RT_MATRIXLIB_PAR_MIN_LU &&
+      (threads = rt_ParThreads()) != 1) {
+    job.A     = A;
+    job.n     = n;
+    job.k0    = k0;
+    job.k1    = k1;
+    job.work  = &work;
+    work.fcn  = rt_ParLuTile;
+    work.job  = &job;
+    rt_ParPlan(&work, 1, m, threads);   /* column strips of all rows */
+    if (rt_ParRun(&work)) {
+      return;
+    }
+  }
+  rt_ParLuPanelCols(A, n, k0, k1, k1, n);
+}
+
+#endif /* RT_MATRIXLIB_THREADS */
+
+/* [EOF] rt_matrixlib_threads.c */
@@ -0,0 +1,268 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_qr_real.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines for the Householder QR
+ *      factorization of a real double precision matrix, and for applying
+ *      its orthogonal factor.
+ *
+ *      The factors use the LAPACK xGEQRF layout: R is stored on and above
+ *      the diagonal, the Householder vectors v_j (with implicit v_j(j) = 1)
+ *      below it, and Q = H_0 H_1 ... H_{k-1} with H_j = I - tau_j v_j v_j'.
+ *
+ *      Columns are factored in panels of RT_QR_BLOCK. Each panel's
+ *      reflectors are accumulated into the compact WY form I - V T V' and
+ *      applied to the trailing columns RT_QR_BLOCK at a time, so the
+ *      update runs as small matrix products over stack buffers instead of
+ *      one rank-1 sweep of the whole trailing matrix per column.
+ *
+ */
+
+#include <math.h>
+#include "rt_matrixlib.h"
+
+#define RT_QR_MIN(a,b) ((a) < (b) ? (a) : (b))
+
+/* Function: rt_QRNorm2 ========================================================
+ * Abstract: Euclidean norm of x(0:n-1), scaled to avoid overflow.
+ */
+static real_T rt_QRNorm2(const real_T *x, int_T n)
+{
+  real_T scale = 0.0;
+  real_T ssq   = 1.0;
+  int_T i;
+
+  for (i = 0; i < n; i++) {
+    if (x[i] != 0.0) {
+      const real_T a = fabs(x[i]);
+      if (scale < a) {
+        ssq   = 1.0 + ssq*(scale/a)*(scale/a);
+        scale = a;
+      } else {
+        ssq += (a/scale)*(a/scale);
+      }
+    }
+  }
+  return scale*sqrt(ssq);
+}
+
+/* Function: rt_QRReflector ====================================================
+ * Abstract: Generate H = I - tau v v' with H x = (beta, 0, ..., 0)' for the
+ *           column x(0:n-1). x(0) is replaced by beta and x(1:n-1) by v
+ *           (v(0) = 1 is implicit). Returns tau (0 when H = I).
+ */
+static real_T rt_QRReflector(real_T *x, int_T n)
+{
+  const real_T alpha = x[0];
+  real_T xnorm, beta, s;
+  int_T i;
+
+  if (n <= 1) {
+    return 0.0;
+  }
+  xnorm = rt_QRNorm2(x + 1, n - 1);
+  if (xnorm == 0.0) {
+    return 0.0;
+  }
+  beta = rt_Hypot_Dbl(alpha, xnorm);
+  if (alpha >= 0.0) {
+    beta = -beta;
+  }
+  s = 1.0/(alpha - beta);
+  for (i = 1; i < n; i++) {
+    x[i] *= s;
+  }
+  x[0] = beta;
+  return (beta - alpha)/beta;
+}
+
+/* Function: rt_QRApplyReflector ===============================================
+ * Abstract: C := (I - tau v v') C for the rows x cols block C (leading
+ *           dimension ldc) and the reflector v(0:rows-1), v(0) = 1.
+ */
+static void rt_QRApplyReflector(const real_T *v,
+                                real_T        tau,
+                                real_T       *C,
+                                int_T         ldc,
+                                int_T         rows,
+                                int_T         cols)
+{
+  int_T i, c;
+
+  if (tau == 0.0) {
+    return;
+  }
+  for (c = 0; c < cols; c++) {
+    real_T *cc = C + c*ldc;
+    real_T  w  = cc[0];
+    for (i = 1; i < rows; i++) {
+      w += v[i]*cc[i];
+    }
+    w *= tau;
+    cc[0] -= w;
+    for (i = 1; i < rows; i++) {
+      cc[i] -= v[i]*w;
+    }
+  }
+}
+
+/* Function: rt_QRBlockUpdate ==================================================
+ * Abstract: C := (I - V T V')' C for the rows x cols block C (leading
+ *           dimension ld), where V holds the jb reflectors of a panel
+ *           (unit lower trapezoidal, leading dimension ld) and T the
+ *           jb x jb upper triangular factor of their compact WY form.
+ */
+static void rt_QRBlockUpdate(const real_T *V,
+                             const real_T  T[RT_QR_BLOCK*RT_QR_BLOCK],
+                             real_T       *C,
+                             int_T         ld,
+                             int_T         rows,
+                             int_T         jb,
+                             int_T         cols)
+{
+  real_T W[RT_QR_BLOCK*RT_QR_BLOCK];
+  int_T c0;
+
+  for (c0 = 0; c0 < cols; c0 += RT_QR_BLOCK) {
+    const int_T cb = RT_QR_MIN(RT_QR_BLOCK, cols - c0);
+    real_T *Cb = C + c0*ld;
+    int_T i, j, c;
+
+    /* W = V' C (jb x cb) */
+    for (c = 0; c < cb; c++) {
+      const real_T *cc = Cb + c*ld;
+      for (j = 0; j < jb; j++) {
+        const real_T *v = V + j*ld;
+        real_T w = cc[j];
+        for (i = j+1; i < rows; i++) {
+          w += v[i]*cc[i];
+        }
+        W[j + c*RT_QR_BLOCK] = w;
+      }
+    }
+
+    /* W = T' W, T upper triangular: bottom row first */
+    for (c = 0; c < cb; c++) {
+      real_T *wc = W + c*RT_QR_BLOCK;
+      for (j = jb-1; j >= 0; j--) {
+        const real_T *tj = T + j*RT_QR_BLOCK;
+        real_T w = 0.0;
+        for (i = 0; i <= j; i++) {
+          w += tj[i]*wc[i];
+        }
+        wc[j] = w;
+      }
+    }
+
+    /* C -= V W */
+    for (c = 0; c < cb; c++) {
+      real_T       *cc = Cb + c*ld;
+      const real_T *wc = W + c*RT_QR_BLOCK;
+      for (j = 0; j < jb; j++) {
+        const real_T *v = V + j*ld;
+        const real_T  w = wc[j];
+        cc[j] -= w;
+        for (i = j+1; i < rows; i++) {
+          cc[i] -= v[i]*w;
+        }
+      }
+    }
+  }
+}
+
+/* Function: rt_qr_real ========================================================
+ * Abstract: In-place Householder QR factorization of the m x n matrix A
+ *           (column major). tau receives the min(m,n) reflector scalars.
+ */
+void rt_qr_real(real_T      *A,     /* in and out          */
+                const int_T  m,     /* number of rows      */
+                const int_T  n,     /* number of columns   */
+                real_T      *tau)   /* reflector scalars   */
+{
+  const int_T k = RT_QR_MIN(m, n);
+  real_T T[RT_QR_BLOCK*RT_QR_BLOCK];
+  int_T j0;
+
+  for (j0 = 0; j0 < k; j0 += RT_QR_BLOCK) {
+    const int_T jb = RT_QR_MIN(RT_QR_BLOCK, k - j0);
+    real_T *Ap = A + j0 + j0*m;        /* top left of the panel */
+    int_T j;
+
+    /* factor the panel column by column */
+    for (j = 0; j < jb; j++) {
+      real_T *ajj = Ap + j + j*m;
+      const real_T t = rt_QRReflector(ajj, m - j0 - j);
+      tau[j0+j] = t;
+      if (j+1 < jb) {
+        rt_QRApplyReflector(ajj, t, ajj + m, m, m - j0 - j, jb - j - 1);
+      }
+    }
+
+    if (j0 + jb < n) {
+      int_T i, l;
+
+      /* T(0:j-1,j) = -tau_j T(0:j-1,0:j-1) V(:,0:j-1)' v_j */
+      for (j = 0; j < jb; j++) {
+        const real_T *vj = Ap + j*m;
+        real_T *tj = T + j*RT_QR_BLOCK;
+        for (l = 0; l < j; l++) {
+          const real_T *vl = Ap + l*m;
+          real_T s = vl[j];                  /* v_j(j) = 1 */
+          for (i = j+1; i < m - j0; i++) {
+            s += vl[i]*vj[i];
+          }
+          tj[l] = -tau[j0+j]*s;
+        }
+        for (l = 0; l < j; l++) {
+          real_T s = 0.0;
+          for (i = l; i < j; i++) {
+            s += T[l + i*RT_QR_BLOCK]*tj[i];
+          }
+          tj[l] = s;
+        }
+        tj[j] = tau[j0+j];
+      }
+
+      rt_QRBlockUpdate(Ap, T, Ap + jb*m, m, m - j0, jb, n - j0 - jb);
+    }
+  }
+}
+
+/* Function: rt_QRApplyQt_Dbl ==================================================
+ * Abstract: B := Q' B for the m x p matrix B, where qr (m rows) and tau
+ *           hold the k reflectors returned by rt_qr_real.
+ */
+void rt_QRApplyQt_Dbl(const real_T *qr,
+                      const real_T *tau,
+                      real_T       *B,
+                      int_T         m,
+                      int_T         k,
+                      int_T         p)
+{
+  int_T j;
+
+  for (j = 0; j < k; j++) {
+    rt_QRApplyReflector(qr + j + j*m, tau[j], B + j, m, m - j, p);
+  }
+}
+
+/* Function: rt_QRApplyQ_Dbl ===================================================
+ * Abstract: B := Q B for the m x p matrix B, where qr (m rows) and tau
+ *           hold the k reflectors returned by rt_qr_real.
+ */
+void rt_QRApplyQ_Dbl(const real_T *qr,
+                     const real_T *tau,
+                     real_T       *B,
+                     int_T         m,
+                     int_T         k,
+                     int_T         p)
+{
+  int_T j;
+
+  for (j = k-1; j >= 0; j--) {
+    rt_QRApplyReflector(qr + j + j*m, tau[j], B + j, m, m - j, p);
+  }
+}
+
+/* [EOF] rt_qr_real.c */
@@ -0,0 +1,127 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File    : rt_trsmrr.h
+ * Abstract:
+ *     Body of the blocked triangular solves with many right-hand sides
+ *     (TRSM), written once and compiled by rt_trsmrr_dbl.c and
+ *     rt_trsmrr_sgl.c for their element type. This file has no include
+ *     guard; define before each inclusion
+ *
+ *       RT_TRSM_T        element type (real_T or real32_T)
+ *       RT_TRSM_NAME(f)  routine name for base name f
+ *       RT_TRSM_UPDATE   rtMatrixLibKernels member of the update kernel
+ *
+ *     The solve walks the triangle in diagonal blocks of RT_TRSM_BLOCK
+ *     rows. Each block is solved column-oriented for a panel of four
+ *     right-hand sides, after which the rows outside the block are
+ *     updated with a rank-RT_TRSM_BLOCK product whose inner kernel reads
+ *     one contiguous column of the triangle and applies it to all four
+ *     right-hand sides at once. That kernel is taken from the run-time
+ *     ISA dispatch table (rt_matrixlib_dispatch.c).
+ *
+ */
+
+#ifndef RT_TRSM_MIN
+#define RT_TRSM_MIN(a,b) ((a) < (b) ? (a) : (b))
+#define RT_TRSM_MAX(a,b) ((a) > (b) ? (a) : (b))
+#endif
+
+/* Function: RT_TRSM_NAME(rt_TrsmLowerRR) =====================================
+ * Abstract: Solve LX = B(piv,:) for the NxN lower (or unit lower) triangular
+ *           matrix L and the NxP matrix B. The entries above the diagonal of
+ *           L are ignored. X must not overlap B.
+ */
+void RT_TRSM_NAME(rt_TrsmLowerRR)(const RT_TRSM_T *L,
+                                  const RT_TRSM_T *B,
+                                  RT_TRSM_T       *X,
+                                  int_T            N,
+                                  int_T            P,
+                                  const int32_T   *piv,
+                                  boolean_T        unit_lower)
+{
+  const rtMatrixLibKernels *kern = rt_MatrixLibKernels();
+  int_T i0, k0;
+
+  for (k0 = 0; k0 < P; k0++) {
+    const RT_TRSM_T *b = B + k0*N;
+    RT_TRSM_T *x = X + k0*N;
+    int_T i;
+    for (i = 0; i < N; i++) {
+      x[i] = b[piv[i]];
+    }
+  }
+
+  for (i0 = 0; i0 < N; i0 += RT_TRSM_BLOCK) {
+    const int_T i1 = RT_TRSM_MIN(N, i0 + RT_TRSM_BLOCK);
+
+    for (k0 = 0; k0 < P; k0 += 4) {
+      const int_T kb = RT_TRSM_MIN(4, P - k0);
+      int_T j;
+
+      /* diagonal block */
+      for (j = i0; j < i1; j++) {
+        if (!unit_lower) {
+          const RT_TRSM_T d = L[j + j*N];
+          int_T kk;
+          for (kk = 0; kk < kb; kk++) {
+            X[j + (k0+kk)*N] /= d;
+          }
+        }
+        kern->RT_TRSM_UPDATE(X, L, N, j+1, i1, j, j+1, k0, kb);
+      }
+
+      /* rows below the block */
+      kern->RT_TRSM_UPDATE(X, L, N, i1, N, i0, i1, k0, kb);
+    }
+  }
+}
+
+/* Function: RT_TRSM_NAME(rt_TrsmUpperRR) =====================================
+ * Abstract: Solve UX = B for the NxN upper (or unit upper) triangular matrix
+ *           U and the NxP matrix B. The entries below the diagonal of U are
+ *           ignored. X may be the same buffer as B.
+ */
+void RT_TRSM_NAME(rt_TrsmUpperRR)(const RT_TRSM_T *U,
+                                  const RT_TRSM_T *B,
+                                  RT_TRSM_T       *X,
+                                  int_T            N,
+                                  int_T            P,
+                                  boolean_T        unit_upper)
+{
+  const rtMatrixLibKernels *kern = rt_MatrixLibKernels();
+  int_T i0, i1, k0;
+
+  if (X != B) {
+    (void)memcpy(X, B, N*P*sizeof(RT_TRSM_T));
+  }
+
+  for (i1 = N; i1 > 0; i1 = i0) {
+    i0 = RT_TRSM_MAX(0, i1 - RT_TRSM_BLOCK);
+
+    for (k0 = 0; k0 < P; k0 += 4) {
+      const int_T kb = RT_TRSM_MIN(4, P - k0);
+      int_T j;
+
+      /* diagonal block */
+      for (j = i1-1; j >= i0; j--) {
+        if (!unit_upper) {
+          const RT_TRSM_T d = U[j + j*N];
+          int_T kk;
+          for (kk = 0; kk < kb; kk++) {
+            X[j + (k0+kk)*N] /= d;
+          }
+        }
+        kern->RT_TRSM_UPDATE(X, U, N, i0, j, j, j+1, k0, kb);
+      }
+
+      /* rows above the block */
+      kern->RT_TRSM_UPDATE(X, U, N, 0, i0, i0, i1, k0, kb);
+    }
+  }
+}
+
+#undef RT_TRSM_T
+#undef RT_TRSM_NAME
+#undef RT_TRSM_UPDATE
+
+/* [EOF] rt_trsmrr.h */
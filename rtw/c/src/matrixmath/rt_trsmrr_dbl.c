@@ -0,0 +1,22 @@
+/* Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_trsmrr_dbl.c
+ *
+ * Abstract:
+ *      Simulink Coder support routines which perform blocked triangular
+ *      solves with many right-hand sides (TRSM) for real double precision
+ *      float operands. rt_ForwardSubstitutionRR_Dbl and
+ *      rt_BackwardSubstitutionRR_Dbl hand over to these once P reaches
+ *      RT_TRSM_MIN_RHS. The routines are instantiated from rt_trsmrr.h.
+ *
+ */
+
+#include <string.h>   /* needed for memcpy */
+#include "rt_matrixlib.h"
+
+#define RT_TRSM_T        real_T
+#define RT_TRSM_NAME(f)  f##_Dbl
+#define RT_TRSM_UPDATE   trsmUpdateRR_Dbl
+#include "rt_trsmrr.h"
+
+/* [EOF] rt_trsmrr_dbl.c */
@@ -14,6 +14,7 @@
 # include "simstruc.h"
 #endif
 #include "odesup.h"
+#include "rt_odestage.h"
 
 static const real_T rt_ODE3_A[3] = {
     1.0/2.0, 3.0/4.0, 1.0
@@ -114,9 +115,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     /* f(:,2) = feval(odefile, t + hA(1), y + f*hB(:,1), args(:)(*)); */
     hB[0] = h * rt_ODE3_B[0][0];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0]);
-    }
+    rt_ODEStageUpdate(x, y, id->f, hB, 1, nXc);
     rtsiSetT(si, t + h*rt_ODE3_A[0]);
     rtsiSetdX(si, f1);
     OUTPUTS(si,0);
@@ -124,9 +123,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     /* f(:,3) = feval(odefile, t + hA(2), y + f*hB(:,2), args(:)(*)); */
     for (i = 0; i <= 1; i++) hB[i] = h * rt_ODE3_B[1][i];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0] + f1[i]*hB[1]);
-    }
+    rt_ODEStageUpdate(x, y, id->f, hB, 2, nXc);
     rtsiSetT(si, t + h*rt_ODE3_A[1]);
     rtsiSetdX(si, f2);
     OUTPUTS(si,0);
@@ -135,9 +132,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
     /* tnew = t + hA(3);
        ynew = y + f*hB(:,3); */
     for (i = 0; i <= 2; i++) hB[i] = h * rt_ODE3_B[2][i];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0] + f1[i]*hB[1] + f2[i]*hB[2]);
-    }
+    rt_ODEStageUpdate(x, y, id->f, hB, 3, nXc);
     rtsiSetT(si, tnew);
 
     PROJECTION(si);
@@ -14,6 +14,7 @@
 # include "simstruc.h"
 #endif
 #include "odesup.h"
+#include "rt_odestage.h"
 
 static const real_T rt_ODE5_A[6] = {
     1.0/5.0, 3.0/10.0, 4.0/5.0, 8.0/9.0, 1.0, 1.0
@@ -126,9 +127,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     /* f(:,2) = feval(odefile, t + hA(1), y + f*hB(:,1), args(:)(*)); */
     hB[0] = h * rt_ODE5_B[0][0];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0]);
-    }
+    rt_ODEStageUpdate(x, y, intgData->f, hB, 1, nXc);
     rtsiSetT(si, t + h*rt_ODE5_A[0]);
     rtsiSetdX(si, f1);
     OUTPUTS(si,0);
@@ -136,9 +135,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     /* f(:,3) = feval(odefile, t + hA(2), y + f*hB(:,2), args(:)(*)); */
     for (i = 0; i <= 1; i++) hB[i] = h * rt_ODE5_B[1][i];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0] + f1[i]*hB[1]);
-    }
+    rt_ODEStageUpdate(x, y, intgData->f, hB, 2, nXc);
     rtsiSetT(si, t + h*rt_ODE5_A[1]);
     rtsiSetdX(si, f2);
     OUTPUTS(si,0);
@@ -146,9 +143,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     /* f(:,4) = feval(odefile, t + hA(3), y + f*hB(:,3), args(:)(*)); */
     for (i = 0; i <= 2; i++) hB[i] = h * rt_ODE5_B[2][i];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0] + f1[i]*hB[1] + f2[i]*hB[2]);
-    }
+    rt_ODEStageUpdate(x, y, intgData->f, hB, 3, nXc);
     rtsiSetT(si, t + h*rt_ODE5_A[2]);
     rtsiSetdX(si, f3);
     OUTPUTS(si,0);
@@ -156,10 +151,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     /* f(:,5) = feval(odefile, t + hA(4), y + f*hB(:,4), args(:)(*)); */
     for (i = 0; i <= 3; i++) hB[i] = h * rt_ODE5_B[3][i];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0] + f1[i]*hB[1] + f2[i]*hB[2] +
-		       f3[i]*hB[3]);
-    }
+    rt_ODEStageUpdate(x, y, intgData->f, hB, 4, nXc);
     rtsiSetT(si, t + h*rt_ODE5_A[3]);
     rtsiSetdX(si, f4);
     OUTPUTS(si,0);
@@ -167,10 +159,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     /* f(:,6) = feval(odefile, t + hA(5), y + f*hB(:,5), args(:)(*)); */
     for (i = 0; i <= 4; i++) hB[i] = h * rt_ODE5_B[4][i];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0] + f1[i]*hB[1] + f2[i]*hB[2] +
-		       f3[i]*hB[3] + f4[i]*hB[4]);
-    }
+    rt_ODEStageUpdate(x, y, intgData->f, hB, 5, nXc);
     rtsiSetT(si, tnew);
     rtsiSetdX(si, f5);
     OUTPUTS(si,0);
@@ -179,10 +168,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
     /* tnew = t + hA(6);
        ynew = y + f*hB(:,6); */
     for (i = 0; i <= 5; i++) hB[i] = h * rt_ODE5_B[5][i];
-    for (i = 0; i < nXc; i++) {
-	x[i] = y[i] + (f0[i]*hB[0] + f1[i]*hB[1] + f2[i]*hB[2] +
-		       f3[i]*hB[3] + f4[i]*hB[4] + f5[i]*hB[5]);
-    }
+    rt_ODEStageUpdate(x, y, intgData->f, hB, 6, nXc);
 
     PROJECTION(si);
     REDUCTION(si);
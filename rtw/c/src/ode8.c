@@ -14,6 +14,7 @@
 # include "simstruc.h"
 #endif
 #include "odesup.h"
+#include "rt_odestage.h"
 
 #define MAT13 {0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0}
 #define TWODMAT13 {MAT13,MAT13,MAT13,MAT13,MAT13,MAT13,MAT13,MAT13,MAT13,MAT13,MAT13,MAT13,MAT13}
@@ -204,7 +205,7 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 	real_T    *x0        = intgData->x0;
 	real_T*	  f[NSTAGES];
 	int idx,stagesIdx,statesIdx;
-	double deltaX;
+	real_T    hA[NSTAGES];
     
 #ifdef NCSTATES
     int_T     nXc        = NCSTATES;
@@ -234,16 +235,16 @@ void rt_ODEUpdateContinuousStates(RTWSolverInfo *si)
 
     for(stagesIdx=0;stagesIdx<NSTAGES;stagesIdx++)
 	{
-		memcpy(x,x0,nXc*sizeof(real_T));
-		
-		for(statesIdx=0;statesIdx<nXc;statesIdx++)
+		if(stagesIdx==0)
+		{
+			memcpy(x,x0,nXc*sizeof(real_T));
+		}else
 		{
-			deltaX = 0;
 			for(idx=0;idx<stagesIdx;idx++)
 			{
-				deltaX = deltaX + h*rt_ODE8_A[stagesIdx][idx]*f[idx][statesIdx];
+				hA[idx] = h*rt_ODE8_A[stagesIdx][idx];
 			}
-			x[statesIdx] = x0[statesIdx] + deltaX;
+			rt_ODEStageUpdate(x, x0, f, hA, stagesIdx, nXc);
 		}
 		
         if(stagesIdx==0)
@@ -33,6 +33,7 @@
 
 #include "sigstream_rtw.h"
 #include "common_utils.h"
+#include "rt_matmap.h"
 
 extern mxClassID rt_GetMxIdFromDTypeIdForRSim(BuiltInDTypeId dTypeID); 
 extern mxClassID rt_GetMxIdFromDTypeId(BuiltInDTypeId dTypeID); 
@@ -72,6 +73,10 @@ void  *gblISigstreamManager = NULL;
 void  *gblOSigstreamManager = NULL;
 void  *slioCatalogue = NULL;
 
+/* mapping of the inport MAT-file the TU tables point into, see
+ * rt_MapInportsMatFile */
+static RTMatMapFile *gblInportMatMap = NULL;
+
 #define INVALID_DTYPE_ID   (-10)
 #define SINGLEVAR_MATRIX   (0)
 #define SINGLEVAR_STRUCT   (1)
@@ -1289,6 +1294,301 @@ EXIT_POINT:
 } /* rt_ConvertInportsMatDatatoTUtable */        
 
 
+/* Function: rt_MapInportTUtableElement =======================================
+ * Abstract:
+ * Set the TU table of an inport to data in the mapping of the inport
+ * MAT-file, like setGblInportTUtableElement without copying the data.
+ */
+static void rt_MapInportTUtableElement(int_T         inportIdx,
+                                       size_t        numOfTimePoints,
+                                       const double  *timeDataPtr,
+                                       const void    *matDataRe,
+                                       const void    *matDataIm)
+{
+    rtInportTUtable *tuTable = &gblInportTUtables[inportIdx];
+
+    tuTable->complex           = gblInportComplex[inportIdx] ? 1 : 0;
+    tuTable->isPeriodicFcnCall = false;
+    tuTable->nTimePoints       = (int_T) numOfTimePoints;
+    tuTable->uDataType         = gblInportDataTypeIdx[inportIdx];
+    tuTable->currTimeIdx       = (timeDataPtr != NULL) ? 0 : -1;
+
+    if (numOfTimePoints == 0) {
+        tuTable->time = NULL;
+        tuTable->ur   = NULL;
+        tuTable->ui   = NULL;
+    } else {
+        /* the TU table is only read, see rt_RapidFreeGbls */
+        tuTable->time = (double *)timeDataPtr;
+        tuTable->ur   = (void *)matDataRe;
+        tuTable->ui   = (void *)matDataIm;
+    }
+} /* rt_MapInportTUtableElement */
+
+
+/* Function: rt_MapCheckTimeVector ============================================
+ * Abstract:
+ * Check a time vector of a mapped inport MAT-file the way
+ * rt_VerifyInportsMatFile does, for inport inportIdx or for all inports if
+ * inportIdx is negative.
+ *
+ * Returns:
+ *	true : the time vector is valid and can be used from the mapping
+ *	false: read the file with matOpen instead
+ */
+static bool rt_MapCheckTimeVector(const RTMatMapArray *time,
+                                  int_T               inportIdx,
+                                  const char          *inportFileName)
+{
+    int_T i;
+
+    if (time->nEls == 0) {
+        /* no time: interpolation must be off and sample times discrete */
+        for (i = 0; i < gblNumRootInportBlks; ++i) {
+            if ((inportIdx < 0 || i == inportIdx) &&
+                (gblInportInterpoFlag[i] != 0 || gblInportContinuous[i] == 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return time->classID == mxDOUBLE_CLASS && !time->isComplex &&
+        time->re != NULL &&
+        rt_VerifyTimeMonotone((const double *)time->re, time->nEls, 1,
+                              inportFileName) == NULL;
+} /* rt_MapCheckTimeVector */
+
+
+/* Function: rt_MapInportMatrix ===============================================
+ * Abstract:
+ * Check a TU matrix variable of a mapped inport MAT-file for the nPorts
+ * inports from inportIdx on, and point their TU tables into it. The checks
+ * are those of rt_VerifyInportsMatFile for the single TU matrix
+ * (isSingleVar) or one matrix per inport.
+ *
+ * Returns:
+ *	true : the TU tables are set
+ *	false: read the file with matOpen instead
+ */
+static bool rt_MapInportMatrix(const RTMatMapArray *var,
+                               int_T               inportIdx,
+                               int_T               nPorts,
+                               bool                isSingleVar,
+                               const char          *inportFileName)
+{
+    const char *matDataRe;
+    size_t     numOfTimePoints;
+    int_T      nCols = 1;
+    int_T      i;
+
+    for (i = inportIdx; i < inportIdx + nPorts; ++i) {
+        /* complex and 2-D inports only produce warnings and errors */
+        if (gblInportDataTypeIdx[i] != SS_DOUBLE || gblInportComplex[i] == 1 ||
+            (isSingleVar && gblInportDims[2*i + 1] != 1)) {
+            return false;
+        }
+        nCols += gblInportDims[2*i]*gblInportDims[2*i + 1];
+    }
+    if (var->classID != mxDOUBLE_CLASS || var->re == NULL ||
+        var->nEls == 0 || var->nDims != 2 || var->dims[1] != nCols ||
+        (isSingleVar && nCols < 2)) {
+        return false;
+    }
+
+    /* the first column is the time vector */
+    numOfTimePoints = (size_t) var->dims[0];
+    if (rt_VerifyTimeMonotone((const double *)var->re, numOfTimePoints, 1,
+                              inportFileName) != NULL) {
+        return false;
+    }
+
+    matDataRe = (const char *)var->re + numOfTimePoints*sizeof(double);
+    for (i = inportIdx; i < inportIdx + nPorts; ++i) {
+        int_T portWidth = gblInportDims[2*i]*gblInportDims[2*i + 1];
+
+        rt_MapInportTUtableElement(i, numOfTimePoints,
+                                   (const double *)var->re, matDataRe, NULL);
+        matDataRe += portWidth*numOfTimePoints*sizeof(double);
+    }
+    return true;
+} /* rt_MapInportMatrix */
+
+
+/* Function: rt_MapInportStruct ===============================================
+ * Abstract:
+ * Check a structure-format variable of a mapped inport MAT-file for the
+ * nPorts inports from inportIdx on, and point their TU tables into it. The
+ * checks are those of rt_VerifyInportsMatFile and
+ * rt_CheckMatFileWithStructVar, for the single structure (isSingleVar) or
+ * one structure per inport.
+ *
+ * Returns:
+ *	true : the TU tables are set
+ *	false: read the file with matOpen instead
+ */
+static bool rt_MapInportStruct(const RTMatMapArray *var,
+                               int_T               inportIdx,
+                               int_T               nPorts,
+                               bool                isSingleVar,
+                               const char          *inportFileName)
+{
+    RTMatMapArray time;
+    RTMatMapArray signals;
+    int_T         sigIdx;
+
+    if (rt_MatMapGetField(var, 0, "time", &time) <= 0 ||
+        rt_MatMapGetField(var, 0, "signals", &signals) <= 0 ||
+        !rt_MapCheckTimeVector(&time, isSingleVar ? -1 : inportIdx,
+                               inportFileName)) {
+        return false;
+    }
+    if (isSingleVar && (signals.nDims != 2 || signals.dims[1] != nPorts)) {
+        return false;
+    }
+
+    for (sigIdx = 0; sigIdx < nPorts; ++sigIdx) {
+        int_T         i = inportIdx + sigIdx;
+        RTMatMapArray values;
+        RTMatMapArray dimensions;
+        int           hasDims;
+        size_t        numOfTimePoints;
+        mxClassID     mxIDfromModel;
+
+        if (rt_MatMapGetField(&signals, sigIdx, "values", &values) <= 0 ||
+            (hasDims = rt_MatMapGetField(&signals, sigIdx, "dimensions",
+                                         &dimensions)) < 0 ||
+            values.re == NULL || values.nEls == 0 ||
+            values.isComplex != (gblInportComplex[i] == 1) ||
+            (values.isComplex && values.im == NULL) ||
+            (values.nDims != 2 && values.nDims != 3)) {
+            return false;
+        }
+
+        /* 'dimensions' must agree with the dimensions of 'values' */
+        if (hasDims) {
+            double dim0, dim1;
+
+            if (dimensions.isComplex || dimensions.classID < mxDOUBLE_CLASS ||
+                dimensions.classID > mxUINT64_CLASS ||
+                dimensions.nEls < 1 || dimensions.nEls > 2) {
+                return false;
+            }
+            dim0 = rt_MatMapGetScalar(&dimensions, 0);
+            dim1 = rt_MatMapGetScalar(&dimensions, dimensions.nEls - 1);
+            if (dim0 != floor(dim0) || dim1 != floor(dim1)) return false;
+            if (dimensions.nEls == 1) {
+                if (values.nDims != 2 || values.dims[1] != dim0) return false;
+            } else if (values.dims[0] != dim0 || values.dims[1] != dim1) {
+                return false;
+            }
+        }
+
+        /* the values of a time step are a row or a leading matrix */
+        if ((values.nDims == 2 && values.dims[1] != gblInportDims[2*i]) ||
+            (values.nDims == 3 && (values.dims[0] != gblInportDims[2*i] ||
+                                   values.dims[1] != gblInportDims[2*i + 1]))) {
+            return false;
+        }
+        numOfTimePoints = (size_t) ((values.nDims == 2) ? values.dims[0] :
+                                    values.dims[values.nDims-1]);
+        if (time.nEls > 0 && time.nEls != numOfTimePoints) return false;
+
+        mxIDfromModel = rt_GetMxIdFromDTypeIdForRSim(gblInportDataTypeIdx[i]);
+        if (mxIDfromModel != mxUNKNOWN_CLASS &&
+            (int) mxIDfromModel != values.classID) {
+            return false;
+        }
+
+        rt_MapInportTUtableElement(i, numOfTimePoints,
+                                   (time.nEls > 0) ? (const double *)time.re :
+                                   NULL,
+                                   values.re, values.im);
+    }
+    return true;
+} /* rt_MapInportStruct */
+
+
+/* Function: rt_MapInportsMatFile =============================================
+ * Abstract:
+ * Load the inport MAT-file of rsim through a memory mapping. The variables
+ * are located by their element headers, and the TU tables point into the
+ * mapping, so nothing is read or copied before the simulation uses it. Only
+ * files that rt_VerifyInportsMatFile accepts and whose data can be used in
+ * place are loaded this way; everything else (compressed files, integer
+ * data saved with a narrower type, function-call inports, files with
+ * errors or warnings) is left to rt_VerifyInportsMatFile and
+ * rt_ConvertInportsMatDatatoTUtable.
+ *
+ * The mapping is kept until the end of the run, so the file must not be
+ * changed while the simulation runs (see rt_matmap.h).
+ *
+ * Returns:
+ *	true : the TU tables are set
+ *	false: read the file with matOpen instead
+ */
+static bool rt_MapInportsMatFile(const char *inportFileName,
+                                 int        *matFileDataFormat)
+{
+    const char    *errStatus;
+    RTMatMapFile  *mmf;
+    RTMatMapArray var;
+    int_T         numVarInMatFile = 0;
+    int_T         inportIdx;
+    int           status;
+    bool          isMapped = false;
+
+    if ((mmf = rt_MatMapOpen(inportFileName, &errStatus)) == NULL) {
+        return false;
+    }
+    while ((status = rt_MatMapNextVariable(mmf, &var)) > 0) {
+        ++numVarInMatFile;
+    }
+    if (status < 0 || numVarInMatFile == 0) goto EXIT_POINT;
+
+    for (inportIdx = 0; inportIdx < gblNumRootInportBlks; ++inportIdx) {
+        if (gblInportDataTypeIdx[inportIdx] == SS_FCN_CALL) goto EXIT_POINT;
+    }
+
+    gblInportTUtables = (rtInportTUtable*)
+        malloc(sizeof(rtInportTUtable)*gblNumRootInportBlks);
+    if (gblInportTUtables == NULL) goto EXIT_POINT;
+
+    rt_MatMapRewind(mmf);
+    (void)rt_MatMapNextVariable(mmf, &var);
+
+    if (numVarInMatFile == 1) {
+        if (var.classID != mxSTRUCT_CLASS) {
+            *matFileDataFormat = SINGLEVAR_MATRIX;
+            isMapped = rt_MapInportMatrix(&var, 0, gblNumRootInportBlks, true,
+                                          inportFileName);
+        } else {
+            *matFileDataFormat = SINGLEVAR_STRUCT;
+            isMapped = rt_MapInportStruct(&var, 0, gblNumRootInportBlks, true,
+                                          inportFileName);
+        }
+    } else if (numVarInMatFile == gblNumRootInportBlks) {
+        *matFileDataFormat = MULTIPLEVAR_LIST;
+        for (inportIdx = 0; inportIdx < gblNumRootInportBlks; ++inportIdx) {
+            isMapped = (var.classID != mxSTRUCT_CLASS) ?
+                rt_MapInportMatrix(&var, inportIdx, 1, false, inportFileName) :
+                rt_MapInportStruct(&var, inportIdx, 1, false, inportFileName);
+            if (!isMapped) break;
+            (void)rt_MatMapNextVariable(mmf, &var);
+        }
+    }
+
+EXIT_POINT:
+    if (isMapped) {
+        gblInportMatMap = mmf;
+    } else {
+        free(gblInportTUtables);
+        gblInportTUtables = NULL;
+        rt_MatMapClose(mmf);
+    }
+    return isMapped;
+} /* rt_MapInportsMatFile */
+
+
 
 /* Function: FreeFNamePairList ================================================
  * Abstract:
@@ -1335,8 +1635,11 @@ const char *rt_RapidReadFromFileBlockMatFile(const char *origFileName,
                                    FrFInfo * frFInfo)
 {
     static char  errmsg[1024];
-    MATFile      *pmat;
+    MATFile      *pmat = NULL;
     mxArray      *tuData_mxArray_ptr = NULL;
+    RTMatMapFile *mmf;
+    RTMatMapArray tuData;
+    const char   *mapStatus;
     const double *matData;
     size_t       nbytes;
     int          nrows, ncols;
@@ -1366,27 +1669,43 @@ const char *rt_RapidReadFromFileBlockMatFile(const char *origFileName,
         }
     }
 
-    if ((pmat=matOpen(matFile=frFInfo->newFileName,"r")) == NULL) {
-        (void)sprintf(errmsg,"could not open MAT-file '%s' containing "
-                      "From File Block data", matFile);
-        goto EXIT_POINT;
-    }
+    /*
+     * Transpose straight from a mapping of the file if the matrix is stored
+     * as doubles (see rt_matmap.h), else read it into an mxArray first. The
+     * data is copied either way: tuDataMatrix is transposed and owned by
+     * frFInfo, so From File is not on the zero-copy path of the inports.
+     */
+    mmf = rt_MatMapOpen(matFile=frFInfo->newFileName, &mapStatus);
+    if (mmf != NULL && rt_MatMapNextVariable(mmf, &tuData) > 0 &&
+        tuData.classID == mxDOUBLE_CLASS && tuData.re != NULL &&
+        tuData.nDims == 2) {
+        nrows   = (int) tuData.dims[0];
+        ncols   = (int) tuData.dims[1];
+        matData = (const double *)tuData.re;
+    } else {
+        if ((pmat=matOpen(matFile,"r")) == NULL) {
+            (void)sprintf(errmsg,"could not open MAT-file '%s' containing "
+                          "From File Block data", matFile);
+            goto EXIT_POINT;
+        }
 
-    if ( (tuData_mxArray_ptr=matGetNextVariable(pmat,NULL)) == NULL) {
-        (void)sprintf(errmsg,"could not locate a variable in MAT-file '%s'",
-                      matFile);
-        goto EXIT_POINT;
+        if ( (tuData_mxArray_ptr=matGetNextVariable(pmat,NULL)) == NULL) {
+            (void)sprintf(errmsg,"could not locate a variable in MAT-file '%s'",
+                          matFile);
+            goto EXIT_POINT;
+        }
+
+        nrows   = (int) mxGetM(tuData_mxArray_ptr);
+        ncols   = (int) mxGetN(tuData_mxArray_ptr);
+        matData = mxGetPr(tuData_mxArray_ptr);
     }
 
-    nrows= (int) mxGetM(tuData_mxArray_ptr);
     if ( nrows<2 ) {
         (void)sprintf(errmsg,"\"From File\" matrix variable from MAT-file "
                       "'%s' must contain at least 2 rows", matFile);
         goto EXIT_POINT;
     }
 
-    ncols= (int) mxGetN(tuData_mxArray_ptr);
-
     frFInfo->nptsPerSignal = ncols;
     frFInfo->nptsTotal     = nrows * ncols;
 
@@ -1398,8 +1717,6 @@ const char *rt_RapidReadFromFileBlockMatFile(const char *origFileName,
         goto EXIT_POINT;
     }
 
-    matData = mxGetPr(tuData_mxArray_ptr);
-
     /*
      * Verify that the time vector is monotonically increasing.
      */
@@ -1440,6 +1757,8 @@ const char *rt_RapidReadFromFileBlockMatFile(const char *origFileName,
 
 EXIT_POINT:
 
+    rt_MatMapClose(mmf);
+
     if (pmat!=NULL) {
         matClose(pmat);
         pmat = NULL;
@@ -1503,6 +1822,12 @@ const char *rt_RapidReadInportsMatFile(const char* inportFileName, int* matFileF
         }
     }
 
+    /* rsim points the TU tables into a mapping of the file if it can */
+    if (!isRaccel && rt_MapInportsMatFile(inportFileName, matFileFormat)) {
+        printf(" *** %s is successfully loaded! ***\n", inportFileName);
+        goto EXIT_POINT;
+    }
+
     periodicFunctionCallInports = malloc(sizeof(mxLogical)*gblNumRootInportBlks);
     if (periodicFunctionCallInports == NULL) {
         (void)sprintf(errmsg,"Memory allocation error"); 
@@ -1811,7 +2136,13 @@ void rt_RapidFreeGbls(int matFileFormat)
     FreeFNamePairList(gblToFNamepair, gblNumToFiles);
     FreeFNamePairList(gblFrFNamepair, gblNumFrFiles);
     
-    if(gblNumRootInportBlks>0){
+    if (gblInportMatMap != NULL) {
+        /* the TU tables point into the mapping */
+        free(gblInportTUtables);
+        gblInportTUtables = NULL;
+        rt_MatMapClose(gblInportMatMap);
+        gblInportMatMap = NULL;
+    } else if(gblNumRootInportBlks>0){
         int i;
         if (gblInportTUtables!= NULL){
             for(i=0; i< gblNumRootInportBlks; i++){
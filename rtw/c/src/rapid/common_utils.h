@@ -72,7 +72,8 @@ extern "C" {
     int         originalWidth;
     int         nptsTotal;
     int         nptsPerSignal;
-    double      *tuDataMatrix;
+    double      *tuDataMatrix;  /* transposed copy of the TU matrix, one
+                                   row of nptsPerSignal points per signal */
 } FrFInfo;
 
 
@@ -33,6 +33,7 @@
 #include "dt_info.h"
 #include "common_utils.h"
 #include  "rsim_utils.h"
+#include  "rt_matmap.h"
 
 /* external variables */
 extern const char   *gblParamFilename;
@@ -58,7 +59,8 @@ void rt_FreeParamStructs(PrmStructData *paramStructure)
         DTParamInfo *dtParamInfo = paramStructure->dtParamInfo;
 
         if (dtParamInfo != NULL) {
-            for (i=0; i<nTrans; i++) {
+            /* values in a mapping are released with the mapping */
+            for (i=0; paramStructure->matMap == NULL && i<nTrans; i++) {
                 /*
                  * Must free "stolen" parts of matrices with
                  * mxFree (they are allocated with mxCalloc).
@@ -73,11 +75,136 @@ void rt_FreeParamStructs(PrmStructData *paramStructure)
             free(dtParamInfo);
         }
 
+        rt_MatMapClose(paramStructure->matMap);
+
         paramStructure->nTrans      = 0;
         paramStructure->dtParamInfo = NULL;
+        paramStructure->matMap      = NULL;
     }
 } /* end rt_FreeParamStructs */
 
+
+/* Function: rt_MapParamStructMatFile ========================================
+ * Abstract:
+ *  Read the parameter structure from a memory mapping of the parameter
+ *  MAT-file. The values of the DTParamInfo's point into the mapping, so
+ *  only the pages that ReplaceRtP copies into rtP are read. Only files that
+ *  rt_ReadParamStructMatFile accepts and whose values can be used in place
+ *  are read this way (see rt_matmap.h).
+ *
+ * Returns:
+ *	true : paramStructure is filled in
+ *	false: read the file with matOpen instead
+ */
+static bool rt_MapParamStructMatFile(PrmStructData *paramStructure,
+                                     int           cellParamIndex)
+{
+    size_t        nTrans;
+    size_t        i;
+    const char    *errStatus;
+    RTMatMapFile  *mmf;
+    RTMatMapArray pa;
+    RTMatMapArray paModelChecksum;
+    RTMatMapArray paParamStructs;
+    RTMatMapArray dum;
+    int           status;
+
+    if ((mmf = rt_MatMapOpen(gblParamFilename, &errStatus)) == NULL) {
+        return false;
+    }
+    paramStructure->matMap = mmf;
+
+    /* 1x1 structure with a modelChecksum field */
+    if (rt_MatMapNextVariable(mmf, &pa) <= 0 ||
+        pa.classID != mxSTRUCT_CLASS || pa.nDims != 2 ||
+        pa.dims[0] != 1 || pa.dims[1] != 1 ||
+        rt_MatMapGetField(&pa, 0, "modelChecksum", &paModelChecksum) <= 0 ||
+        paModelChecksum.classID != mxDOUBLE_CLASS ||
+        paModelChecksum.isComplex || paModelChecksum.nDims != 2 ||
+        paModelChecksum.dims[0] < 1 || paModelChecksum.dims[1] != 4) {
+        goto ERROR_EXIT;
+    }
+    for (i=0; i<4; i++) {
+        paramStructure->checksum[i] = rt_MatMapGetScalar(&paModelChecksum, i);
+    }
+
+    if ((status = rt_MatMapGetField(&pa, 0, "parameters",
+                                    &paParamStructs)) == 0) {
+        return true;
+    }
+    if (status < 0) goto ERROR_EXIT;
+
+    if (paParamStructs.classID == mxCELL_CLASS) {
+        RTMatMapArray paCell = paParamStructs;
+
+        if (cellParamIndex <= 0 || (size_t)cellParamIndex > paCell.nEls ||
+            rt_MatMapGetCell(&paCell, cellParamIndex-1, &paParamStructs) <= 0) {
+            goto ERROR_EXIT;
+        }
+    }
+
+    nTrans = paParamStructs.nEls;
+    if (nTrans == 0) return true;
+
+    if (rt_MatMapGetField(&paParamStructs, 0, "dataTypeName", &dum) <= 0 ||
+        rt_MatMapGetField(&paParamStructs, 0, "dataTypeId", &dum) <= 0 ||
+        rt_MatMapGetField(&paParamStructs, 0, "complex", &dum) <= 0 ||
+        rt_MatMapGetField(&paParamStructs, 0, "dtTransIdx", &dum) <= 0) {
+        goto ERROR_EXIT;
+    }
+
+    paramStructure->dtParamInfo = (DTParamInfo *)
+        calloc(nTrans,sizeof(DTParamInfo));
+    if (paramStructure->dtParamInfo == NULL) goto ERROR_EXIT;
+    paramStructure->nTrans = nTrans;
+
+    paramStructure->numParams = 0;
+    for (i=0; i<nTrans; i++) {
+        RTMatMapArray paDataTypeId, paComplex, paDtTransIdx, paValues;
+        DTParamInfo   *dtprmInfo = &paramStructure->dtParamInfo[i];
+
+        if (rt_MatMapGetField(&paParamStructs,i,"dataTypeId",
+                              &paDataTypeId) <= 0 ||
+            rt_MatMapGetField(&paParamStructs,i,"complex",&paComplex) <= 0 ||
+            rt_MatMapGetField(&paParamStructs,i,"dtTransIdx",
+                              &paDtTransIdx) <= 0 ||
+            paDataTypeId.nEls == 0 || paDataTypeId.reData == NULL ||
+            paComplex.nEls == 0 || paComplex.reData == NULL ||
+            paDtTransIdx.nEls == 0 || paDtTransIdx.reData == NULL ||
+            (status = rt_MatMapGetField(&paParamStructs,i,"values",
+                                        &paValues)) < 0) {
+            goto ERROR_EXIT;
+        }
+        dtprmInfo->dataType   = (int)rt_MatMapGetScalar(&paDataTypeId, 0);
+        dtprmInfo->complex    = (bool)rt_MatMapGetScalar(&paComplex, 0);
+        dtprmInfo->dtTransIdx = (int)rt_MatMapGetScalar(&paDtTransIdx, 0);
+
+        if (status > 0 && paValues.nEls > 0) {
+            /* the values are used in place, they must be held as in rtP */
+            if (paValues.re == NULL ||
+                (paValues.isComplex && paValues.im == NULL)) {
+                goto ERROR_EXIT;
+            }
+#if defined(MX_HAS_INTERLEAVED_COMPLEX)
+            if (paValues.isComplex) goto ERROR_EXIT;
+            dtprmInfo->vals   = (void *)paValues.re;
+#else
+            dtprmInfo->rVals  = (void *)paValues.re;
+            dtprmInfo->iVals  = (void *)paValues.im;
+#endif
+            dtprmInfo->elSize = paValues.elSize;
+            dtprmInfo->nEls   = paValues.nEls;
+        }
+
+        paramStructure->numParams += dtprmInfo->nEls;
+    }
+    return true;
+
+  ERROR_EXIT:
+    rt_FreeParamStructs(paramStructure);
+    return false;
+} /* end rt_MapParamStructMatFile */
+
 /* Function: rt_ReadParamStructMatFile=======================================
  * Abstract:
  *  Reads a matfile containing a new parameter structure.  It also reads the
@@ -101,6 +228,11 @@ const char *rt_ReadParamStructMatFile(PrmStructData **prmStructOut,
 
     paramStructure = &gblPrmStruct;
 
+    /* use the values in place from a mapping of the file if possible */
+    if (rt_MapParamStructMatFile(paramStructure, cellParamIndex)) {
+        goto EXIT_POINT;
+    }
+
     /**************************************************************************
      * Open parameter MAT-file, read checksum, swap rtP data for type Double *
      **************************************************************************/
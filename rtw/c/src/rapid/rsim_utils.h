@@ -47,6 +47,10 @@ typedef struct {
 
     size_t nTrans;    
     DTParamInfo *dtParamInfo;
+
+    /* mapping of the MAT-file the values point into, NULL if they were
+     * read with matGetNextVariable (see rt_matmap.h) */
+    struct RTMatMapFile_Tag *matMap;
 } PrmStructData;
 
 extern void rt_RapidReadMatFileAndUpdateParams(const SimStruct *S);
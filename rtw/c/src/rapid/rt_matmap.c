@@ -0,0 +1,560 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matmap.c
+ *
+ * Abstract:
+ *   Memory mapped reader of level 5 MAT-files (see rt_matmap.h).
+ *
+ *   A MAT-file is a 128 byte header followed by data elements. Each element
+ *   starts with a tag of its type and size, and is padded to 8 bytes, so the
+ *   data of an element that starts inside the mapping is 8-byte aligned. A
+ *   variable is an miMATRIX element whose sub-elements are the array flags,
+ *   the dimensions, the name and the real and imaginary data; the fields of
+ *   a struct and the cells of a cell array are miMATRIX sub-elements of
+ *   their own. Elements of at most 4 bytes may be packed into their tag
+ *   (small data element format).
+ *
+ *   POSIX systems use a private read-only mmap and Windows MapViewOfFile
+ *   of a file opened without write sharing. With RT_MATMAP_NO_MMAP
+ *   rt_MatMapOpen always fails, so that the callers read the file with
+ *   matOpen.
+ */
+
+#if !defined(_WIN32) && !defined(RT_MATMAP_NO_MMAP)
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# define MATMAP_POSIX_MMAP
+# include <sys/types.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#elif defined(_WIN32) && !defined(RT_MATMAP_NO_MMAP)
+# define MATMAP_WIN32_MMAP
+# include <windows.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "rt_matmap.h"
+
+/* data element types */
+#define miINT8          1
+#define miUINT8         2
+#define miINT16         3
+#define miUINT16        4
+#define miINT32         5
+#define miUINT32        6
+#define miSINGLE        7
+#define miDOUBLE        9
+#define miINT64         12
+#define miUINT64        13
+#define miMATRIX        14
+#define miCOMPRESSED    15
+#define miUTF8          16
+
+/* array classes as stored in the file, the same values as mxClassID */
+#define MATMAP_CELL     1
+#define MATMAP_STRUCT   2
+#define MATMAP_CHAR     4
+#define MATMAP_DOUBLE   6
+#define MATMAP_UINT64   15
+#define MATMAP_LOGICAL  3               /* mxLOGICAL_CLASS                    */
+
+#define MATMAP_COMPLEX_FLAG  0x0800U
+#define MATMAP_LOGICAL_FLAG  0x0200U
+
+#define MATMAP_HEADER_SIZE   128
+#define MATMAP_ALIGN(n)      ( ( ((size_t)(n))+7 ) & (~((size_t)7)) )
+
+struct RTMatMapFile_Tag {
+    const char *base;                   /* contents of the file               */
+    size_t     size;
+    const char *next;                   /* next top level element             */
+#ifdef MATMAP_WIN32_MMAP
+    HANDLE     file;
+    HANDLE     mapping;
+#endif
+};
+
+/* dimensions of an empty miMATRIX, which stands for [] in cells and fields */
+static const int32_T rt_MatMapEmptyDims[2] = { 0, 0 };
+
+
+/* Function: rt_MatMapGetTag ===================================================
+ * Abstract:
+ *      Decode the tag of the element at p, which must end before end. Return
+ *      0 if the element does not fit.
+ */
+static int rt_MatMapGetTag(const char *p,
+                           const char *end,
+                           uint32_T   *type,
+                           size_t     *nBytes,
+                           const char **data,
+                           const char **next)
+{
+    uint32_T word[2];
+
+    if (end - p < 8) return(0);
+    (void)memcpy(word, p, sizeof(word));
+
+    if ((word[0] >> 16) != 0) {
+        /* small data element format */
+        *type   = word[0] & 0xFFFFU;
+        *nBytes = (size_t) (word[0] >> 16);
+        *data   = p + 4;
+        *next   = p + 8;
+        return(*nBytes <= 4);
+    }
+    *type   = word[0];
+    *nBytes = (size_t) word[1];
+    *data   = p + 8;
+    if (*nBytes > (size_t) (end - *data)) return(0);
+    /* compressed elements are not padded, the last element may not be */
+    if (*type == miCOMPRESSED ||
+        MATMAP_ALIGN(*nBytes) > (size_t) (end - *data)) {
+        *next = *data + *nBytes;
+    } else {
+        *next = *data + MATMAP_ALIGN(*nBytes);
+    }
+    return(1);
+
+} /* end rt_MatMapGetTag */
+
+
+/* Function: rt_MatMapTypeSize =================================================
+ * Abstract:
+ *      Size of an element of a numeric data type, 0 for other types.
+ */
+static size_t rt_MatMapTypeSize(uint32_T type)
+{
+    switch (type) {
+      case miINT8:   case miUINT8:  case miUTF8: return(1);
+      case miINT16:  case miUINT16:              return(2);
+      case miINT32:  case miUINT32: case miSINGLE: return(4);
+      case miDOUBLE: case miINT64:  case miUINT64: return(8);
+      default:                                   return(0);
+    }
+
+} /* end rt_MatMapTypeSize */
+
+
+/* Function: rt_MatMapClassType ================================================
+ * Abstract:
+ *      Data type in which the elements of a class are held in memory.
+ */
+static uint32_T rt_MatMapClassType(int classID)
+{
+    static const uint32_T types[] = {
+        0, 0, 0, miUINT8, miUINT16, 0, miDOUBLE, miSINGLE, miINT8, miUINT8,
+        miINT16, miUINT16, miINT32, miUINT32, miINT64, miUINT64
+    };
+
+    return((classID >= 0 && classID <= MATMAP_UINT64) ? types[classID] : 0);
+
+} /* end rt_MatMapClassType */
+
+
+/* Function: rt_MatMapGetData ==================================================
+ * Abstract:
+ *      Return the stored data as a pointer into the mapping if it is held
+ *      with the type of the class of arr and is aligned for it, else NULL.
+ */
+static const void *rt_MatMapGetData(const RTMatMapArray *arr,
+                                    uint32_T            type,
+                                    const char          *data,
+                                    size_t              nBytes)
+{
+    if (type != rt_MatMapClassType(arr->classID) ||
+        nBytes != arr->nEls * arr->elSize ||
+        ((size_t) data) % arr->elSize != 0) {
+        return(NULL);
+    }
+    return(data);
+
+} /* end rt_MatMapGetData */
+
+
+/* Function: rt_MatMapParseArray ===============================================
+ * Abstract:
+ *      Decode the miMATRIX element at p into arr and set *next to the
+ *      element after it. Return 1 upon success, -1 if the element is not an
+ *      array that can be used from the mapping: compressed, sparse, an object
+ *      or not well formed.
+ */
+static int rt_MatMapParseArray(const char    *p,
+                               const char    *end,
+                               RTMatMapArray *arr,
+                               const char    **next)
+{
+    uint32_T   type;
+    size_t     nBytes;
+    const char *data;
+    const char *sub;
+    uint32_T   flags;
+    int        i;
+
+    (void)memset(arr, 0, sizeof(*arr));
+    if (!rt_MatMapGetTag(p, end, &type, &nBytes, &data, next) ||
+        type != miMATRIX) {
+        return(-1);
+    }
+    end = data + nBytes;
+    arr->end = end;
+
+    if (nBytes == 0) {
+        /* [] placeholder */
+        arr->classID = MATMAP_DOUBLE;
+        arr->nDims   = 2;
+        arr->dims    = rt_MatMapEmptyDims;
+        arr->elSize  = sizeof(real_T);
+        return(1);
+    }
+
+    /* array flags */
+    if (!rt_MatMapGetTag(data, end, &type, &nBytes, &data, &sub) ||
+        type != miUINT32 || nBytes != 8) {
+        return(-1);
+    }
+    (void)memcpy(&flags, data, sizeof(flags));
+    arr->classID   = (int) (flags & 0xFFU);
+    arr->isComplex = (flags & MATMAP_COMPLEX_FLAG) != 0;
+
+    /* dimensions */
+    if (!rt_MatMapGetTag(sub, end, &type, &nBytes, &data, &sub) ||
+        type != miINT32 || nBytes < 2 * sizeof(int32_T) ||
+        nBytes % sizeof(int32_T) != 0 || ((size_t) data) % 4 != 0) {
+        return(-1);
+    }
+    arr->nDims = (int) (nBytes / sizeof(int32_T));
+    arr->dims  = (const int32_T*) data;
+    arr->nEls  = 1;
+    for (i = 0; i < arr->nDims; i++) {
+        if (arr->dims[i] < 0) return(-1);
+        arr->nEls *= (size_t) arr->dims[i];
+    }
+
+    /* name */
+    if (!rt_MatMapGetTag(sub, end, &type, &nBytes, &data, &sub) ||
+        type != miINT8) {
+        return(-1);
+    }
+    arr->name    = data;
+    arr->nameLen = nBytes;
+
+    switch (arr->classID) {
+      case MATMAP_CELL:
+        arr->elements = sub;
+        break;
+
+      case MATMAP_STRUCT: {
+          int32_T len;
+
+          if (!rt_MatMapGetTag(sub, end, &type, &nBytes, &data, &sub) ||
+              type != miINT32 || nBytes != sizeof(int32_T)) {
+              return(-1);
+          }
+          (void)memcpy(&len, data, sizeof(len));
+          if (!rt_MatMapGetTag(sub, end, &type, &nBytes, &data, &sub) ||
+              type != miINT8 || len <= 0 || nBytes % (size_t) len != 0) {
+              return(-1);
+          }
+          arr->fieldNameLen = (int) len;
+          arr->nFields      = (int) (nBytes / (size_t) len);
+          arr->fieldNames   = data;
+          arr->elements     = sub;
+          break;
+      }
+
+      default:
+        if (arr->classID == MATMAP_CHAR) {
+            arr->elSize = 2;
+        } else if (arr->classID >= MATMAP_DOUBLE &&
+                   arr->classID <= MATMAP_UINT64) {
+            arr->elSize = rt_MatMapTypeSize(rt_MatMapClassType(arr->classID));
+        } else {
+            return(-1);                 /* sparse, object, function handle  */
+        }
+        if (!rt_MatMapGetTag(sub, end, &type, &nBytes, &data, &sub) ||
+            rt_MatMapTypeSize(type) == 0 ||
+            nBytes != arr->nEls * rt_MatMapTypeSize(type)) {
+            return(-1);
+        }
+        arr->reType  = (int) type;
+        arr->reData  = data;
+        arr->reBytes = nBytes;
+        arr->re      = rt_MatMapGetData(arr, type, data, nBytes);
+        if (arr->isComplex) {
+            if (!rt_MatMapGetTag(sub, end, &type, &nBytes, &data, &sub) ||
+                rt_MatMapTypeSize(type) == 0 ||
+                nBytes != arr->nEls * rt_MatMapTypeSize(type)) {
+                return(-1);
+            }
+            arr->im = rt_MatMapGetData(arr, type, data, nBytes);
+            if (arr->im == NULL) arr->re = NULL;
+        }
+        if (flags & MATMAP_LOGICAL_FLAG) arr->classID = MATMAP_LOGICAL;
+        break;
+    }
+    return(1);
+
+} /* end rt_MatMapParseArray */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Function: rt_MatMapOpen =====================================================
+ * Abstract:
+ *      Map a MAT-file and check its header. Return NULL and set errStatus if
+ *      the file cannot be opened or is not a level 5 MAT-file in the byte
+ *      order of this machine.
+ */
+RTMatMapFile *rt_MatMapOpen(const char *file, const char **errStatus)
+{
+    RTMatMapFile *mmf;
+    uint16_T     version;
+    uint16_T     endian;
+
+    if ((mmf = (RTMatMapFile*) calloc(1, sizeof(RTMatMapFile))) == NULL) {
+        *errStatus = "memory allocation error";
+        return(NULL);
+    }
+
+#if defined(MATMAP_POSIX_MMAP)
+    {
+        struct stat st;
+        void        *base;
+        int         fd;
+
+        if ((fd = open(file, O_RDONLY)) < 0) {
+            *errStatus = "unable to open MAT-file";
+            goto ERROR_EXIT;
+        }
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            (void)close(fd);
+            *errStatus = "unable to read MAT-file";
+            goto ERROR_EXIT;
+        }
+        base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        (void)close(fd);
+        if (base == MAP_FAILED) {
+            *errStatus = "unable to map MAT-file";
+            goto ERROR_EXIT;
+        }
+        mmf->base = (const char*) base;
+        mmf->size = (size_t) st.st_size;
+    }
+#elif defined(MATMAP_WIN32_MMAP)
+    {
+        LARGE_INTEGER fileSize;
+
+        mmf->file = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (mmf->file == INVALID_HANDLE_VALUE) {
+            mmf->file  = NULL;
+            *errStatus = "unable to open MAT-file";
+            goto ERROR_EXIT;
+        }
+        if (!GetFileSizeEx(mmf->file, &fileSize) || fileSize.QuadPart <= 0 ||
+            (mmf->mapping = CreateFileMappingA(mmf->file, NULL, PAGE_READONLY,
+                                               0, 0, NULL)) == NULL ||
+            (mmf->base = (const char*) MapViewOfFile(mmf->mapping,
+                                                     FILE_MAP_READ,
+                                                     0, 0, 0)) == NULL) {
+            *errStatus = "unable to map MAT-file";
+            goto ERROR_EXIT;
+        }
+        mmf->size = (size_t) fileSize.QuadPart;
+    }
+#else
+    (void)file;
+    *errStatus = "memory mapped MAT-files are not supported";
+    goto ERROR_EXIT;
+#endif
+
+    if (mmf->size < MATMAP_HEADER_SIZE) {
+        *errStatus = "not a MAT-file";
+        goto ERROR_EXIT;
+    }
+    (void)memcpy(&version, mmf->base + 124, sizeof(version));
+    (void)memcpy(&endian, mmf->base + 126, sizeof(endian));
+    if (endian != (uint16_T) (('M' << 8) | 'I')) {
+        *errStatus = "MAT-file written with another byte order";
+        goto ERROR_EXIT;
+    }
+    if (version != 0x0100) {
+        *errStatus = "unsupported MAT-file version";
+        goto ERROR_EXIT;
+    }
+    mmf->next = mmf->base + MATMAP_HEADER_SIZE;
+    return(mmf);
+
+  ERROR_EXIT:
+    rt_MatMapClose(mmf);
+    return(NULL);
+
+} /* end rt_MatMapOpen */
+
+
+/* Function: rt_MatMapClose ====================================================
+ * Abstract:
+ *      Unmap the file. The arrays returned for it are no longer valid.
+ */
+void rt_MatMapClose(RTMatMapFile *mmf)
+{
+    if (mmf == NULL) return;
+
+#if defined(MATMAP_POSIX_MMAP)
+    if (mmf->base != NULL) (void)munmap((void*) mmf->base, mmf->size);
+#elif defined(MATMAP_WIN32_MMAP)
+    if (mmf->base != NULL) (void)UnmapViewOfFile(mmf->base);
+    if (mmf->mapping != NULL) (void)CloseHandle(mmf->mapping);
+    if (mmf->file != NULL) (void)CloseHandle(mmf->file);
+#endif
+    free(mmf);
+
+} /* end rt_MatMapClose */
+
+
+/* Function: rt_MatMapRewind ===================================================
+ * Abstract:
+ *      Make rt_MatMapNextVariable start again with the first variable.
+ */
+void rt_MatMapRewind(RTMatMapFile *mmf)
+{
+    mmf->next = mmf->base + MATMAP_HEADER_SIZE;
+
+} /* end rt_MatMapRewind */
+
+
+/* Function: rt_MatMapNextVariable =============================================
+ * Abstract:
+ *      Get the next variable of the file, like matGetNextVariable. Only the
+ *      element headers are read. Return 1 if a variable was found, 0 at the
+ *      end of the file and -1 if the next variable cannot be used from the
+ *      mapping (see rt_MatMapParseArray).
+ */
+int rt_MatMapNextVariable(RTMatMapFile *mmf, RTMatMapArray *arr)
+{
+    const char *end = mmf->base + mmf->size;
+    const char *next;
+    int        status;
+
+    if (end - mmf->next < 8) return(0);
+    status = rt_MatMapParseArray(mmf->next, end, arr, &next);
+    if (status > 0) mmf->next = next;
+    return(status);
+
+} /* end rt_MatMapNextVariable */
+
+
+/* Function: rt_MatMapGetField =================================================
+ * Abstract:
+ *      Get a field of element idx of a struct array, like mxGetField. Return
+ *      1 if the field was found, 0 if arr is not a struct, idx is out of
+ *      range or there is no such field, and -1 if the field cannot be used
+ *      from the mapping.
+ */
+int rt_MatMapGetField(const RTMatMapArray *arr,
+                      size_t              idx,
+                      const char          *fieldName,
+                      RTMatMapArray       *field)
+{
+    const char *p;
+    size_t     len = strlen(fieldName);
+    size_t     i, n;
+    int        f;
+
+    if (arr->classID != MATMAP_STRUCT || idx >= arr->nEls ||
+        len >= (size_t) arr->fieldNameLen) {
+        return(0);
+    }
+    for (f = 0; f < arr->nFields; f++) {
+        const char *name = arr->fieldNames + (size_t) f * arr->fieldNameLen;
+
+        if (strncmp(name, fieldName, len) == 0 && name[len] == '\0') break;
+    }
+    if (f == arr->nFields) return(0);
+
+    /* the fields of each element follow each other, element by element */
+    p = arr->elements;
+    n = idx * (size_t) arr->nFields + (size_t) f;
+    for (i = 0; i < n; i++) {
+        uint32_T   type;
+        size_t     nBytes;
+        const char *data;
+
+        if (!rt_MatMapGetTag(p, arr->end, &type, &nBytes, &data, &p) ||
+            type != miMATRIX) {
+            return(-1);
+        }
+    }
+    return(rt_MatMapParseArray(p, arr->end, field, &p));
+
+} /* end rt_MatMapGetField */
+
+
+/* Function: rt_MatMapGetCell ==================================================
+ * Abstract:
+ *      Get element idx of a cell array, like mxGetCell. Return values as for
+ *      rt_MatMapGetField.
+ */
+int rt_MatMapGetCell(const RTMatMapArray *arr,
+                     size_t              idx,
+                     RTMatMapArray       *cell)
+{
+    const char *p = arr->elements;
+    size_t     i;
+
+    if (arr->classID != MATMAP_CELL || idx >= arr->nEls) return(0);
+    for (i = 0; i < idx; i++) {
+        uint32_T   type;
+        size_t     nBytes;
+        const char *data;
+
+        if (!rt_MatMapGetTag(p, arr->end, &type, &nBytes, &data, &p) ||
+            type != miMATRIX) {
+            return(-1);
+        }
+    }
+    return(rt_MatMapParseArray(p, arr->end, cell, &p));
+
+} /* end rt_MatMapGetCell */
+
+
+/* Function: rt_MatMapGetScalar ================================================
+ * Abstract:
+ *      Return element idx of the real part of a numeric array as a double,
+ *      whatever the type it is stored with. idx must be less than nEls.
+ */
+double rt_MatMapGetScalar(const RTMatMapArray *arr, size_t idx)
+{
+    const char *p = arr->reData + idx * rt_MatMapTypeSize(arr->reType);
+
+    switch (arr->reType) {
+      case miINT8:   { int8_T   v; (void)memcpy(&v, p, 1); return((double) v); }
+      case miUINT8:  { uint8_T  v; (void)memcpy(&v, p, 1); return((double) v); }
+      case miINT16:  { int16_T  v; (void)memcpy(&v, p, 2); return((double) v); }
+      case miUINT16: { uint16_T v; (void)memcpy(&v, p, 2); return((double) v); }
+      case miINT32:  { int32_T  v; (void)memcpy(&v, p, 4); return((double) v); }
+      case miUINT32: { uint32_T v; (void)memcpy(&v, p, 4); return((double) v); }
+      case miSINGLE: { real32_T v; (void)memcpy(&v, p, 4); return((double) v); }
+      case miDOUBLE: { real64_T v; (void)memcpy(&v, p, 8); return((double) v); }
+      case miINT64:  { int64_T  v; (void)memcpy(&v, p, 8); return((double) v); }
+      case miUINT64: { uint64_T v; (void)memcpy(&v, p, 8); return((double) v); }
+      default:       return(0.0);
+    }
+
+} /* end rt_MatMapGetScalar */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+/* EOF rt_matmap.c */
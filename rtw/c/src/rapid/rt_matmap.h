@@ -0,0 +1,101 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_matmap.h
+ *
+ * Abstract:
+ *   Read-only access to the variables of a level 5 MAT-file through a memory
+ *   mapping of the file (rt_matmap.c). Used by the rapid simulation target
+ *   to load inport, From File and parameter data without reading the whole
+ *   file into mxArrays first (common_utils.c, rsim_utils.c).
+ *
+ *   From File data is not used in place: the From File blocks read a copy
+ *   that holds the points of each signal one after the other
+ *   (FrFInfo.tuDataMatrix), so rt_RapidReadFromFileBlockMatFile still copies
+ *   and transposes the whole matrix. The mapping only saves the mxArray.
+ *
+ *   The variables are found by walking the element headers of the file, and
+ *   the data of an array is returned as a pointer into the mapping, so only
+ *   the pages that are used are read from disk. The pointers stay valid
+ *   until rt_MatMapClose.
+ *
+ *   The file must not be changed while it is mapped. The mapping is private,
+ *   but on POSIX systems pages that were not read yet may still show later
+ *   changes to the file, and reading past the end of a truncated file
+ *   raises SIGBUS. The inport MAT-file stays mapped for the whole run, so it
+ *   must be left alone until the simulation ends.
+ *
+ *   Only uncompressed files written in the byte order of this machine can be
+ *   mapped (save -v6, or MAT-files written by Simulink Coder targets). The
+ *   data of a numeric array is only returned if it is stored with the type
+ *   of its class; MATLAB stores e.g. integer valued doubles as int8, in
+ *   which case re is NULL and the elements can only be read one by one with
+ *   rt_MatMapGetScalar. Callers fall back to matOpen for anything that
+ *   cannot be mapped.
+ */
+
+#ifndef rt_matmap_h
+#define rt_matmap_h
+
+#include <stddef.h>                     /* size_t */
+#include "tmwtypes.h"
+
+typedef struct RTMatMapFile_Tag RTMatMapFile;
+
+typedef struct RTMatMapArray_Tag {
+    int            classID;             /* mxClassID of the array, a logical
+                                           array has mxLOGICAL_CLASS          */
+    int            isComplex;
+    int            nDims;
+    const int32_T  *dims;               /* nDims dimensions                   */
+    const char     *name;               /* nameLen chars, not 0 terminated    */
+    size_t         nameLen;
+    size_t         nEls;                /* product of the dimensions          */
+    size_t         elSize;              /* bytes per element of re and im     */
+
+    /* numeric, logical and char arrays */
+    const void     *re;                 /* NULL if not stored with the type
+                                           of the class                       */
+    const void     *im;                 /* NULL if real or not stored with the
+                                           type of the class                  */
+    int            reType;              /* miINT8, ..., miDOUBLE as stored    */
+    const char     *reData;
+    size_t         reBytes;
+
+    /* struct and cell arrays */
+    int            nFields;
+    int            fieldNameLen;
+    const char     *fieldNames;         /* nFields names of fieldNameLen
+                                           chars, 0 padded                    */
+    const char     *elements;           /* first miMATRIX of the contents     */
+    const char     *end;                /* end of the array in the mapping    */
+} RTMatMapArray;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern RTMatMapFile *rt_MatMapOpen(const char *file, const char **errStatus);
+
+extern void rt_MatMapClose(RTMatMapFile *mmf);
+
+extern void rt_MatMapRewind(RTMatMapFile *mmf);
+
+extern int rt_MatMapNextVariable(RTMatMapFile *mmf, RTMatMapArray *arr);
+
+extern int rt_MatMapGetField(const RTMatMapArray *arr,
+                             size_t              idx,
+                             const char          *fieldName,
+                             RTMatMapArray       *field);
+
+extern int rt_MatMapGetCell(const RTMatMapArray *arr,
+                            size_t              idx,
+                            RTMatMapArray       *cell);
+
+extern double rt_MatMapGetScalar(const RTMatMapArray *arr, size_t idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* rt_matmap_h */
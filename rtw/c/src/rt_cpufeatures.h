@@ -0,0 +1,113 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_cpufeatures.h
+ *
+ * Abstract:
+ *   Run-time instruction set detection shared by the kernels that are
+ *   compiled for several x86 ISA levels (matrix library, ODE stage
+ *   updates). Callers resolve a function pointer per kernel once, from
+ *   the ISA level returned by rt_CpuSelectIsa.
+ *
+ *   The detected level can be lowered for reproducibility testing by
+ *   setting the environment variable RT_CPU_ISA to one of "generic",
+ *   "sse4.2", "avx2" or "avx512", or by compiling with RT_CPU_ISA_MAX set
+ *   to one of the RT_ISA_* levels. A request above what the processor
+ *   supports is clamped to the detected level.
+ *
+ *   Multiversioned kernels are only built with GCC or Clang on x86; every
+ *   other toolchain (or RT_NO_CPU_DISPATCH) gets the generic level.
+ */
+
+#ifndef rt_cpufeatures_h
+#define rt_cpufeatures_h
+
+#include <stdlib.h>   /* needed for getenv */
+#include <string.h>   /* needed for strcmp */
+
+#define RT_ISA_GENERIC  0
+#define RT_ISA_SSE42    1
+#define RT_ISA_AVX2     2
+#define RT_ISA_AVX512   3
+
+#if !defined(RT_NO_CPU_DISPATCH) && \
+    (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+# define RT_CPU_DISPATCH 1
+#else
+# define RT_CPU_DISPATCH 0
+#endif
+
+/* Each level only changes the instruction set; the optimization level is
+ * the one the kernels are compiled with.
+ */
+#define RT_TARGET_GENERIC
+
+#if RT_CPU_DISPATCH
+# define RT_TARGET_SSE42  __attribute__((target("sse4.2")))
+# define RT_TARGET_AVX2   __attribute__((target("avx2,fma")))
+# define RT_TARGET_AVX512 __attribute__((target("avx512f,avx512vl,fma")))
+#endif
+
+#if defined(__GNUC__)
+# define RT_CPU_UNUSED    __attribute__((unused))
+#else
+# define RT_CPU_UNUSED
+#endif
+
+#ifndef RT_CPU_ISA_MAX
+# define RT_CPU_ISA_MAX RT_ISA_AVX512
+#endif
+
+/* Function: rt_CpuDetectIsa ===================================================
+ * Abstract:
+ *   Return the widest RT_ISA_* level the processor supports.
+ */
+static RT_CPU_UNUSED int rt_CpuDetectIsa(void)
+{
+    int isa = RT_ISA_GENERIC;
+#if RT_CPU_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        isa = RT_ISA_SSE42;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            isa = RT_ISA_AVX2;
+            if (__builtin_cpu_supports("avx512f") &&
+                __builtin_cpu_supports("avx512vl")) {
+                isa = RT_ISA_AVX512;
+            }
+        }
+    }
+#endif
+    return isa;
+}
+
+/* Function: rt_CpuSelectIsa ===================================================
+ * Abstract:
+ *   Return the RT_ISA_* level kernels should be resolved for: the
+ *   detected level, lowered by RT_CPU_ISA_MAX, by the RT_CPU_ISA
+ *   environment variable and by request (pass a negative request for no
+ *   preference).
+ */
+static RT_CPU_UNUSED int rt_CpuSelectIsa(int request)
+{
+    int         isa   = rt_CpuDetectIsa();
+    const char *force = getenv("RT_CPU_ISA");
+
+    if (isa > RT_CPU_ISA_MAX) isa = RT_CPU_ISA_MAX;
+
+    if (force != NULL) {
+        int f = -1;
+        if (strcmp(force, "generic") == 0) f = RT_ISA_GENERIC;
+        else if (strcmp(force, "sse4.2") == 0) f = RT_ISA_SSE42;
+        else if (strcmp(force, "avx2") == 0) f = RT_ISA_AVX2;
+        else if (strcmp(force, "avx512") == 0) f = RT_ISA_AVX512;
+        if (f >= 0 && f < isa) isa = f;
+    }
+
+    if (request >= 0 && request < isa) isa = request;
+
+    return isa;
+}
+
+#endif /* rt_cpufeatures_h */
@@ -0,0 +1,604 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_logcolumnar.c
+ *
+ * Abstract:
+ *   Reader of the columnar log files written by rt_StopDataLoggingColumnar
+ *   (see rt_logcolumnar.h), for post-processing tools.
+ *
+ *   The file is memory mapped and only its index is checked when it is
+ *   opened. rt_LogColGetWindow and rt_LogColGetRows return views that point
+ *   into the mapping, so only the pages of the chunks that are looked at are
+ *   read from disk. The views stay valid until rt_LogColClose.
+ *
+ *   Encoded chunk parts (rt_logcolumnar_codec.h) are decoded into memory
+ *   owned by the LogColFile the first time they are viewed, and kept until
+ *   rt_LogColClose. The view functions therefore modify the LogColFile and
+ *   must not be called on the same LogColFile from more than one thread at
+ *   a time; threads that read a file concurrently each open it themselves.
+ *
+ *   POSIX systems use mmap and Windows MapViewOfFile. With RT_LOGCOL_NO_MMAP
+ *   the whole file is read into memory instead.
+ */
+
+#if !defined(_WIN32) && !defined(RT_LOGCOL_NO_MMAP)
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# define LOGCOL_POSIX_MMAP
+# include <sys/types.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#elif defined(_WIN32) && !defined(RT_LOGCOL_NO_MMAP)
+# define LOGCOL_WIN32_MMAP
+# include <windows.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "rt_logcolumnar.h"
+#define LOGCOL_CODEC_DECODE
+#include "rt_logcolumnar_codec.h"
+
+struct LogColFile_Tag {
+    const char_T       *base;           /* contents of the file               */
+    size_t             size;
+    const LogColHeader *hdr;
+    const LogColSignal *signals;
+    const LogColChunk  *chunks;
+    const int32_T      *dims;
+    real_T             **decoded;       /* 3 parts per chunk, NULL until an
+                                           encoded part is first viewed       */
+#ifdef LOGCOL_WIN32_MMAP
+    HANDLE             file;
+    HANDLE             mapping;
+#endif
+};
+
+
+/* Function: rt_LogColGetOffset ================================================
+ * Abstract:
+ *      Convert a file offset of a block of nBytes to a position in the
+ *      mapping. Return 0 if the block is not inside the file.
+ */
+static int_T rt_LogColGetOffset(const LogColFile   *lcf,
+                                const LogColOffset *offset,
+                                size_t             nBytes,
+                                size_t             *pos)
+{
+    if (offset->hi != 0 && sizeof(size_t) <= sizeof(uint32_T)) return(0);
+    *pos = (((size_t) offset->hi << 16) << 16) | (size_t) offset->lo;
+    return(*pos <= lcf->size && nBytes <= lcf->size - *pos);
+
+} /* end rt_LogColGetOffset */
+
+
+/* Function: rt_LogColCheckIndex ===============================================
+ * Abstract:
+ *      Check that the signal descriptors and chunks of the index only refer
+ *      to data inside the file, so that the views need no further checks.
+ *      Return NULL or an error message.
+ */
+static const char_T *rt_LogColCheckIndex(const LogColFile *lcf)
+{
+    const LogColHeader *hdr = lcf->hdr;
+    uint32_T           i, k;
+
+    for (i = 0; i < hdr->nSignals; i++) {
+        const LogColSignal *sig    = &lcf->signals[i];
+        size_t             rowSize = (size_t) sig->nCols * sig->elSize;
+
+        if (memchr(sig->name, '\0', LOGCOL_NAME_LEN) == NULL ||
+            sig->elSize == 0 || sig->nCols < 0 || sig->nValDims < 0 ||
+            sig->nDims < 0 || sig->dims > hdr->nDims ||
+            (uint32_T) sig->nDims > hdr->nDims - sig->dims ||
+            sig->chunk0 > hdr->nChunks ||
+            sig->nChunks > hdr->nChunks - sig->chunk0 ||
+            (sig->nRows > 0 && sig->chunkRows == 0) ||
+            (sig->chunkRows > 0 && sig->nChunks !=
+             sig->nRows / sig->chunkRows + (sig->nRows % sig->chunkRows != 0))) {
+            return("invalid signal in the index");
+        }
+        if (sig->timeSignal >= 0) {
+            const LogColSignal *tSig;
+
+            if ((uint32_T) sig->timeSignal >= hdr->nSignals) {
+                return("invalid time signal in the index");
+            }
+            tSig = &lcf->signals[sig->timeSignal];
+            if (tSig->nRows != sig->nRows ||
+                tSig->chunkRows != sig->chunkRows || tSig->elSize !=
+                sizeof(real_T) || tSig->nCols != 1 || tSig->complex) {
+                return("invalid time signal in the index");
+            }
+        }
+        for (k = 0; k < sig->nChunks; k++) {
+            const LogColChunk *chunk = &lcf->chunks[sig->chunk0 + k];
+            size_t            size[3];
+            size_t            pos;
+            int_T             part;
+
+            size[0] = size[1] = rowSize * chunk->nRows;
+            size[2] = (size_t) sig->nValDims * sizeof(real_T) * chunk->nRows;
+            for (part = 0; part < 3; part++) {
+                if (chunk->encoded & (1U << part)) {
+                    size[part] = chunk->nBytes[part];
+                }
+            }
+            if (chunk->row0 != k * sig->chunkRows ||
+                chunk->nRows == 0 || chunk->nRows > sig->chunkRows ||
+                chunk->nRows > sig->nRows - chunk->row0 ||
+                (chunk->encoded & ~(LOGCOL_ENCODED_RE | LOGCOL_ENCODED_IM |
+                                    LOGCOL_ENCODED_VALDIMS)) != 0 ||
+                ((chunk->encoded & (LOGCOL_ENCODED_RE | LOGCOL_ENCODED_IM)) &&
+                 sig->elSize != sizeof(real_T)) ||
+                !rt_LogColGetOffset(lcf, &chunk->re, size[0], &pos) ||
+                (sig->complex &&
+                 !rt_LogColGetOffset(lcf, &chunk->im, size[1], &pos)) ||
+                (sig->nValDims > 0 &&
+                 !rt_LogColGetOffset(lcf, &chunk->valDims, size[2], &pos))) {
+                return("invalid chunk in the index");
+            }
+        }
+    }
+    return(NULL);
+
+} /* end rt_LogColCheckIndex */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Function: rt_LogColOpen =====================================================
+ * Abstract:
+ *      Map a columnar log file and check its index. Return NULL and set
+ *      errStatus on failure.
+ */
+LogColFile *rt_LogColOpen(const char_T *file, const char_T **errStatus)
+{
+    LogColFile         *lcf;
+    const LogColHeader *hdr;
+    size_t             pos;
+    size_t             nBytes;
+
+    if ((lcf = (LogColFile*) calloc(1, sizeof(LogColFile))) == NULL) {
+        *errStatus = "memory allocation error";
+        return(NULL);
+    }
+
+#if defined(LOGCOL_POSIX_MMAP)
+    {
+        struct stat st;
+        void        *base;
+        int         fd;
+
+        if ((fd = open(file, O_RDONLY)) < 0) {
+            *errStatus = "unable to open log file";
+            goto ERROR_EXIT;
+        }
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            (void)close(fd);
+            *errStatus = "unable to read log file";
+            goto ERROR_EXIT;
+        }
+        base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        (void)close(fd);
+        if (base == MAP_FAILED) {
+            *errStatus = "unable to map log file";
+            goto ERROR_EXIT;
+        }
+        lcf->base = (const char_T*) base;
+        lcf->size = (size_t) st.st_size;
+    }
+#elif defined(LOGCOL_WIN32_MMAP)
+    {
+        LARGE_INTEGER fileSize;
+
+        lcf->file = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (lcf->file == INVALID_HANDLE_VALUE) {
+            lcf->file  = NULL;
+            *errStatus = "unable to open log file";
+            goto ERROR_EXIT;
+        }
+        if (!GetFileSizeEx(lcf->file, &fileSize) || fileSize.QuadPart <= 0 ||
+            (lcf->mapping = CreateFileMappingA(lcf->file, NULL, PAGE_READONLY,
+                                               0, 0, NULL)) == NULL ||
+            (lcf->base = (const char_T*) MapViewOfFile(lcf->mapping,
+                                                       FILE_MAP_READ,
+                                                       0, 0, 0)) == NULL) {
+            *errStatus = "unable to map log file";
+            goto ERROR_EXIT;
+        }
+        lcf->size = (size_t) fileSize.QuadPart;
+    }
+#else
+    {
+        FILE   *fp;
+        long   size;
+        char_T *base = NULL;
+
+        if ((fp = fopen(file, "rb")) == NULL) {
+            *errStatus = "unable to open log file";
+            goto ERROR_EXIT;
+        }
+        if (fseek(fp, 0L, SEEK_END) != 0 || (size = ftell(fp)) <= 0 ||
+            fseek(fp, 0L, SEEK_SET) != 0 ||
+            (base = (char_T*) malloc((size_t) size)) == NULL ||
+            fread(base, 1, (size_t) size, fp) != (size_t) size) {
+            (void)fclose(fp);
+            if (base != NULL) free(base);
+            *errStatus = "unable to read log file";
+            goto ERROR_EXIT;
+        }
+        (void)fclose(fp);
+        lcf->base = base;
+        lcf->size = (size_t) size;
+    }
+#endif
+
+    /*****************************
+     * Header and index location *
+     *****************************/
+    hdr = lcf->hdr = (const LogColHeader*) lcf->base;
+    if (lcf->size < sizeof(LogColHeader) ||
+        memcmp(hdr->magic, LOGCOL_MAGIC, sizeof(hdr->magic)) != 0) {
+        *errStatus = "not a columnar log file";
+        goto ERROR_EXIT;
+    }
+    if (hdr->byteOrder != LOGCOL_BYTE_ORDER) {
+        *errStatus = "log file written with another byte order";
+        goto ERROR_EXIT;
+    }
+    if (hdr->version != LOGCOL_VERSION) {
+        *errStatus = "unsupported log file version";
+        goto ERROR_EXIT;
+    }
+    nBytes = (size_t) hdr->nSignals * sizeof(LogColSignal) +
+             (size_t) hdr->nChunks * sizeof(LogColChunk) +
+             (size_t) hdr->nDims * sizeof(int32_T);
+    if (!rt_LogColGetOffset(lcf, &hdr->indexOffset, nBytes, &pos) ||
+        pos % 8 != 0) {
+        *errStatus = "invalid log file index";
+        goto ERROR_EXIT;
+    }
+    lcf->signals = (const LogColSignal*) (lcf->base + pos);
+    lcf->chunks  = (const LogColChunk*) (lcf->signals + hdr->nSignals);
+    lcf->dims    = (const int32_T*) (lcf->chunks + hdr->nChunks);
+
+    if ((*errStatus = rt_LogColCheckIndex(lcf)) != NULL) goto ERROR_EXIT;
+    if ((lcf->decoded = (real_T**) calloc(3 * (size_t) hdr->nChunks + 1,
+                                          sizeof(real_T*))) == NULL) {
+        *errStatus = "memory allocation error";
+        goto ERROR_EXIT;
+    }
+    return(lcf);
+
+  ERROR_EXIT:
+    rt_LogColClose(lcf);
+    return(NULL);
+
+} /* end rt_LogColOpen */
+
+
+/* Function: rt_LogColClose ====================================================
+ * Abstract:
+ *      Unmap the file. The views returned for it are no longer valid.
+ */
+void rt_LogColClose(LogColFile *lcf)
+{
+    if (lcf == NULL) return;
+
+    if (lcf->decoded != NULL) {
+        size_t i;
+
+        for (i = 0; i < 3 * (size_t) lcf->hdr->nChunks; i++) {
+            if (lcf->decoded[i] != NULL) free(lcf->decoded[i]);
+        }
+        free(lcf->decoded);
+    }
+
+#if defined(LOGCOL_POSIX_MMAP)
+    if (lcf->base != NULL) (void)munmap((void*) lcf->base, lcf->size);
+#elif defined(LOGCOL_WIN32_MMAP)
+    if (lcf->base != NULL) (void)UnmapViewOfFile(lcf->base);
+    if (lcf->mapping != NULL) (void)CloseHandle(lcf->mapping);
+    if (lcf->file != NULL) (void)CloseHandle(lcf->file);
+#else
+    if (lcf->base != NULL) free((void*) lcf->base);
+#endif
+    free(lcf);
+
+} /* end rt_LogColClose */
+
+
+/* Function: rt_LogColNumSignals ===============================================
+ * Abstract:
+ *      Return the number of signals in the file.
+ */
+int_T rt_LogColNumSignals(const LogColFile *lcf)
+{
+    return((int_T) lcf->hdr->nSignals);
+
+} /* end rt_LogColNumSignals */
+
+
+/* Function: rt_LogColGetSignal ================================================
+ * Abstract:
+ *      Return the descriptor of a signal, NULL if sigIdx is out of range.
+ */
+const LogColSignal *rt_LogColGetSignal(const LogColFile *lcf, int_T sigIdx)
+{
+    if (sigIdx < 0 || (uint32_T) sigIdx >= lcf->hdr->nSignals) return(NULL);
+    return(&lcf->signals[sigIdx]);
+
+} /* end rt_LogColGetSignal */
+
+
+/* Function: rt_LogColGetDims ==================================================
+ * Abstract:
+ *      Return the sig->nDims dimensions of a row of a signal.
+ */
+const int32_T *rt_LogColGetDims(const LogColFile   *lcf,
+                                const LogColSignal *sig)
+{
+    return(lcf->dims + sig->dims);
+
+} /* end rt_LogColGetDims */
+
+
+/* Function: rt_LogColFindSignal ===============================================
+ * Abstract:
+ *      Return the index of the signal with the given name, -1 if there is
+ *      none.
+ */
+int_T rt_LogColFindSignal(const LogColFile *lcf, const char_T *name)
+{
+    uint32_T i;
+
+    for (i = 0; i < lcf->hdr->nSignals; i++) {
+        if (strcmp(lcf->signals[i].name, name) == 0) return((int_T) i);
+    }
+    return(-1);
+
+} /* end rt_LogColFindSignal */
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/* Function: rt_LogColGetPart ==================================================
+ * Abstract:
+ *      Return the data of part 0 (real), 1 (imaginary) or 2 (valueDimensions)
+ *      of chunk k of a signal, decoding it on first use if it is encoded.
+ *      Return NULL if it cannot be decoded.
+ */
+static const char_T *rt_LogColGetPart(LogColFile         *lcf,
+                                      const LogColSignal *sig,
+                                      uint32_T           k,
+                                      int_T              part)
+{
+    uint32_T           chunkIdx = sig->chunk0 + k;
+    const LogColChunk  *chunk   = &lcf->chunks[chunkIdx];
+    const LogColOffset *offset  = (part == 0) ? &chunk->re :
+                                  (part == 1) ? &chunk->im : &chunk->valDims;
+    real_T             **cache  = &lcf->decoded[3 * (size_t) chunkIdx + part];
+    int_T              nCols    = (part < 2) ? sig->nCols : sig->nValDims;
+    size_t             pos;
+
+    (void)rt_LogColGetOffset(lcf, offset, 0, &pos);
+    if (!(chunk->encoded & (1U << part))) {
+        return(lcf->base + pos);
+    }
+    if (*cache == NULL) {
+        real_T *data = (real_T*) malloc((size_t) nCols * chunk->nRows *
+                                        sizeof(real_T) + 1);
+        int_T  isTime = (part == 0 &&
+                         sig->timeSignal == (int32_T) (sig - lcf->signals));
+
+        if (data == NULL) return(NULL);
+        if (rt_LogColDecode((const uint8_T*) (lcf->base + pos),
+                            chunk->nBytes[part], chunk->nRows, nCols, isTime,
+                            data) != 0) {
+            free(data);
+            return(NULL);
+        }
+        *cache = data;
+    }
+    return((const char_T*) *cache);
+
+} /* end rt_LogColGetPart */
+
+
+/* Function: rt_LogColSetView ==================================================
+ * Abstract:
+ *      Fill in the view of rows a to b-1 of chunk k of a signal. Return 0
+ *      upon success, 1 if an encoded part cannot be decoded.
+ */
+static int_T rt_LogColSetView(LogColFile         *lcf,
+                              const LogColSignal *sig,
+                              uint32_T           k,
+                              uint32_T           a,
+                              uint32_T           b,
+                              LogColView         *view)
+{
+    const LogColChunk *chunk = &lcf->chunks[sig->chunk0 + k];
+    uint32_T          skip   = a - chunk->row0;
+    const char_T      *data;
+
+    view->row0      = a;
+    view->nRows     = b - a;
+    view->colStride = chunk->nRows;
+
+    if ((data = rt_LogColGetPart(lcf, sig, k, 0)) == NULL) return(1);
+    view->re = data + (size_t) skip * sig->elSize;
+
+    view->im = NULL;
+    if (sig->complex) {
+        if ((data = rt_LogColGetPart(lcf, sig, k, 1)) == NULL) return(1);
+        view->im = data + (size_t) skip * sig->elSize;
+    }
+    view->valDims = NULL;
+    if (sig->nValDims > 0) {
+        if ((data = rt_LogColGetPart(lcf, sig, k, 2)) == NULL) return(1);
+        view->valDims = (const real_T*) data + skip;
+    }
+    view->time = NULL;
+    if (sig->timeSignal >= 0) {
+        const LogColSignal *tSig = &lcf->signals[sig->timeSignal];
+
+        if ((data = rt_LogColGetPart(lcf, tSig, k, 0)) == NULL) return(1);
+        view->time = (const real_T*) data + skip;
+    }
+    return(0);
+
+} /* end rt_LogColSetView */
+
+
+/* Function: rt_LogColFindTime =================================================
+ * Abstract:
+ *      Return the number of the n times of t (sorted) that are less than
+ *      t0, or no more than t0 if after is set.
+ */
+static uint32_T rt_LogColFindTime(const real_T *t,
+                                  uint32_T     n,
+                                  real_T       t0,
+                                  int_T        after)
+{
+    uint32_T lo = 0;
+
+    while (n > 0) {
+        uint32_T half = n / 2;
+
+        if (t[lo + half] < t0 || (after && t[lo + half] == t0)) {
+            lo += half + 1;
+            n  -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return(lo);
+
+} /* end rt_LogColFindTime */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Function: rt_LogColGetRows ==================================================
+ * Abstract:
+ *      Return views of rows row0 to row0+nRows-1 of a signal, one per chunk.
+ *      At most maxViews views are filled in; the return value is the number
+ *      of views needed, or -1 if sigIdx is out of range or a chunk cannot be
+ *      decoded.
+ */
+int_T rt_LogColGetRows(LogColFile       *lcf,
+                       int_T            sigIdx,
+                       uint32_T         row0,
+                       uint32_T         nRows,
+                       LogColView       *views,
+                       int_T            maxViews)
+{
+    const LogColSignal *sig = rt_LogColGetSignal(lcf, sigIdx);
+    uint32_T           end;
+    uint32_T           k;
+    int_T              nViews = 0;
+
+    if (sig == NULL) return(-1);
+    if (row0 >= sig->nRows) return(0);
+    end = (nRows > sig->nRows - row0) ? sig->nRows : row0 + nRows;
+
+    for (k = row0 / sig->chunkRows; k < sig->nChunks; k++) {
+        const LogColChunk *chunk = &lcf->chunks[sig->chunk0 + k];
+        uint32_T          a      = (row0 > chunk->row0) ? row0 : chunk->row0;
+        uint32_T          b      = chunk->row0 + chunk->nRows;
+
+        if (a >= end) break;
+        if (b > end) b = end;
+        if (nViews < maxViews &&
+            rt_LogColSetView(lcf, sig, k, a, b, &views[nViews]) != 0) {
+            return(-1);
+        }
+        nViews++;
+    }
+    return(nViews);
+
+} /* end rt_LogColGetRows */
+
+
+/* Function: rt_LogColGetWindow ================================================
+ * Abstract:
+ *      Return views of the rows of a signal whose time t is in [t0, t1], one
+ *      per chunk. The chunk time ranges of the index are searched first, so
+ *      only the time vector of the chunks in the window is read.
+ *
+ *      At most maxViews views are filled in; the return value is the number
+ *      of views needed, or -1 if sigIdx is out of range, the signal has no
+ *      time or a chunk cannot be decoded.
+ */
+int_T rt_LogColGetWindow(LogColFile       *lcf,
+                         int_T            sigIdx,
+                         real_T           t0,
+                         real_T           t1,
+                         LogColView       *views,
+                         int_T            maxViews)
+{
+    const LogColSignal *sig = rt_LogColGetSignal(lcf, sigIdx);
+    const LogColChunk  *chunks;
+    uint32_T           lo     = 0;
+    uint32_T           n;
+    int_T              nViews = 0;
+
+    if (sig == NULL || sig->timeSignal < 0) return(-1);
+    chunks = lcf->chunks + sig->chunk0;
+
+    /* First chunk that ends at or after t0 */
+    n = sig->nChunks;
+    while (n > 0) {
+        uint32_T half = n / 2;
+
+        if (chunks[lo + half].tMax < t0) {
+            lo += half + 1;
+            n  -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+
+    for (; lo < sig->nChunks && chunks[lo].tMin <= t1; lo++) {
+        LogColView view;
+        uint32_T   a, b;
+
+        if (rt_LogColSetView(lcf, sig, lo, chunks[lo].row0,
+                             chunks[lo].row0 + chunks[lo].nRows,
+                             &view) != 0) {
+            return(-1);
+        }
+        a = rt_LogColFindTime(view.time, view.nRows, t0, 0);
+        b = rt_LogColFindTime(view.time, view.nRows, t1, 1);
+        if (a >= b) continue;
+
+        if (nViews < maxViews &&
+            rt_LogColSetView(lcf, sig, lo, view.row0 + a, view.row0 + b,
+                             &views[nViews]) != 0) {
+            return(-1);
+        }
+        nViews++;
+    }
+    return(nViews);
+
+} /* end rt_LogColGetWindow */
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_logcolumnar.h
+ *
+ * Abstract:
+ *   Columnar log file (model.rtl) written by rt_StopDataLoggingColumnar
+ *   (rt_logging.c, LOGGING_COLUMNAR) and the reader functions used by
+ *   post-processing tools (rt_logcolumnar.c).
+ *
+ *   The file holds the same variables as the MAT-file. Each signal is cut
+ *   into chunks of at most chunkRows rows; the rows of a chunk are stored
+ *   one column after the other, so a column of a chunk is contiguous. A
+ *   footer index lists the signals and the chunks of each signal together
+ *   with the time range of every chunk, so a time window can be found
+ *   without touching the data of the other chunks.
+ *
+ *     LogColHeader                      at offset 0
+ *     chunk data                        8-byte aligned blocks
+ *     LogColSignal   [nSignals]         at indexOffset
+ *     LogColChunk    [nChunks]
+ *     int32_T dims   [nDims of all signals]
+ *
+ *   The real_T parts of a chunk may be encoded (LOGGING_COLUMNAR_ENCODE, see
+ *   rt_logcolumnar_codec.h); the reader decodes them into the LogColFile
+ *   when they are first viewed, so a LogColFile is used by one thread at a
+ *   time.
+ *
+ *   All numbers are in the byte order of the machine that wrote the file.
+ *   The records only hold 4 and 8 byte fields in an order that needs no
+ *   padding, so the reader uses them in place.
+ */
+
+#ifndef rt_logcolumnar_h
+#define rt_logcolumnar_h
+
+#include <stddef.h>                     /* size_t */
+#include "rtwtypes.h"
+
+#define LOGCOL_MAGIC        "RTWLOGC1"
+#define LOGCOL_VERSION      2          /* 2: encoded chunks                   */
+#define LOGCOL_BYTE_ORDER   0x01020304U
+#define LOGCOL_NAME_LEN     128        /* "yout.signals(12).values", ...      */
+#define LOGCOL_ALIGN(n)     ( ( ((size_t)(n))+7 ) & (~((size_t)7)) )
+
+/* 64-bit file offset as two words, rtwtypes does not always have int64_T */
+typedef struct LogColOffset_Tag {
+    uint32_T lo;
+    uint32_T hi;
+} LogColOffset;
+
+typedef struct LogColHeader_Tag {
+    char_T       magic[8];              /* LOGCOL_MAGIC, not 0 terminated     */
+    uint32_T     version;               /* LOGCOL_VERSION                     */
+    uint32_T     byteOrder;             /* LOGCOL_BYTE_ORDER as written       */
+    uint32_T     nSignals;
+    uint32_T     nChunks;               /* chunks of all signals              */
+    uint32_T     nDims;                 /* entries of the dims table          */
+    uint32_T     reserved;
+    LogColOffset indexOffset;           /* first LogColSignal                 */
+} LogColHeader;
+
+typedef struct LogColSignal_Tag {
+    char_T       name[LOGCOL_NAME_LEN]; /* "tout", "yout.signals(1).values" */
+    int32_T      timeSignal;            /* index of the signal holding the
+                                           time of each row; the index of the
+                                           signal itself for a time vector,
+                                           -1 if the rows have no time        */
+    uint32_T     mxID;                  /* mxClassID of the elements          */
+    uint32_T     elSize;                /* bytes per element                  */
+    uint32_T     complex;               /* chunks have an imaginary part      */
+    uint32_T     logical;
+    int32_T      nCols;                 /* elements per row                   */
+    int32_T      nDims;                 /* dimensions of one row, in MATLAB
+                                           order; see MatrixData.dims         */
+    uint32_T     dims;                  /* first entry in the dims table      */
+    int32_T      nValDims;              /* valueDimensions columns of a
+                                           variable-size signal, else 0       */
+    uint32_T     nRows;                 /* rows of the signal                 */
+    uint32_T     chunkRows;             /* rows of each chunk but the last    */
+    uint32_T     chunk0;                /* first chunk in the chunk table     */
+    uint32_T     nChunks;
+    uint32_T     reserved;
+} LogColSignal;
+
+#define LOGCOL_ENCODED_RE       1U
+#define LOGCOL_ENCODED_IM       2U
+#define LOGCOL_ENCODED_VALDIMS  4U
+
+typedef struct LogColChunk_Tag {
+    uint32_T     row0;                  /* first row of the chunk             */
+    uint32_T     nRows;
+    LogColOffset re;                    /* nCols columns of nRows elements    */
+    LogColOffset im;                    /* same, if complex                   */
+    LogColOffset valDims;               /* nValDims columns of nRows real_T   */
+    uint32_T     encoded;               /* LOGCOL_ENCODED_* of encoded parts  */
+    uint32_T     nBytes[3];             /* stored size of re, im and valDims  */
+    real_T       tMin;                  /* time of the first and last rows,  */
+    real_T       tMax;                  /* 0 if the signal has no time        */
+} LogColChunk;
+
+/*
+ * Rows of one chunk that fall inside a time window. The pointers address the
+ * mapped file, or the decoded copy of an encoded part. Element j of row r
+ * (0 <= r < nRows) is
+ *     ((const T *)re)[j*colStride + r]
+ * and likewise for im and valDims.
+ */
+typedef struct LogColView_Tag {
+    uint32_T     row0;                  /* signal row of the first view row   */
+    uint32_T     nRows;
+    uint32_T     colStride;             /* elements between columns           */
+    const void   *re;
+    const void   *im;                   /* NULL if the signal is real         */
+    const real_T *valDims;              /* NULL if the signal is fixed-size   */
+    const real_T *time;                 /* nRows times, NULL if no time       */
+} LogColView;
+
+typedef struct LogColFile_Tag LogColFile;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern LogColFile *rt_LogColOpen(const char_T *file, const char_T **errStatus);
+
+extern void rt_LogColClose(LogColFile *lcf);
+
+extern int_T rt_LogColNumSignals(const LogColFile *lcf);
+
+extern const LogColSignal *rt_LogColGetSignal(const LogColFile *lcf,
+                                              int_T            sigIdx);
+
+extern const int32_T *rt_LogColGetDims(const LogColFile   *lcf,
+                                       const LogColSignal *sig);
+
+extern int_T rt_LogColFindSignal(const LogColFile *lcf, const char_T *name);
+
+extern int_T rt_LogColGetRows(LogColFile       *lcf,
+                              int_T            sigIdx,
+                              uint32_T         row0,
+                              uint32_T         nRows,
+                              LogColView       *views,
+                              int_T            maxViews);
+
+extern int_T rt_LogColGetWindow(LogColFile       *lcf,
+                                int_T            sigIdx,
+                                real_T           t0,
+                                real_T           t1,
+                                LogColView       *views,
+                                int_T            maxViews);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* rt_logcolumnar_h */
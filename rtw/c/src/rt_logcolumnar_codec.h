@@ -0,0 +1,314 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_logcolumnar_codec.h
+ *
+ * Abstract:
+ *   Lossless encoding of the real_T columns of a columnar log file chunk
+ *   (rt_logcolumnar.h), shared by the writer in rt_logging.c and the reader
+ *   in rt_logcolumnar.c.
+ *
+ *   Each column is a bit stream, most significant bit first, that starts
+ *   with the 64 bits of its first value. The bit patterns of a time vector,
+ *   seen as 64-bit integers, grow by an almost constant step, so each next
+ *   value is stored as the difference of its step from the previous step
+ *   (delta-of-delta):
+ *       '0'                       same step
+ *       '10'   +  7 bits          two's complement difference
+ *       '110'  +  9 bits
+ *       '1110' + 12 bits
+ *       '1111' + 64 bits
+ *   Other values are stored as the XOR with the previous value, of which
+ *   only the bits between the leading and trailing zeros are kept:
+ *       '0'                       same value
+ *       '10'   + meaningful bits  inside the window of the previous value
+ *       '11'   + 5 bits leading zeros + 6 bits (length-1) + meaningful bits
+ *
+ *   Define LOGCOL_CODEC_ENCODE and/or LOGCOL_CODEC_DECODE before including
+ *   this file to get rt_LogColEncode and rt_LogColDecode.
+ */
+
+#ifndef rt_logcolumnar_codec_h
+#define rt_logcolumnar_codec_h
+
+#include <stddef.h>                     /* size_t */
+#include <string.h>                     /* memcpy */
+#include "rtwtypes.h"
+
+typedef struct LogColBitWriter_Tag {
+    uint8_T  *dst;
+    size_t   cap;
+    size_t   pos;                       /* bytes written to dst               */
+    uint64_T acc;                       /* bits not yet written, at most 39   */
+    int_T    nAcc;
+    int_T    overflow;                  /* the stream does not fit in cap     */
+} LogColBitWriter;
+
+typedef struct LogColBitReader_Tag {
+    const uint8_T *src;
+    size_t        nBytes;
+    size_t        pos;
+    uint64_T      acc;
+    int_T         nAcc;
+    int_T         overrun;              /* read past the end of the stream    */
+} LogColBitReader;
+
+
+#ifdef LOGCOL_CODEC_ENCODE
+
+/* Function: rt_LogColPutBits ==================================================
+ * Abstract:
+ *      Append the nBits (at most 64) low bits of v to the stream.
+ */
+static void rt_LogColPutBits(LogColBitWriter *w, uint64_T v, int_T nBits)
+{
+    if (nBits > 32) {
+        rt_LogColPutBits(w, v >> 32, nBits - 32);
+        nBits = 32;
+    }
+    w->acc   = (w->acc << nBits) | (v & ((((uint64_T) 1) << nBits) - 1));
+    w->nAcc += nBits;
+    while (w->nAcc >= 8) {
+        w->nAcc -= 8;
+        if (w->pos < w->cap) {
+            w->dst[w->pos++] = (uint8_T) (w->acc >> w->nAcc);
+        } else {
+            w->overflow = 1;
+        }
+    }
+
+} /* end rt_LogColPutBits */
+
+
+/* Function: rt_LogColLeadingZeros =============================================
+ * Abstract:
+ *      Number of leading zero bits of x, which is not 0.
+ */
+static int_T rt_LogColLeadingZeros(uint64_T x)
+{
+#if defined(__GNUC__)
+    return((int_T) __builtin_clzll(x));
+#else
+    int_T n = 0;
+
+    while (!(x & (((uint64_T) 1) << 63))) {
+        x <<= 1;
+        n++;
+    }
+    return(n);
+#endif
+
+} /* end rt_LogColLeadingZeros */
+
+
+/* Function: rt_LogColTrailingZeros ============================================
+ * Abstract:
+ *      Number of trailing zero bits of x, which is not 0.
+ */
+static int_T rt_LogColTrailingZeros(uint64_T x)
+{
+#if defined(__GNUC__)
+    return((int_T) __builtin_ctzll(x));
+#else
+    int_T n = 0;
+
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return(n);
+#endif
+
+} /* end rt_LogColTrailingZeros */
+
+
+/* Function: rt_LogColEncode ===================================================
+ * Abstract:
+ *      Encode nCols columns of nRows values (column j at src + j*nRows) into
+ *      at most cap bytes of dst, with delta-of-delta if isTime is set, else
+ *      with XOR. Return the number of bytes used, 0 if they do not fit.
+ */
+static size_t rt_LogColEncode(const real_T *src,
+                              uint32_T     nRows,
+                              int_T        nCols,
+                              int_T        isTime,
+                              uint8_T      *dst,
+                              size_t       cap)
+{
+    LogColBitWriter w;
+    int_T           j;
+    uint32_T        i;
+
+    (void)memset(&w, 0, sizeof(w));
+    w.dst = dst;
+    w.cap = cap;
+
+    for (j = 0; j < nCols && !w.overflow; j++) {
+        const real_T *col   = src + (size_t) j * nRows;
+        uint64_T     prev;
+        uint64_T     delta  = 0;
+        int_T        lead   = -1;       /* window of the previous XOR         */
+        int_T        trail  = 0;
+
+        if (nRows == 0) continue;
+        (void)memcpy(&prev, &col[0], sizeof(prev));
+        rt_LogColPutBits(&w, prev, 64);
+
+        for (i = 1; i < nRows; i++) {
+            uint64_T v;
+
+            (void)memcpy(&v, &col[i], sizeof(v));
+            if (isTime) {
+                uint64_T dod = (v - prev) - delta;  /* modulo 2^64 */
+
+                delta = v - prev;
+                if (dod == 0) {
+                    rt_LogColPutBits(&w, 0, 1);
+                } else if (dod + 64 < 128) {
+                    rt_LogColPutBits(&w, 2, 2);
+                    rt_LogColPutBits(&w, dod, 7);
+                } else if (dod + 256 < 512) {
+                    rt_LogColPutBits(&w, 6, 3);
+                    rt_LogColPutBits(&w, dod, 9);
+                } else if (dod + 2048 < 4096) {
+                    rt_LogColPutBits(&w, 14, 4);
+                    rt_LogColPutBits(&w, dod, 12);
+                } else {
+                    rt_LogColPutBits(&w, 15, 4);
+                    rt_LogColPutBits(&w, dod, 64);
+                }
+            } else {
+                uint64_T x = v ^ prev;
+
+                if (x == 0) {
+                    rt_LogColPutBits(&w, 0, 1);
+                } else {
+                    int_T l = rt_LogColLeadingZeros(x);
+                    int_T t = rt_LogColTrailingZeros(x);
+
+                    if (l > 31) l = 31;
+                    if (lead >= 0 && l >= lead && t >= trail) {
+                        rt_LogColPutBits(&w, 2, 2);
+                        rt_LogColPutBits(&w, x >> trail, 64 - lead - trail);
+                    } else {
+                        rt_LogColPutBits(&w, 3, 2);
+                        rt_LogColPutBits(&w, (uint64_T) l, 5);
+                        rt_LogColPutBits(&w, (uint64_T) (63 - l - t), 6);
+                        rt_LogColPutBits(&w, x >> t, 64 - l - t);
+                        lead  = l;
+                        trail = t;
+                    }
+                }
+            }
+            prev = v;
+        }
+    }
+    if (w.nAcc > 0) {
+        rt_LogColPutBits(&w, 0, 8 - w.nAcc);
+    }
+    return(w.overflow ? 0 : w.pos);
+
+} /* end rt_LogColEncode */
+
+#endif /* LOGCOL_CODEC_ENCODE */
+
+
+#ifdef LOGCOL_CODEC_DECODE
+
+/* Function: rt_LogColGetBits ==================================================
+ * Abstract:
+ *      Read the next nBits (at most 64) bits of the stream.
+ */
+static uint64_T rt_LogColGetBits(LogColBitReader *r, int_T nBits)
+{
+    uint64_T v = 0;
+
+    if (nBits > 32) {
+        v     = rt_LogColGetBits(r, nBits - 32) << 32;
+        nBits = 32;
+    }
+    while (r->nAcc < nBits) {
+        r->acc <<= 8;
+        if (r->pos < r->nBytes) {
+            r->acc |= r->src[r->pos++];
+        } else {
+            r->overrun = 1;
+        }
+        r->nAcc += 8;
+    }
+    r->nAcc -= nBits;
+    return(v | ((r->acc >> r->nAcc) & ((((uint64_T) 1) << nBits) - 1)));
+
+} /* end rt_LogColGetBits */
+
+
+/* Function: rt_LogColDecode ===================================================
+ * Abstract:
+ *      Decode the nBytes of src written by rt_LogColEncode into nCols
+ *      columns of nRows values. Return 0 upon success, 1 if the stream is
+ *      too short.
+ */
+static int_T rt_LogColDecode(const uint8_T *src,
+                             size_t        nBytes,
+                             uint32_T      nRows,
+                             int_T         nCols,
+                             int_T         isTime,
+                             real_T        *dst)
+{
+    LogColBitReader r;
+    int_T           j;
+    uint32_T        i;
+
+    (void)memset(&r, 0, sizeof(r));
+    r.src    = src;
+    r.nBytes = nBytes;
+
+    for (j = 0; j < nCols && !r.overrun; j++) {
+        real_T   *col  = dst + (size_t) j * nRows;
+        uint64_T prev;
+        uint64_T delta = 0;
+        int_T    lead  = 0;
+        int_T    trail = 0;
+
+        if (nRows == 0) continue;
+        prev = rt_LogColGetBits(&r, 64);
+        (void)memcpy(&col[0], &prev, sizeof(prev));
+
+        for (i = 1; i < nRows && !r.overrun; i++) {
+            if (isTime) {
+                uint64_T dod;
+
+                if (rt_LogColGetBits(&r, 1) == 0) {
+                    dod = 0;
+                } else if (rt_LogColGetBits(&r, 1) == 0) {
+                    dod = rt_LogColGetBits(&r, 7);
+                    if (dod & 64) dod -= 128;
+                } else if (rt_LogColGetBits(&r, 1) == 0) {
+                    dod = rt_LogColGetBits(&r, 9);
+                    if (dod & 256) dod -= 512;
+                } else if (rt_LogColGetBits(&r, 1) == 0) {
+                    dod = rt_LogColGetBits(&r, 12);
+                    if (dod & 2048) dod -= 4096;
+                } else {
+                    dod = rt_LogColGetBits(&r, 64);
+                }
+                delta += dod;
+                prev  += delta;
+            } else if (rt_LogColGetBits(&r, 1) != 0) {
+                if (rt_LogColGetBits(&r, 1) != 0) {
+                    lead  = (int_T) rt_LogColGetBits(&r, 5);
+                    trail = 63 - lead - (int_T) rt_LogColGetBits(&r, 6);
+                    if (trail < 0) return(1);
+                }
+                prev ^= rt_LogColGetBits(&r, 64 - lead - trail) << trail;
+            }
+            (void)memcpy(&col[i], &prev, sizeof(prev));
+        }
+    }
+    return(r.overrun);
+
+} /* end rt_LogColDecode */
+
+#endif /* LOGCOL_CODEC_DECODE */
+
+#endif /* rt_logcolumnar_codec_h */
@@ -18,6 +18,43 @@
  *
  */
 
+#if defined(LOGGING_THREAD) && !defined(_WIN32) && defined(__GNUC__)
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# define LOGGING_PTHREADS
+# include <pthread.h>
+#endif
+
+#if defined(LOGGING_STREAM) && !defined(_WIN32)
+# ifndef _POSIX_C_SOURCE
+#  define _POSIX_C_SOURCE 200112L       /* needed for fseeko              */
+# endif
+# ifndef _FILE_OFFSET_BITS
+#  define _FILE_OFFSET_BITS 64          /* spool files may exceed 2 GB    */
+# endif
+#endif
+
+#if defined(LOGGING_STATS)
+# if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#  define _POSIX_C_SOURCE 200112L
+# endif
+# include <time.h>    /* needed for clock_gettime */
+#endif
+
+#if defined(LOGGING_PTHREADS) || defined(LOGGING_TRIGGER)
+# define LOGGING_SNAPSHOTS                /* see LogSnapshot                  */
+#endif
+
+#if defined(LOGGING_MAT_PARALLEL) && defined(LOGGING_PTHREADS) && \
+    !defined(LOGGING_MAT_COMPRESS)
+# define LOGGING_MAT_WRITE_POOL           /* see rt_WriteMatFileParallel      */
+#endif
+
+#ifdef LOGGING_MAT_COMPRESS
+# include <zlib.h>
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -31,6 +68,13 @@
 #include "rt_logging.h"
 #include "rt_mxclassid.h"
 #include "rtw_matlogging.h"
+#ifdef LOGGING_COLUMNAR
+# include "rt_logcolumnar.h"
+# if !defined(LOGGING_COLUMNAR_ENCODE) || LOGGING_COLUMNAR_ENCODE
+#  define LOGCOL_CODEC_ENCODE
+#  include "rt_logcolumnar_codec.h"
+# endif
+#endif
 
 #ifndef TMW_NAME_LENGTH_MAX
 #define TMW_NAME_LENGTH_MAX 64
@@ -48,6 +92,7 @@
 #define matINT64                   12
 #define matUINT64                  13
 #define	matMATRIX                  14
+#define matCOMPRESSED              15
 
 #define matLOGICAL_BIT          0x200
 #define matCOMPLEX_BIT          0x800
@@ -63,6 +108,113 @@
 #define DEFAULT_BUFFER_SIZE      1024  /* used if maxRows=0 and Tfinal=0.0    */
 #endif
 
+#ifndef LOGGING_CHUNK_MAX_BYTES
+#define LOGGING_CHUNK_MAX_BYTES  (4*1024*1024)  /* largest rt_ReallocLogVar  *
+                                                 * chunk, in bytes            */
+#endif
+
+#ifndef LOGGING_STREAM_BLOCK_BYTES
+#define LOGGING_STREAM_BLOCK_BYTES  (1024*1024)  /* in-memory rows of a log  *
+                                                  * var with LOGGING_STREAM  */
+#endif
+
+#ifndef LOGGING_STREAM_MAX_BYTES
+#define LOGGING_STREAM_MAX_BYTES    0    /* rows kept in a spool file, in    *
+                                          * bytes; 0 keeps them all          */
+#endif
+
+#ifndef LOGGING_SPOOL_HEADER_ALIGN
+#define LOGGING_SPOOL_HEADER_ALIGN  512  /* spool file header is padded to  *
+                                          * a multiple of this many bytes    */
+#endif
+
+/*
+ * With LOGGING_THREAD (POSIX threads and a GCC compatible compiler, link with
+ * -lpthread), rt_UpdateTXXFYLogVars only copies the signals it logs into a
+ * slot of a single-producer/single-consumer ring; a logger thread started by
+ * rt_StartDataLogging does the rt_UpdateLogVar work. The logger thread sleeps
+ * on a condition variable while the ring is empty; the model thread wakes it
+ * once 1/LOGGING_RING_WAKE_DIV of the ring is in use, so that the logger
+ * thread works on batches of updates. When the ring is full the update is
+ * dropped, the model thread never waits; the number of dropped updates is
+ * saved as the variable droppedLogUpdates (with the log variable name
+ * modifier) in the MAT-file.
+ */
+#ifndef LOGGING_RING_SLOTS
+#define LOGGING_RING_SLOTS       1024  /* model steps the ring can hold       */
+#endif
+
+#ifndef LOGGING_RING_MAX_BYTES
+#define LOGGING_RING_MAX_BYTES   (16*1024*1024)  /* fewer slots if larger    */
+#endif
+
+#ifndef LOGGING_RING_WAKE_DIV
+#define LOGGING_RING_WAKE_DIV    4     /* wake the logger thread with this  *
+                                        * fraction (1/n) of the ring in use */
+#endif
+
+/*
+ * With LOGGING_TRIGGER, rt_SetLogTrigger restricts the T,X,Y variables to the
+ * updates around trigger events plus a decimated background. The trigger
+ * follows the external mode upload trigger (updown.c): a crossing of a level
+ * by a signal, or a predicate, fires it; the updates before the event are
+ * kept in a pre-trigger ring of snapshots until then.
+ */
+
+/*
+ * With LOGGING_MAT_COMPRESS (link with -lz), each variable is written to the
+ * MAT-file as a zlib compressed miCOMPRESSED element (see
+ * rt_WriteVarToMatFile).
+ */
+#ifndef LOGGING_MAT_COMPRESS_LEVEL
+#define LOGGING_MAT_COMPRESS_LEVEL 1     /* zlib level, 1 is the fastest      */
+#endif
+
+#ifndef LOGGING_MAT_COMPRESS_CHUNK
+#define LOGGING_MAT_COMPRESS_CHUNK (64*1024)  /* bytes deflated per call     */
+#endif
+
+/*
+ * With LOGGING_MAT_PARALLEL and LOGGING_THREAD, rt_StopDataLogging fixes up
+ * the variables and writes them to the MAT-file on a pool of threads (see
+ * rt_WriteMatFileParallel). Not used with LOGGING_MAT_COMPRESS, where the
+ * size of a variable in the file is only known once it is compressed.
+ */
+#ifndef LOGGING_MAT_WRITE_THREADS
+#define LOGGING_MAT_WRITE_THREADS  4     /* threads writing the MAT-file      */
+#endif
+
+/*
+ * With LOGGING_COLUMNAR, rt_StopDataLogging writes model.rtl, a columnar file
+ * with a time index (rt_logcolumnar.h), in place of model.mat.
+ */
+#ifndef LOGGING_COLUMNAR_CHUNK_ROWS
+#define LOGGING_COLUMNAR_CHUNK_ROWS 4096  /* rows per chunk of each signal    */
+#endif
+
+#ifndef LOGGING_COLUMNAR_ENCODE
+#define LOGGING_COLUMNAR_ENCODE     1     /* 0: store chunks as is, so that   *
+                                           * all views are zero-copy          */
+#endif
+
+/*
+ * With LOGGING_DOUBLES_AS_SINGLE, double signals are rounded to single
+ * (real32_T) as they are logged and saved as MATLAB single, which halves the
+ * memory they use (see rt_GetSingleConvertInfo). Time vectors and states
+ * stay double. Without it, one signal is logged as single by creating it
+ * with inpDataTypeID SS_SINGLE and an RTWLogDataTypeConvert from SS_DOUBLE
+ * to SS_SINGLE (rt_CreateLogVarWithConvert).
+ */
+
+/*
+ * With LOGGING_STATS, each log variable counts the samples it logged, the
+ * bytes they take, how often it grew and how often its circular buffer
+ * wrapped, and the time spent in rt_UpdateTXXFYLogVars and in
+ * rt_StopDataLoggingImpl is measured. The counts are returned by
+ * rt_GetLogVarStats and rt_GetLoggingStats, and printed as a table when
+ * logging stops (see rt_ReportLoggingStats).
+ */
+
 #define FREE(m) if (m != NULL) free(m)
 
 /* Logical definitions */
@@ -79,6 +231,48 @@
  * typedefs *
  *==========*/
 
+#ifdef LOGGING_PTHREADS
+typedef struct LogRing_Tag {
+    RTWLogInfo    *li;
+    char_T        *slots;              /* nSlots snapshots of slotBytes each  */
+    size_t        slotBytes;
+    unsigned long nSlots;
+    unsigned long head;                /* slots pushed, model thread writes   */
+    unsigned long tail;                /* slots logged, logger thread writes  */
+    int_T         stop;                /* set when logging stops              */
+    const char_T  *errMsg;             /* first error of the logger thread    */
+    unsigned long nDropped;            /* updates dropped with the ring full  */
+    unsigned long maxUsed;             /* most slots in use at a push         */
+    unsigned long wakeUsed;            /* slots in use that wake the logger   */
+    int_T         sleeping;            /* logger thread waits on wake         */
+    pthread_mutex_t lock;              /* guards the wait on wake             */
+    pthread_cond_t  wake;              /* signaled when head or stop change   */
+    pthread_t     thread;
+} LogRing;
+#endif
+
+/*
+ * Gather plan of the matrix format states (rt_LogTXYStates): the state
+ * segments as runs of bytes copied, or pre-processed, into consecutive
+ * places of a row. Segments that follow each other in memory are merged
+ * into one run, so that the states of a model usually take a few memcpy
+ * calls per row.
+ */
+typedef struct LogGatherRun_Tag {
+    int8_T                 *src;       /* first byte of the run               */
+    size_t                 nBytes;     /* bytes in the run                    */
+    size_t                 dstOffset;  /* offset of the run in the row        */
+    RTWPreprocessingFcnPtr preprocess; /* if not NULL, writes the run in
+                                          place of the memcpy                 */
+} LogGatherRun;
+
+typedef struct LogGatherPlan_Tag {
+    int_T        nRuns;
+    LogGatherRun *runs;
+    size_t       nBytes;               /* bytes in a row                      */
+    int_T        nEl;                  /* states in a row                     */
+} LogGatherPlan;
+
 typedef struct LogInfo_Tag {
     LogVar       *t;                   /* Time log variable                   */
     void         *x;                   /* State log variable                  */
@@ -90,21 +284,133 @@ typedef struct LogInfo_Tag {
     StructLogVar *structLogVarsList;   /* Linked list of all StructLogVars    */
 
     boolean_T   haveLogVars;           /* Are logging one or more vars?       */
+
+    LogGatherPlan *xPlan;              /* gather plan of the matrix format
+                                          states, built by the first update   */
+    boolean_T   xPlanFailed;           /* if it could not be built            */
+
+#ifdef LOGGING_PTHREADS
+    LogRing      *ring;                /* NULL if logging on the model thread */
+#endif
+#ifdef LOGGING_TRIGGER
+    struct LogTrigger_Tag *trigger;    /* NULL if logging every update        */
+#endif
+#ifdef LOGGING_STATS
+    unsigned long nUpdates;            /* rt_UpdateTXXFYLogVars calls         */
+    double        updateSeconds;       /* time spent in them                  */
+    double        maxUpdateSeconds;    /* longest of them                     */
+#endif
 } LogInfo;
 
+/*
+ * Copy of the signal data read by one rt_UpdateTXXFYLogVars call, as held in
+ * a slot of the logging ring (LOGGING_THREAD) or of the pre-trigger ring
+ * (LOGGING_TRIGGER). The slot is measured, filled by the model thread and
+ * replayed later, by the logger thread or when the trigger fires, by walking
+ * the log variables in the same order (rt_LogTXXFYVars). A slot starts with
+ * the LOG_UPDATE_* parts it holds.
+ */
+typedef enum {
+    LOG_SNAPSHOT_SIZE,
+    LOG_SNAPSHOT_CAPTURE,
+    LOG_SNAPSHOT_REPLAY
+} LogSnapshotMode;
+
+typedef struct LogSnapshot_Tag {
+    LogSnapshotMode mode;
+    char_T          *base;             /* the slot, NULL for LOG_SNAPSHOT_SIZE*/
+    size_t          offset;            /* bytes used so far                   */
+} LogSnapshot;
+
+#define LOG_SNAPSHOT_ALIGN(n)  ( ((n) + 7) & ~((size_t)7) )
+#define LOG_SNAPSHOT_HEADER    LOG_SNAPSHOT_ALIGN(sizeof(int_T))
+
+/* parts of the log updated by rt_LogTXXFYVars */
+#define LOG_UPDATE_TXY         1
+#define LOG_UPDATE_XFINAL      2
+
+#ifdef LOGGING_TRIGGER
+typedef enum {
+    TRIGGER_UNARMED,                   /* a one-shot trigger has fired        */
+    TRIGGER_HOLDING_OFF,
+    TRIGGER_ARMED,
+    TRIGGER_FIRED
+} LogTriggerState;
+
+typedef struct LogTrigger_Tag {
+    LogTriggerSpec  spec;
+    LogTriggerState state;
+    int_T           count;             /* updates left in the post-trigger
+                                          window or the hold off              */
+    unsigned long   nUpdates;          /* T,X,Y updates so far, to pick the
+                                          background ones                     */
+    real_T          *oldSigVals;       /* spec.signal at the previous update  */
+    boolean_T       haveOldSigVals;
+    char_T          *slots;            /* pre-trigger ring, spec.preTrigger
+                                          snapshots of slotBytes each         */
+    boolean_T       *isBackground;     /* log the slot when it is evicted     */
+    size_t          slotBytes;
+    int_T           head;              /* oldest slot                         */
+    int_T           nUsed;
+    unsigned long   nWindows;          /* times the trigger fired             */
+} LogTrigger;
+#endif
+
+#ifdef LOGGING_PTHREADS
+static void rt_StartLogRing(RTWLogInfo *li);
+#endif
+
 typedef struct MatItem_tag {
   int32_T    type;
   uint32_T    nbytes;
   const void *data;
 } MatItem;
 
+typedef struct MatFileWriter_tag {
+    FILE       *fp;
+#ifdef LOGGING_MAT_COMPRESS
+    FILE       *pending;       /* temporary file of the item to compress      */
+    int_T      status;         /* of the last item compressed                 */
+# ifdef LOGGING_PTHREADS
+    int_T      busy;           /* the worker is compressing pending           */
+    pthread_t  worker;
+# endif
+#endif
+} MatFileWriter;
+
 typedef enum {
     DATA_ITEM,
     MATRIX_ITEM,
     STRUCT_LOG_VAR_ITEM,
-    SIGNALS_STRUCT_ITEM
+    SIGNALS_STRUCT_ITEM,
+    LOG_VAR_ITEM,               /* MatrixData of a LogVar, data is the LogVar */
+    VALUE_DIMENSIONS_ITEM       /* valueDimensions of a LogVar, data is the
+                                 * LogVar                                     */
 } ItemDataKind;
 
+#ifdef LOGGING_MAT_WRITE_POOL
+/* a top level variable written by rt_WriteMatFileParallel */
+typedef struct MatWriteJob_Tag {
+    MatItem      item;
+    ItemDataKind itemKind;      /* LOG_VAR_ITEM or STRUCT_LOG_VAR_ITEM        */
+    const char_T *fixupMsg;     /* error of rt_FixupLogVar                    */
+    boolean_T    write;         /* the variable goes in the MAT-file          */
+    int_T        writeErr;
+    long         start;         /* offset of the element in the MAT-file      */
+    long         end;
+} MatWriteJob;
+
+typedef struct MatWritePool_Tag {
+    const char_T *file;
+    MatWriteJob  *jobs;
+    int_T        nJobs;
+    int_T        next;          /* next job to claim                          */
+    int_T        writing;       /* 0: fixing up the variables, 1: writing     */
+    int          verbose;
+    int_T        closeErr;      /* a stream of the workers failed to close    */
+} MatWritePool;
+#endif
+
 /*===========*
  * Constants *
  *===========*/
@@ -319,6 +625,34 @@ static RTWLogDataTypeConvert rt_GetDataTypeConvertInfo(
 } /* end rt_GetDataTypeConvertInfo */
 
 
+#ifdef LOGGING_DOUBLES_AS_SINGLE
+/* Function: rt_GetSingleConvertInfo ===========================================
+ * Abstract:
+ *      For a signal logged as double without conversion, set *pDTypeID to
+ *      SS_SINGLE and return the conversion from double to single, filled in
+ *      in *single. For other signals return pDataTypeConvertInfo.
+ */
+static const RTWLogDataTypeConvert *rt_GetSingleConvertInfo(
+    BuiltInDTypeId              *pDTypeID,
+    const RTWLogDataTypeConvert *pDataTypeConvertInfo,
+    RTWLogDataTypeConvert       *single)
+{
+    if (*pDTypeID != SS_DOUBLE || sizeof(real_T) == sizeof(real32_T) ||
+        (pDataTypeConvertInfo != NULL &&
+         pDataTypeConvertInfo->conversionNeeded)) {
+        return(pDataTypeConvertInfo);
+    }
+    *single = rt_GetDataTypeConvertInfo(NULL, SS_DOUBLE);
+    single->conversionNeeded    = 1;
+    single->dataTypeIdLoggingTo = SS_SINGLE;
+    single->numOfChunk          = 1;
+    *pDTypeID = SS_SINGLE;
+    return(single);
+
+} /* end rt_GetSingleConvertInfo */
+#endif
+
+
 /* Function: rt_GetDblValueFromOverSizedData ===================================
  * Abstract:
  */
@@ -599,12 +933,348 @@ static int_T rt_GetMatIdFromMxId(mxClassID mxID)
 } /* end rt_GetMatIdFromMxId */
 
 
+#ifdef LOGGING_STREAM
+
+/*
+ * Spool files of long runs grow past 2 GB, so they are addressed with 64-bit
+ * offsets where the C library has them rather than with fseek's long.
+ */
+#if defined(_WIN32)
+typedef __int64 SpoolOffset;
+# define rt_SeekSpool(fp, off)  _fseeki64((fp), (off), SEEK_SET)
+#elif defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L
+typedef off_t SpoolOffset;
+# define rt_SeekSpool(fp, off)  fseeko((fp), (off), SEEK_SET)
+#else
+typedef long SpoolOffset;
+# define rt_SeekSpool(fp, off)  fseek((fp), (off), SEEK_SET)
+#endif
+
+/* Function: rt_GetSpoolPartOffset =============================================
+ * Abstract:
+ *      The spool file of a LogVar starts with the text header written by
+ *      rt_WriteSpoolHeader, spoolHeaderBytes long, followed by blocks of rows.
+ *      Each block of the spool file of a LogVar holds spoolBlockRows rows of
+ *      the real part, then of the imaginary part (if complex), both laid out
+ *      as in data.re, then of valueDimensions (if variable-size), laid out
+ *      column-major as in valDims->dimsData. Return the offset of part
+ *      (0: real, 1: imaginary, 2: valueDimensions, 3: next block) within a
+ *      block.
+ */
+static SpoolOffset rt_GetSpoolPartOffset(const LogVar *var, int_T part)
+{
+    SpoolOffset rowBytes = (SpoolOffset)(var->data.nCols * var->data.elSize);
+    SpoolOffset nParts   = (part < 2) ? part : (var->data.complex ? 2 : 1);
+    SpoolOffset offset   = nParts * rowBytes * var->spoolBlockRows;
+
+    if (part == 3 && var->valDims != NULL && var->valDims->dimsData != NULL) {
+        offset += (SpoolOffset)(var->valDims->nCols * sizeof(real_T)) *
+                  var->spoolBlockRows;
+    }
+    return(offset);
+
+} /* end rt_GetSpoolPartOffset */
+
+
+/* Function: rt_GetSpoolBlockOffset ============================================
+ * Abstract:
+ *      Return the offset of block number block, counted from the oldest block
+ *      kept, in the spool file of a LogVar. With LOGGING_STREAM_MAX_BYTES the
+ *      file holds at most spoolMaxBlocks blocks and the newest one overwrites
+ *      the oldest, so the blocks form a ring starting at spoolFirstBlock.
+ */
+static SpoolOffset rt_GetSpoolBlockOffset(const LogVar *var, int_T block)
+{
+    int_T slot = block;
+
+    if (var->spoolMaxBlocks > 0) {
+        slot = (var->spoolFirstBlock % var->spoolMaxBlocks + block) %
+               var->spoolMaxBlocks;
+    }
+    return((SpoolOffset)var->spoolHeaderBytes +
+           slot * rt_GetSpoolPartOffset(var,3));
+
+} /* end rt_GetSpoolBlockOffset */
+
+
+/* Function: rt_WriteStreamedLogVar ============================================
+ * Abstract:
+ *      Write the data element (tag, data and padding) of part 0 (real), 1
+ *      (imaginary) or 2 (valueDimensions) of a log variable whose first
+ *      nSpooledRows rows are in its spool file and the rest in memory.
+ *
+ *      The spool file is read back one block at a time. Rows are written in
+ *      MATLAB (column-major) order: where rt_WriteLogVarPart transposes the
+ *      data, each column of a block is written at its final position in the
+ *      MAT-file, so memory use does not depend on the length of the run.
+ *
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_WriteStreamedLogVar(FILE          *fp,
+                                    const LogVar  *var,
+                                    int_T         part,
+                                    const MatItem *pItem)
+{
+    int_T  nRows     = var->nSpooledRows + var->rowIdx;
+    int_T  blockRows = var->spoolBlockRows;
+    int_T  rowMajor  = (part < 2);
+    int_T  nCols     = rowMajor ? var->data.nCols : var->valDims->nCols;
+    size_t elSize    = rowMajor ? var->data.elSize : sizeof(real_T);
+    int_T  transpose = !rowMajor || (var->data.nDims < 2 && nCols > 1);
+    long   start;
+    char_T *block    = NULL;
+    char_T *column   = NULL;
+    int_T  r0, n;
+    int_T  retStat   = 1;
+
+    if (fwrite(pItem, 1, matTAG_SIZE, fp) != matTAG_SIZE) return(1);
+    if ((start = ftell(fp)) < 0) return(1);
+
+    if ((block = malloc(blockRows*nCols*elSize)) == NULL ||
+        (column = malloc(blockRows*elSize)) == NULL) {
+        goto EXIT_POINT;
+    }
+
+    for (r0 = 0; r0 < nRows; r0 += n) {
+        const char_T *src;
+        int_T        stride;      /* rows between columns if column-major */
+        int_T        j;
+
+        if (r0 < var->nSpooledRows) {
+            n      = blockRows;
+            stride = blockRows;
+            if (rt_SeekSpool(var->spool,
+                             rt_GetSpoolBlockOffset(var, r0/blockRows) +
+                             rt_GetSpoolPartOffset(var,part)) != 0 ||
+                fread(block, elSize, n*nCols, var->spool) != (size_t)(n*nCols)) {
+                goto EXIT_POINT;
+            }
+            src = block;
+        } else {
+            n      = var->rowIdx;
+            stride = var->nBaseRows;
+            src    = (part == 0) ? (const char_T*) var->data.re :
+                     (part == 1) ? (const char_T*) var->data.im :
+                                   (const char_T*) var->valDims->dimsData;
+        }
+
+        if (!transpose) {
+            if (fseek(fp, start + (long)(r0*nCols*elSize), SEEK_SET) != 0 ||
+                fwrite(src, elSize, n*nCols, fp) != (size_t)(n*nCols)) {
+                goto EXIT_POINT;
+            }
+            continue;
+        }
+        for (j = 0; j < nCols; j++) {
+            const char_T *col;
+
+            if (rowMajor) {
+                int_T k;
+                for (k = 0; k < n; k++) {
+                    (void)memcpy(column + k*elSize,
+                                 src + (k*nCols + j)*elSize, elSize);
+                }
+                col = column;
+            } else {
+                col = src + j*stride*elSize;
+            }
+            if (fseek(fp, start + (long)((j*nRows + r0)*elSize),
+                      SEEK_SET) != 0 ||
+                fwrite(col, elSize, n, fp) != (size_t)n) {
+                goto EXIT_POINT;
+            }
+        }
+    }
+
+    /* Add offset for 8-byte alignment */
+    if (fseek(fp, start + (long)pItem->nbytes, SEEK_SET) == 0) {
+        int32_T nAlignBytes = matINT64_ALIGN(pItem->nbytes) - pItem->nbytes;
+        int     pad[2]      = {0, 0};
+
+        if (nAlignBytes == 0 ||
+            fwrite(pad,1,nAlignBytes,fp) == ((size_t) nAlignBytes)) {
+            retStat = 0;
+        }
+    }
+
+  EXIT_POINT:
+    FREE(block);
+    FREE(column);
+    return(retStat);
+
+} /* end rt_WriteStreamedLogVar */
+
+#endif /* LOGGING_STREAM */
+
+
 /* Forward declaration */
 static int_T rt_WriteItemToMatFile(FILE         *fp,
                                    MatItem      *pItem,
                                    ItemDataKind dataKind);
 
 
+/* Function: rt_LocateLogVarRow ================================================
+ * Abstract:
+ *      Find row `row' of a log variable counting from the oldest row logged,
+ *      i.e. past the write position of a circular buffer that wrapped. Copy
+ *      the buffer holding it, the initial buffer or a chunk added by
+ *      rt_ReallocLogVar, to *pBuf and return the index of the row in that
+ *      buffer. *pAvail is set to the number of rows of the buffer from this
+ *      row on, which are the next rows of the log variable too.
+ */
+static int_T rt_LocateLogVarRow(const LogVar *var,
+                                int_T        row,
+                                LogChunk     *pBuf,
+                                int_T        *pAvail)
+{
+    if (var->wrapped) {
+        row = (row + var->rowIdx) % var->data.nRows;
+    }
+
+    pBuf->row0     = 0;
+    pBuf->nRows    = var->nBaseRows;
+    pBuf->re       = var->data.re;
+    pBuf->im       = var->data.im;
+    pBuf->dimsData = (var->valDims != NULL) ? var->valDims->dimsData : NULL;
+    pBuf->next     = var->chunks;
+
+    while (row >= pBuf->row0 + pBuf->nRows && pBuf->next != NULL) {
+        *pBuf = *(pBuf->next);
+    }
+    *pAvail = pBuf->row0 + pBuf->nRows - row;
+    return(row - pBuf->row0);
+
+} /* end rt_LocateLogVarRow */
+
+
+/* Function: rt_PutLogVarBytes =================================================
+ * Abstract:
+ *      Append n bytes to the data element being written by
+ *      rt_WriteLogVarPart, i.e. to *pMem if it is not NULL, else to the file.
+ */
+static int_T rt_PutLogVarBytes(FILE       *fp,
+                               char_T     **pMem,
+                               const void *src,
+                               size_t     n)
+{
+    if (*pMem != NULL) {
+        (void)memcpy(*pMem, src, n);
+        *pMem += n;
+        return(0);
+    }
+    return(fwrite(src, 1, n, fp) != n);
+
+} /* end rt_PutLogVarBytes */
+
+
+/* Function: rt_WriteLogVarPart ================================================
+ * Abstract:
+ *      Write the data element (tag, data and padding) of part 0 (real), 1
+ *      (imaginary) or 2 (valueDimensions) of a log variable fixed up by
+ *      rt_FixupLogVar straight from the buffers it was logged to.
+ *
+ *      The rows are written from the oldest to the newest, so a circular
+ *      buffer that wrapped is unwrapped as it is written. Where MATLAB wants
+ *      the rows transposed (vector signals, and valueDimensions), one column
+ *      is written after the other: a column of valueDimensions is contiguous
+ *      in each buffer, the elements of a column of data.re/im are collected
+ *      a few thousand at a time in a buffer on the stack.
+ *
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_WriteLogVarPart(FILE          *fp,
+                                const LogVar  *var,
+                                int_T         part,
+                                const MatItem *pItem)
+{
+    int_T    rowMajor  = (part < 2);
+    int_T    nRows     = rowMajor ? var->data.nRows : var->valDims->nRows;
+    int_T    nCols     = rowMajor ? var->data.nCols : var->valDims->nCols;
+    size_t   elSize    = rowMajor ? var->data.elSize : sizeof(real_T);
+    size_t   rowBytes  = nCols * elSize;
+    int_T    transpose = !rowMajor || (var->data.nDims < 2 && nCols > 1);
+    real_T   small     = 0.0;           /* data of at most 4 bytes, which is
+                                           written in the tag                 */
+    char_T   *mem      = (pItem->nbytes <= 4) ? (char_T*) &small : NULL;
+    char_T   stage[8192];
+    size_t   nStaged   = 0;
+    LogChunk buf;
+    int_T    row, m, j, k;
+
+    if (mem == NULL && fwrite(pItem, 1, matTAG_SIZE, fp) != matTAG_SIZE) {
+        return(1);
+    }
+
+    if (!transpose) {
+        for (row = 0; row < nRows; row += m) {
+            int_T  idx = rt_LocateLogVarRow(var, row, &buf, &m);
+            char_T *re = (char_T*) (part ? buf.im : buf.re);
+
+            if (m <= 0) return(1);
+            if (m > nRows - row) m = nRows - row;
+            if (rt_PutLogVarBytes(fp, &mem, re + idx*rowBytes, m*rowBytes)) {
+                return(1);
+            }
+        }
+    } else {
+        for (j = 0; j < nCols; j++) {
+            for (row = 0; row < nRows; row += m) {
+                int_T        idx = rt_LocateLogVarRow(var, row, &buf, &m);
+                const char_T *src;
+
+                if (m <= 0) return(1);
+                if (m > nRows - row) m = nRows - row;
+                if (!rowMajor) {
+                    src = (const char_T*) (buf.dimsData +
+                                           (size_t)j*buf.nRows + idx);
+                    if (rt_PutLogVarBytes(fp, &mem, src, m*elSize)) return(1);
+                    continue;
+                }
+                src = (const char_T*) (part ? buf.im : buf.re) +
+                      idx*rowBytes + j*elSize;
+                for (k = 0; k < m; k++, src += rowBytes) {
+                    (void)memcpy(stage + nStaged, src, elSize);
+                    nStaged += elSize;
+                    if (nStaged + elSize > sizeof(stage)) {
+                        if (rt_PutLogVarBytes(fp, &mem, stage, nStaged)) {
+                            return(1);
+                        }
+                        nStaged = 0;
+                    }
+                }
+            }
+        }
+        if (nStaged > 0 && rt_PutLogVarBytes(fp, &mem, stage, nStaged)) {
+            return(1);
+        }
+    }
+
+    if (mem != NULL) {
+        MatItem item;
+
+        item.type   = pItem->type;
+        item.nbytes = pItem->nbytes;
+        item.data   = &small;
+        return(rt_WriteItemToMatFile(fp, &item, DATA_ITEM));
+    } else {
+        /* Add offset for 8-byte alignment */
+        int32_T nAlignBytes = matINT64_ALIGN(pItem->nbytes) - pItem->nbytes;
+        int     pad[2]      = {0, 0};
+
+        if (nAlignBytes > 0 &&
+            fwrite(pad,1,nAlignBytes,fp) != ((size_t) nAlignBytes)) {
+            return(1);
+        }
+    }
+    return(0);
+
+} /* end rt_WriteLogVarPart */
+
+
 /* Function: rt_ProcessMatItem =================================================
  * Abstract:
  *      This routine along with rt_WriteItemToMatFile() write out a specified
@@ -630,6 +1300,9 @@ static int_T rt_ProcessMatItem(FILE         *fp,
     const char_T *itemName;
     MatItem      item;
     int_T        retStat       = 0;
+    const MatrixData *matrix   = NULL;
+    const LogVar *logVar       = NULL;
+    MatrixData   valDimsData;
 
     switch (itemKind) {
       case DATA_ITEM: {
@@ -638,9 +1311,39 @@ static int_T rt_ProcessMatItem(FILE         *fp,
           retStat = -1;
           goto EXIT_POINT;
       }
+      case LOG_VAR_ITEM:
+      case VALUE_DIMENSIONS_ITEM:
       case MATRIX_ITEM: {
           const MatrixData *var = (const MatrixData *) pItem->data;
 
+          if (itemKind == LOG_VAR_ITEM) {
+              logVar = (const LogVar *) pItem->data;
+              var    = &(logVar->data);
+          } else if (itemKind == VALUE_DIMENSIONS_ITEM) {
+              /* 
+                 valueDimensions is written as a double matrix with
+                 nRows rows and one column per dimension.
+              */
+              logVar = (const LogVar *) pItem->data;
+              (void)memcpy(valDimsData.name, &VALUEDIMENSIONS_FIELD_NAME, mxMAXNAM);
+              valDimsData.nRows = logVar->valDims->nRows;
+              valDimsData.nCols = logVar->valDims->nCols;
+              valDimsData.nDims = 1;
+              valDimsData._dims[0] = logVar->valDims->nCols;
+              valDimsData.dims = valDimsData._dims;
+              valDimsData.re = logVar->valDims->dimsData;
+              valDimsData.im = NULL;
+              valDimsData.dTypeID = SS_DOUBLE;
+              valDimsData.elSize =  sizeof(real_T);
+              valDimsData.mxID = mxDOUBLE_CLASS;
+              valDimsData.logical = 0;
+              valDimsData.complex = 0;
+              valDimsData.frameData = 0;
+              valDimsData.frameSize = 1;
+              var = &valDimsData;
+          }
+          matrix         = var;
+
           mxID           = var->mxID;
           arrayFlags[0]  = mxID;
           arrayFlags[0] |= var->logical;
@@ -732,8 +1435,8 @@ static int_T rt_ProcessMatItem(FILE         *fp,
                         matTAG_SIZE : matINT64_ALIGN(matTAG_SIZE + item.nbytes);
     }
 
-    if (itemKind == MATRIX_ITEM) {
-        const MatrixData *var   = (const MatrixData*) pItem->data;
+    if (matrix != NULL) {
+        const MatrixData *var   = matrix;
         int_T            matID  = rt_GetMatIdFromMxId(mxID);
         size_t           elSize = var->elSize;
 
@@ -742,7 +1445,22 @@ static int_T rt_ProcessMatItem(FILE         *fp,
         if (cmd) {
             item.type = matID;
             item.data = var->re;
-            if (rt_WriteItemToMatFile(fp, &item, DATA_ITEM)) {
+            if (logVar != NULL) {
+                int_T part = (itemKind == VALUE_DIMENSIONS_ITEM) ? 2 : 0;
+
+#ifdef LOGGING_STREAM
+                if (logVar->nSpooledRows > 0) {
+                    if (rt_WriteStreamedLogVar(fp, logVar, part, &item)) {
+                        retStat = 1;
+                        goto EXIT_POINT;
+                    }
+                } else
+#endif
+                if (rt_WriteLogVarPart(fp, logVar, part, &item)) {
+                    retStat = 1;
+                    goto EXIT_POINT;
+                }
+            } else if (rt_WriteItemToMatFile(fp, &item, DATA_ITEM)) {
                 retStat = 1;
                 goto EXIT_POINT;
             }
@@ -756,7 +1474,20 @@ static int_T rt_ProcessMatItem(FILE         *fp,
             if (cmd) {
                 item.type = matID;
                 item.data = var->im;
-                if (rt_WriteItemToMatFile(fp, &item, DATA_ITEM)) {
+                if (logVar != NULL) {
+#ifdef LOGGING_STREAM
+                    if (logVar->nSpooledRows > 0) {
+                        if (rt_WriteStreamedLogVar(fp, logVar, 1, &item)) {
+                            retStat = 1;
+                            goto EXIT_POINT;
+                        }
+                    } else
+#endif
+                    if (rt_WriteLogVarPart(fp, logVar, 1, &item)) {
+                        retStat = 1;
+                        goto EXIT_POINT;
+                    }
+                } else if (rt_WriteItemToMatFile(fp, &item, DATA_ITEM)) {
                     retStat = 1;
                     goto EXIT_POINT;
                 }
@@ -823,21 +1554,19 @@ static int_T rt_ProcessMatItem(FILE         *fp,
 
               /* time */
               {
-                  const void *data = var->time;
-
-                  if (var->logTime) { /* time is a LogVar, get the MatrixData */
-                      data = &(((const LogVar*) (var->time))->data);
-                  }
+                  /* time is either a LogVar or a MatrixData */
+                  ItemDataKind timeKind = var->logTime ? LOG_VAR_ITEM :
+                                                         MATRIX_ITEM;
 
                   item.type = matMATRIX;
-                  item.data = data;
+                  item.data = var->time;
                   if (cmd) {
-                      if (rt_WriteItemToMatFile(fp,&item,MATRIX_ITEM)){
+                      if (rt_WriteItemToMatFile(fp,&item,timeKind)){
                           retStat = 1;
                           goto EXIT_POINT;
                       }
                   } else {
-                      if (rt_ProcessMatItem(fp, &item, MATRIX_ITEM,0)){
+                      if (rt_ProcessMatItem(fp, &item, timeKind,0)){
                           retStat = 1;
                           goto EXIT_POINT;
                       }
@@ -896,14 +1625,14 @@ static int_T rt_ProcessMatItem(FILE         *fp,
               for (i = 0; i < var->numSignals; i++) {
                   /* values */
                   item.type = matMATRIX;
-                  item.data = &(values->data);
+                  item.data = values;
                   if (cmd) {
-                      if (rt_WriteItemToMatFile(fp, &item,MATRIX_ITEM)) {
+                      if (rt_WriteItemToMatFile(fp, &item,LOG_VAR_ITEM)) {
                           retStat = 1;
                           goto EXIT_POINT;
                       }
                   } else {
-                      if (rt_ProcessMatItem(fp, &item, MATRIX_ITEM, 0)) {
+                      if (rt_ProcessMatItem(fp, &item, LOG_VAR_ITEM, 0)) {
                           retStat = 1;
                           goto EXIT_POINT;
                       }
@@ -913,37 +1642,18 @@ static int_T rt_ProcessMatItem(FILE         *fp,
                   if(logValueDimensions)
                   {
                       /* valueDimensions */
-                      /* Since the functions rt_WriteItemToMatFile and 
-                         rt_ProcessMatItem deal with MatrixData, 
-                         convert valDims to tempData, and fill up the
-                         necessary fields.
-                      */
-                      MatrixData  tempData;
-                      (void)memcpy(tempData.name, &VALUEDIMENSIONS_FIELD_NAME, mxMAXNAM);
-                      tempData.nRows = values->valDims->nRows;
-                      tempData.nCols = values->valDims->nCols;
-                      tempData.nDims = 1;
-                      tempData._dims[0] = values->valDims->nCols;
-                      tempData.re = values->valDims->dimsData;
-                      tempData.im = NULL;
-                      tempData.dTypeID = SS_DOUBLE;
-                      tempData.elSize =  sizeof(real_T);
-                      tempData.mxID = mxDOUBLE_CLASS;
-                      tempData.logical = 0;
-                      tempData.complex = 0;
-                      tempData.frameData = 0;
-                      tempData.frameSize = 1;
-
-                      item.type = matMATRIX;                    
-                      item.data = &tempData; /*values->valDims;*/
+                      item.type = matMATRIX;
+                      item.data = values;
 
                       if (cmd) {
-                          if (rt_WriteItemToMatFile(fp, &item,MATRIX_ITEM)) {
+                          if (rt_WriteItemToMatFile(fp, &item,
+                                                    VALUE_DIMENSIONS_ITEM)) {
                               retStat = 1;
                               goto EXIT_POINT;
                           }
                       } else {
-                          if (rt_ProcessMatItem(fp, &item, MATRIX_ITEM, 0)) {
+                          if (rt_ProcessMatItem(fp, &item,
+                                                VALUE_DIMENSIONS_ITEM, 0)) {
                               retStat = 1;
                               goto EXIT_POINT;
                           }
@@ -1186,213 +1896,398 @@ static int_T rt_WriteMat5FileHeader(FILE *fp)
 
 } /* end rt_WriteMat5FileHeader */
 
+#ifdef LOGGING_MAT_COMPRESS
 
-/* Function: rt_FixupLogVar ====================================================
+/* Function: rt_DeflateMatItem =================================================
  * Abstract:
- *	Make the logged variable suitable for MATLAB.
+ *      Append the MAT-file element held in src to fp as one miCOMPRESSED
+ *      element and close src. Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
  */
-static const char_T *rt_FixupLogVar(LogVar *var,int verbose)
+static int_T rt_DeflateMatItem(FILE *fp, FILE *src)
 {
-    int_T  nCols   = var->data.nCols;
-    int_T  maxRows = var->data.nRows;
-    int_T  nDims   = var->data.nDims;
-    size_t elSize  = var->data.elSize;
-    int_T  nRows   = (var->wrapped ?  maxRows : var->rowIdx);
+    MatItem       item   = {matCOMPRESSED, 0, NULL};
+    unsigned char *in    = malloc(2*LOGGING_MAT_COMPRESS_CHUNK);
+    unsigned char *out   = in + LOGGING_MAT_COMPRESS_CHUNK;
+    long          start  = ftell(fp);
+    long          end;
+    int_T         status = 1;
+    int           flush  = -1;          /* < 0 after an error              */
+    z_stream      zs;
+
+    (void)memset(&zs, 0, sizeof(zs));
+    if (in == NULL || start < 0) goto EXIT_POINT;
+    if (fwrite(&item, 1, matTAG_SIZE, fp) != matTAG_SIZE) goto EXIT_POINT;
+    if (fseek(src, 0L, SEEK_SET) != 0) goto EXIT_POINT;
+    if (deflateInit(&zs, LOGGING_MAT_COMPRESS_LEVEL) != Z_OK) goto EXIT_POINT;
+
+    do {
+        zs.next_in  = in;
+        zs.avail_in = (uInt)fread(in, 1, LOGGING_MAT_COMPRESS_CHUNK, src);
+        if (ferror(src)) {
+            flush = -1;
+            break;
+        }
+        flush = feof(src) ? Z_FINISH : Z_NO_FLUSH;
+        do {
+            size_t nOut;
+
+            zs.next_out  = out;
+            zs.avail_out = LOGGING_MAT_COMPRESS_CHUNK;
+            (void)deflate(&zs, flush);
+            nOut = LOGGING_MAT_COMPRESS_CHUNK - zs.avail_out;
+            if (fwrite(out, 1, nOut, fp) != nOut) flush = -1;
+        } while (flush >= 0 && zs.avail_out == 0);
+    } while (flush == Z_NO_FLUSH);
+    (void)deflateEnd(&zs);
+    if (flush != Z_FINISH) goto EXIT_POINT;
+
+    /* the size of a compressed element is not padded to 8 bytes */
+    end = ftell(fp);
+    if (end < 0 || end - start - (long)matTAG_SIZE > (long)UINT_MAX) {
+        goto EXIT_POINT;
+    }
+    item.nbytes = (uint32_T)(end - start - (long)matTAG_SIZE);
+    if (fseek(fp, start, SEEK_SET) == 0 &&
+        fwrite(&item, 1, matTAG_SIZE, fp) == matTAG_SIZE &&
+        fseek(fp, end, SEEK_SET) == 0) {
+        status = 0;
+    }
 
-    var->nDataPoints = var->rowIdx + var->wrapped * maxRows;
+ EXIT_POINT:
+    FREE(in);
+    (void)fclose(src);
+    return(status);
 
-    if (var->wrapped > 1 || (var->wrapped == 1 && var->rowIdx != 0)) {
-        /*
-         * Warn the user the circular buffer has wrapped, implying that
-         * some data has been lost.
-         */
-        if( verbose) {
-            (void)fprintf(stdout,
-                          "*** Log variable %s has wrapped %d times\n"
-                          "    using a circular buffer of size %d\n",
-                          var->data.name, var->wrapped, var->data.nRows);
-        }
-        if (var->usingDefaultBufSize) {
-            /*
-             * If wrapping occurred using the default buffer size,
-             * let the user know what size buffer to use in the
-             * future to avoid wrapping.  If the default buffer
-             * size was not used, the user has no control to specify
-             * the correct value.  Wrapping may occur when not using
-             * the default buffer if we allocated too small a buffer
-             * size for this logvar.  One common case is a toWorkspace
-             * block inside of an iterative subsystem - we can not take
-             * the number of iterations into account (they may be
-             * variable) when allocating the buffer.  In this case,
-             * just warn the buffer wrapped and don't tell user they
-             * can override the buffer size.
-             */
-            if( verbose ) {
-                (void)fprintf(stdout,
-                              "*** To avoid wrapping, explicitly specify a\n"
-                              "    buffer size of %d in your Simulink model\n"
-                              "    by adding OPTS=\"-DDEFAULT_BUFFER_SIZE=%d\"\n"
-                              "    as an argument to the ConfigSet MakeCommand\n"
-                              "    parameter\n",
-                              var->nDataPoints, var->nDataPoints);
-            }
-        }
+} /* end rt_DeflateMatItem */
+
+
+#ifdef LOGGING_PTHREADS
+/* Function: rt_DeflateMatItemThread ===========================================
+ * Abstract:
+ *      Body of the thread that compresses the pending item of a writer.
+ */
+static void *rt_DeflateMatItemThread(void *arg)
+{
+    MatFileWriter *writer = (MatFileWriter *)arg;
+
+    writer->status = rt_DeflateMatItem(writer->fp, writer->pending);
+    return(NULL);
+
+} /* end rt_DeflateMatItemThread */
+#endif
+
+
+/* Function: rt_FinishMatItem ==================================================
+ * Abstract:
+ *      Wait for the pending item of the writer to be compressed into the
+ *      MAT-file. Returns the status of rt_DeflateMatItem.
+ */
+static int_T rt_FinishMatItem(MatFileWriter *writer)
+{
+#ifdef LOGGING_PTHREADS
+    if (writer->busy) {
+        (void)pthread_join(writer->worker, NULL);
+        writer->busy    = 0;
+        writer->pending = NULL;
+    }
+#endif
+    if (writer->pending != NULL) {
+        writer->status  = rt_DeflateMatItem(writer->fp, writer->pending);
+        writer->pending = NULL;
     }
+    return(writer->status);
 
-    if (nDims < 2 && nCols > 1) {  /* Transpose? */
-        /* Don't need to transpose valueDimensions */
-        int_T  nEl    = nRows*nCols;
-        char   *src   = var->data.re;
-        char   *pmT;
-        int_T  k;
+} /* end rt_FinishMatItem */
 
-        /**********************************
-         * If memory cannot be allocated, *
-         * write to a temporary buffer    *
-         **********************************/
-        if ((pmT = malloc(nEl*elSize)) == NULL) {
-            FILE  *fptr;
-            char  fName[mxMAXNAM+13];
+#endif /* LOGGING_MAT_COMPRESS */
+
+
+/* Function: rt_WriteVarToMatFile ==============================================
+ * Abstract:
+ *      Write a top level variable (LogVar or StructLogVar) to the MAT-file.
+ *
+ *      With LOGGING_MAT_COMPRESS, the variable is written to a temporary
+ *      file and deflated into a miCOMPRESSED element. With LOGGING_THREAD as
+ *      well, this happens on a worker thread while the caller prepares and
+ *      writes out the next variable; rt_CloseMatFileWriter waits for it.
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_WriteVarToMatFile(MatFileWriter *writer,
+                                  MatItem       *pItem,
+                                  ItemDataKind  itemKind)
+{
+#ifdef LOGGING_MAT_COMPRESS
+    FILE *tmp = tmpfile();
+
+    if (tmp == NULL) {
+        /* write it uncompressed, after the items already queued */
+        if (rt_FinishMatItem(writer)) return(1);
+        return(rt_WriteItemToMatFile(writer->fp, pItem, itemKind));
+    }
+    if (rt_WriteItemToMatFile(tmp, pItem, itemKind)) {
+        (void)fclose(tmp);
+        return(1);
+    }
+    if (rt_FinishMatItem(writer)) {
+        (void)fclose(tmp);
+        return(1);
+    }
+    writer->pending = tmp;
+#ifdef LOGGING_PTHREADS
+    writer->busy = (pthread_create(&writer->worker, NULL,
+                                   rt_DeflateMatItemThread, writer) == 0);
+#endif
+    return(0);
+#else
+    return(rt_WriteItemToMatFile(writer->fp, pItem, itemKind));
+#endif
+
+} /* end rt_WriteVarToMatFile */
+
+
+/* Function: rt_CloseMatFileWriter =============================================
+ * Abstract:
+ *      Finish writing the variables passed to rt_WriteVarToMatFile.
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_CloseMatFileWriter(MatFileWriter *writer)
+{
+#ifdef LOGGING_MAT_COMPRESS
+    return(rt_FinishMatItem(writer));
+#else
+    (void)writer;
+    return(0);
+#endif
+
+} /* end rt_CloseMatFileWriter */
+
+
+/* Function: rt_FreeLogVarChunks ===============================================
+ * Abstract:
+ *      Free the chunks added to the log variable by rt_ReallocLogVar.
+ */
+static void rt_FreeLogVarChunks(LogVar *var)
+{
+    while (var->chunks != NULL) {
+        LogChunk *chunk = var->chunks;
+
+        var->chunks = chunk->next;
+        FREE(chunk->re);
+        FREE(chunk->im);
+        FREE(chunk->dimsData);
+        FREE(chunk);
+    }
+    var->currChunk = NULL;
+
+} /* end rt_FreeLogVarChunks */
 
-            (void)sprintf(fName, "%s%s", var->data.name, "_rtw_tmw.tmw");
-            if ((fptr=fopen(fName,"w+b")) == NULL) {
-                (void)fprintf(stderr,"*** Error opening %s",fName);
-                return("unable to open data file\n");
-            }
 
-            /****************************
-             * Write the data to a file *
-             ****************************/
-            for (k=0; k<nEl; k++) {
-                int_T kT   = nCols*(k%nRows) + (k/nRows);
-                char  *dst = src + kT*elSize;
-                (void)fwrite(dst, elSize, 1, fptr);
+#ifdef LOGGING_STREAM
+
+/* Function: rt_GatherLogVar ===================================================
+ * Abstract:
+ *      Append the rows held in chunks (see rt_ReallocLogVar) to the initial
+ *      buffer of the log variable so that its data is contiguous again, as
+ *      rt_WriteStreamedLogVar expects after the spool file. Unused rows at
+ *      the end of the last chunk are dropped.
+ */
+static const char_T *rt_GatherLogVar(LogVar *var)
+{
+    size_t    rowBytes  = var->data.nCols * var->data.elSize;
+    int_T     nBaseRows = var->nBaseRows;
+    int_T     nRows     = (var->wrapped ? var->data.nRows : var->rowIdx);
+    boolean_T varDims   = (var->valDims != NULL &&
+                           var->valDims->dimsData != NULL);
+    int_T     part;
+
+    if (var->chunks == NULL) {
+        return(NULL);
+    }
+    if (nRows < nBaseRows) {
+        nRows = nBaseRows;
+    }
+
+    if (nRows > nBaseRows) {
+        for (part = 0; part < (var->data.complex ? 2 : 1); part++) {
+            void     **buf  = (part ? &var->data.im : &var->data.re);
+            void     *tmp   = realloc(*buf, nRows*rowBytes);
+            LogChunk *chunk = var->chunks;
+            int_T    row    = nBaseRows;
+            char_T   *dst;
+
+            if (tmp == NULL) {
+                return("unable to allocate memory for the logged data\n");
             }
-            if (var->data.complex) {
-                char *pmiT = var->data.re;
-                src  = var->data.im;
-                for (k=0; k<nEl; k++) {
-                    int_T kT   = nRows*(k%nCols) + (k/nCols);
-                    char  *dst = pmiT + kT*elSize;
-                    (void)memcpy(dst, src, elSize);
-                    src += elSize;
-                }
-                var->data.re = var->data.im;
-                var->data.im = pmiT;
+            *buf = tmp;
+            dst  = (char_T*)tmp + (size_t)row*rowBytes;
+            for (; row < nRows; chunk = chunk->next) {
+                int_T n = (chunk->nRows < nRows - row) ?
+                          chunk->nRows : nRows - row;
+
+                (void)memcpy(dst, part ? chunk->im : chunk->re, n*rowBytes);
+                dst += n*rowBytes;
+                row += n;
             }
+        }
 
-            /*******************************
-             * Read the data from the file *
-             *******************************/
-            (void)rewind(fptr);
-            (void)fread(var->data.re, elSize, nEl, fptr);
-            (void)fclose(fptr);
-            (void)remove(fName);
-        } else {
-            for (k=0; k<nEl; k++) {
-                int_T kT   = nRows*(k%nCols) + (k/nCols);
-                char  *dst = pmT + kT*elSize;
-                (void)memcpy(dst, src, elSize);
-                src += elSize;
+        if (varDims) {
+            int_T  nColsValDims = var->valDims->nCols;
+            real_T *dimsData    = malloc(nRows*nColsValDims*sizeof(real_T));
+            int_T  j;
+
+            if (dimsData == NULL) {
+                return("unable to allocate memory for the logged data\n");
             }
-            if (var->data.complex) {
-                char *pmiT = var->data.re;
-                src  = var->data.im;
-                for (k=0; k<nEl; k++) {
-                    int_T kT   = nRows*(k%nCols) + (k/nCols);
-                    char  *dst = pmiT + kT*elSize;
-                    (void)memcpy(dst, src, elSize);
-                    src += elSize;
+            for (j = 0; j < nColsValDims; j++) {
+                real_T   *dst   = dimsData + (size_t)j*nRows;
+                LogChunk *chunk = var->chunks;
+                int_T    row    = nBaseRows;
+
+                (void)memcpy(dst, var->valDims->dimsData + (size_t)j*nBaseRows,
+                             nBaseRows*sizeof(real_T));
+                for (; row < nRows; chunk = chunk->next) {
+                    int_T n = (chunk->nRows < nRows - row) ?
+                              chunk->nRows : nRows - row;
+
+                    (void)memcpy(dst + row,
+                                 chunk->dimsData + (size_t)j*chunk->nRows,
+                                 n*sizeof(real_T));
+                    row += n;
                 }
-                var->data.re = var->data.im;
-                var->data.im = pmiT;
             }
-            FREE(var->data.re);
-            var->data.re = pmT;
+            free(var->valDims->dimsData);
+            var->valDims->dimsData = dimsData;
         }
-    } /* Transpose? */
+    }
 
-    if (var->wrapped > 0 && var->rowIdx != 0 ) {  /* Rotate? */
-        char_T *buffer    = var->data.re;
-        int_T  done       = 0; /* done: 0 (1) rotate real (imag) part. */
+    rt_FreeLogVarChunks(var);
+    if (var->valDims != NULL && (varDims || nRows < var->data.nRows)) {
+        /* as rt_FixupLogVar does when it drops the unused rows */
+        var->valDims->nRows = nRows;
+    }
+    var->nBaseRows  = nRows;
+    var->data.nRows = nRows;
+    return(NULL);
 
-        do {
-            char_T *col       = buffer;
-            int_T  rowOffset  = (int_T)((nDims == 1) ? (elSize) : (elSize * nCols));
-            int_T  colOffset  = (int_T)((nDims == 1)?  (nRows*elSize) : elSize);
-            int_T  zeroIdx    = var->rowIdx;
-            int_T  j;
+} /* end rt_GatherLogVar */
 
-            for (j = 0 ; j < nCols; ++j, col += colOffset) {
-                int_T   swapCount;
-                int_T   srcIdx;
-                int_T   dstIdx;
-                int_T   tmpIdx;
-                MatReal tmp;
-
-                for (tmpIdx=0, swapCount=0; swapCount < nRows; tmpIdx++) {
-                    (void)memcpy(&tmp, col + tmpIdx*rowOffset, elSize);
-
-                    dstIdx=tmpIdx; 
-                    srcIdx = ((dstIdx + zeroIdx) % nRows);
-                    while (srcIdx != tmpIdx) {
-                        (void)memcpy(col + dstIdx*rowOffset,
-                                     col + srcIdx*rowOffset,
-                                     elSize);
-                        ++swapCount;
-                        dstIdx = srcIdx;
-                        srcIdx = ((dstIdx + zeroIdx) % nRows);
-                        
-                    }
-                    (void)memcpy(col + dstIdx*rowOffset, &tmp, elSize);
-                    ++swapCount;
-                }
+#endif /* LOGGING_STREAM */
+
+
+/* Function: rt_FixupLogVar ====================================================
+ * Abstract:
+ *	Make the logged variable suitable for MATLAB.
+ *
+ *      Only the number of rows to save is settled here. The data stays where
+ *      it was logged, in the initial buffer and the chunks added to it, and
+ *      rt_WriteLogVarPart writes it in MATLAB order: transposed for vector
+ *      signals and starting at the oldest row of a circular buffer.
+ */
+static const char_T *rt_FixupLogVar(LogVar *var,int verbose)
+{
+#ifdef LOGGING_STREAM
+    if (var->nSpooledRows > 0) {
+        const char_T *errMsg = rt_GatherLogVar(var);
+
+        if (errMsg != NULL) {
+            return(errMsg);
+        }
+        if (var->wrapped == 0) {
+            /*
+             * The data is written by rt_WriteStreamedLogVar straight from
+             * the spool file, it only needs the final number of rows.
+             */
+            if (var->spoolFirstBlock > 0 && verbose) {
+                (void)fprintf(stdout,
+                              "*** Log variable %s has dropped its first %.0f "
+                              "rows\n    keeping the last %d rows in a spool "
+                              "file of at most %.0f bytes\n",
+                              var->data.name, (double)var->spoolFirstBlock *
+                              var->spoolBlockRows,
+                              var->nSpooledRows + var->rowIdx,
+                              (double)LOGGING_STREAM_MAX_BYTES);
+            }
+            var->nDataPoints = var->nSpooledRows + var->rowIdx;
+            var->data.nRows  = var->nDataPoints;
+            if (var->valDims != NULL && var->valDims->dimsData != NULL) {
+                var->valDims->nRows = var->nDataPoints;
             }
-            done ++;
-            /* need to rotate the imaginary part */
-        } while ((done == 1) && ((buffer = var->data.im) != NULL));
+            return(NULL);
+        }
+        /*
+         * Streaming stopped and then memory ran out too, so the buffer
+         * wrapped. Only the circular buffer can be saved: keep the spool
+         * file, whose header describes its rows, and say so.
+         */
+        (void)fprintf(stderr,
+                      "*** Log variable %s could not be saved in full: its "
+                      "first %.0f rows\n    are not in the MAT-file, they "
+                      "are kept in the file %s\n",
+                      var->data.name, (double)var->nSpooledRows,
+                      var->spoolName);
+        (void)fclose(var->spool);
+        var->spool        = NULL;
+        var->nSpooledRows = 0;
+    }
+#endif
 
-        var->rowIdx = 0;
-    } /* Rotate? */
+    var->nDataPoints = var->rowIdx + var->wrapped * var->data.nRows;
+
+    if (var->wrapped > 1 || (var->wrapped == 1 && var->rowIdx != 0)) {
+        /*
+         * Warn the user the circular buffer has wrapped, implying that
+         * some data has been lost.
+         */
+        if( verbose) {
+            (void)fprintf(stdout,
+                          "*** Log variable %s has wrapped %d times\n"
+                          "    using a circular buffer of size %d\n",
+                          var->data.name, var->wrapped, var->data.nRows);
+        }
+        if (var->usingDefaultBufSize) {
+            /*
+             * If wrapping occurred using the default buffer size,
+             * let the user know what size buffer to use in the
+             * future to avoid wrapping.  If the default buffer
+             * size was not used, the user has no control to specify
+             * the correct value.  Wrapping may occur when not using
+             * the default buffer if we allocated too small a buffer
+             * size for this logvar.  One common case is a toWorkspace
+             * block inside of an iterative subsystem - we can not take
+             * the number of iterations into account (they may be
+             * variable) when allocating the buffer.  In this case,
+             * just warn the buffer wrapped and don't tell user they
+             * can override the buffer size.
+             */
+            if( verbose ) {
+                (void)fprintf(stdout,
+                              "*** To avoid wrapping, explicitly specify a\n"
+                              "    buffer size of %d in your Simulink model\n"
+                              "    by adding OPTS=\"-DDEFAULT_BUFFER_SIZE=%d\"\n"
+                              "    as an argument to the ConfigSet MakeCommand\n"
+                              "    parameter\n",
+                              var->nDataPoints, var->nDataPoints);
+            }
+        }
+    }
 
     /*
      * We might have allocated more number of rows than the number of data
      * points that have been logged, in which case set nRows to nDataPoints
-     * so that only these values get saved.
+     * so that only these values get saved. Keep nRows of values and that of
+     * valueDimensions consistent for variable-size signals; the unused rows
+     * of valueDimensions are skipped when it is written.
      */
     if (var->nDataPoints < var->data.nRows) {
         var->data.nRows = var->nDataPoints;
-        if(var->valDims != NULL){
-            size_t elSizeValDims = sizeof(real_T);
-            int_T  k;
-            real_T *dimsData = var->valDims->dimsData + nRows;
-            /* 
-               Keep nRows of values and that of valueDimensions consistent 
-               for variable-size signals.
-            */
+        if (var->valDims != NULL) {
             var->valDims->nRows = var->data.nRows;
-            /*
-               Also need to move data when shrinking the array size,
-               because valueDimensions data is stored in array format. 
-               e.g. maxRows = 4; nRows = 2; nDims = 3;
-               Before fixing up the logVar, the locations of data are as below:
-               (x, y, z -- useful data / o -- junk)
-               a[0] = x    a[4] = y    a[8] = z
-               a[1] = x    a[5] = y    a[9] = z
-               a[2] = o    a[6] = o    a[10]= o
-               a[3] = o    a[7] = o    a[11]= o
-               After fixing up the logVar, we want the data to be stored as:
-               a[0] = x    a[4] = z    a[8] = o
-               a[1] = x    a[5] = z    a[9] = o
-               a[2] = y    a[6] = o    a[10]= o
-               a[3] = y    a[7] = o    a[11]= o
-            */
-            for(k = 1; k < nDims; k++){
-                (void) memmove(dimsData, 
-                              var->valDims->dimsData + k*maxRows,
-                              elSizeValDims * nRows);
-                dimsData += nRows;
-            }
         }
     }
     return(NULL);
@@ -1488,6 +2383,12 @@ static void rt_DestroyLogVar(LogVar *head)
             FREE(var->valDims->dimsData);
             FREE(var->valDims);
         }
+        rt_FreeLogVarChunks(var);
+        if (var->spool != NULL) {
+            (void)fclose(var->spool);
+            (void)remove(var->spoolName);
+        }
+        FREE(var->spoolName);
         /* free coords, strides and currStrides if necessary */
         FREE(var->coords);
         FREE(var->strides);
@@ -1524,15 +2425,44 @@ static void rt_DestroyStructLogVar(StructLogVar *head)
         FREE(var->signals.stateNames);
         FREE(var->signals.crossMdlRef);
         FREE(var->blockName);
+        FREE(var->valueVars);
+        FREE(var->valueOffsets);
         FREE(var);
     }
 
 } /* end rt_DestroyStructLogVar */
 
 
+/* Forward declaration */
+static LogVar *local_CreateLogVar(
+    RTWLogInfo        *li,
+    const real_T      startTime,
+    const real_T      finalTime,
+    const real_T      inStepSize,
+    const char_T      **errStatus,
+    const char_T      *varName,
+    BuiltInDTypeId    inpDataTypeID,
+    const RTWLogDataTypeConvert *pDataTypeConvertInfo,
+    int_T             logical,
+    int_T             complex,
+    int_T             frameData,
+    int_T             nCols,
+    int_T             nDims,
+    const int_T       *dims,
+    LogValDimsStat    logValDimsStat,
+    void              **currSigDims,
+    int_T             *currSigDimsSize,
+    int_T             maxRows,
+    int_T             decimation,
+    real_T            sampleTime,
+    int_T             appendToLogVarsList);
+
+
 /* Function: rt_InitSignalsStruct ==============================================
  * Abstract:
- *      Initialize the signals structure in the struct log variable.
+ *      Initialize the signals structure in the struct log variable. The
+ *      values of states are kept double (keepDouble) with
+ *      LOGGING_DOUBLES_AS_SINGLE.
  *
  * Returns:
  *	== NULL  => success.
@@ -1548,7 +2478,8 @@ static const char_T *rt_InitSignalsStruct(RTWLogInfo             *li,
                                           int_T                  maxRows,
                                           int_T                  decimation,
                                           real_T                 sampleTime,
-                                          const RTWLogSignalInfo *sigInfo)
+                                          const RTWLogSignalInfo *sigInfo,
+                                          boolean_T              keepDouble)
 {
     int_T                i, sigIdx;
     SignalsStruct        *sig          = &(var->signals);
@@ -1578,6 +2509,9 @@ static const char_T *rt_InitSignalsStruct(RTWLogInfo             *li,
 
     /* reset error status */
     *errStatus = NULL;
+#ifndef LOGGING_DOUBLES_AS_SINGLE
+    (void)keepDouble;
+#endif
 
     sig->numActiveFields = 1;
     sig->numSignals      = nSignals;
@@ -1601,10 +2535,20 @@ static const char_T *rt_InitSignalsStruct(RTWLogInfo             *li,
 
         const RTWLogDataTypeConvert *pDTConvInfoCur =
                        (pDTConvInfo)  ? (pDTConvInfo+i)  : 0;
+#ifdef LOGGING_DOUBLES_AS_SINGLE
+        RTWLogDataTypeConvert singleConvInfo;
+#endif
 
         LogVar *values = NULL;
         LogValDimsStat logValDimsStat;
 
+#ifdef LOGGING_DOUBLES_AS_SINGLE
+        if (!keepDouble) {
+            pDTConvInfoCur = rt_GetSingleConvertInfo(&dt, pDTConvInfoCur,
+                                                     &singleConvInfo);
+        }
+#endif
+
         if(!logValueDimensions){
             logValDimsStat = NO_LOGVALDIMS;
         }
@@ -1613,18 +2557,18 @@ static const char_T *rt_InitSignalsStruct(RTWLogInfo             *li,
                                             LOGVALDIMS_EMPTYMX;
         }
 
-        values = rt_CreateLogVarWithConvert(li, startTime, finalTime,
-                                            inStepSize, errStatus,
-                                            &VALUES_FIELD_NAME,
-                                            dt, 
-                                            pDTConvInfoCur,
-                                            0, cs, fd,
-                                            numCols[i],nd,
-                                            dims + dimsOffset,
-                                            logValDimsStat,
-                                            currSigDims + dimsOffset,
-                                            currSigDimsSize + dimsOffset,
-                                            maxRows,decimation,sampleTime, 0);
+        values = local_CreateLogVar(li, startTime, finalTime,
+                                    inStepSize, errStatus,
+                                    &VALUES_FIELD_NAME,
+                                    dt, 
+                                    pDTConvInfoCur,
+                                    0, cs, fd,
+                                    numCols[i],nd,
+                                    dims + dimsOffset,
+                                    logValDimsStat,
+                                    currSigDims + dimsOffset,
+                                    currSigDimsSize + dimsOffset,
+                                    maxRows,decimation,sampleTime, 0);
 
         if (values == NULL) goto ERROR_EXIT;
 
@@ -2088,7 +3032,8 @@ static const char_T *rt_InitSignalsStruct(RTWLogInfo             *li,
 
 /* Function: local_CreateStructLogVar ==========================================
  * Abstract:
- *      Create a logging variable in the structure format.
+ *      Create a logging variable in the structure format. keepDouble is set
+ *      for states, see rt_InitSignalsStruct.
  *
  * Returns:
  *      ~= NULL  => success, returns the log variable created.
@@ -2106,7 +3051,8 @@ static StructLogVar *local_CreateStructLogVar(
     int_T                   decimation,
     real_T                  sampleTime,
     const RTWLogSignalInfo  *sigInfo,
-    const char_T            *blockName)
+    const char_T            *blockName,
+    boolean_T               keepDouble)
 {
     StructLogVar *var;
     LogInfo      *logInfo = rtliGetLogInfo(li);
@@ -2125,14 +3071,14 @@ static StructLogVar *local_CreateStructLogVar(
     if (logTime) {
         /* need to create a LogVar to log time */
         int_T dims = 1;
-        var->time = rt_CreateLogVarWithConvert(li, startTime, finalTime,
-                                               inStepSize, errStatus,
-                                               &TIME_FIELD_NAME, SS_DOUBLE, 
-                                               NULL,
-                                               0, 0, 0, 1,
-                                               1, &dims, NO_LOGVALDIMS, 
-                                               NULL, NULL, maxRows,
-                                               decimation, sampleTime, 0);
+        var->time = local_CreateLogVar(li, startTime, finalTime,
+                                       inStepSize, errStatus,
+                                       &TIME_FIELD_NAME, SS_DOUBLE, 
+                                       NULL,
+                                       0, 0, 0, 1,
+                                       1, &dims, NO_LOGVALDIMS, 
+                                       NULL, NULL, maxRows,
+                                       decimation, sampleTime, 0);
         if (var->time == NULL) goto ERROR_EXIT;
     } else {
         /* create a dummy MatrixData to write out time as an empty matrix */
@@ -2160,7 +3106,8 @@ static StructLogVar *local_CreateStructLogVar(
     /* signals field */
     if (sigInfo) {
         if (rt_InitSignalsStruct(li,startTime,finalTime,inStepSize,errStatus,
-                                 var,maxRows,decimation,sampleTime,sigInfo)) {
+                                 var,maxRows,decimation,sampleTime,sigInfo,
+                                 keepDouble)) {
             goto ERROR_EXIT;
         }
     }
@@ -2359,7 +3306,8 @@ static const char_T *rt_StartDataLoggingForOutput(RTWLogInfo   *li,
                                                             errStatus, name,
                                                             logTime, maxRows,
                                                             decimation, sampleTime,
-                                                            &yInfo[yIdx], NULL);
+                                                            &yInfo[yIdx], NULL,
+                                                            false);
                 if (logInfo->y[yIdx] == NULL) goto ERROR_EXIT;
             }
             ++yIdx;
@@ -2393,191 +3341,559 @@ static const char_T *rt_StartDataLoggingForOutput(RTWLogInfo   *li,
 /* Function: rt_ReallocLogVar ==================================================
  * Abstract:
  *   Allocate more memory for the data buffers in the log variable.
- *   Exit if unable to allocate more memory.
+ *
+ *   The new rows are appended as a chunk (LogChunk) so the rows logged so
+ *   far are never copied; rt_WriteLogVarPart() writes the chunks in place
+ *   when the MAT-file is written. Each chunk doubles the number of rows, up
+ *   to LOGGING_CHUNK_MAX_BYTES per chunk.
+ *
+ *   If unable to allocate more memory, okayToRealloc is cleared so the
+ *   caller keeps logging into a circular buffer of the current size.
  */
-static void rt_ReallocLogVar(LogVar *var, boolean_T isVarDims)
+static void rt_ReallocLogVar(LogVar *var)
 {
-    void *tmp;
-    int_T nCols = var->data.nCols;
-    int_T nRows;
-    size_t elSize = var->data.elSize;
+    LogChunk *chunk;
+    size_t   rowBytes = var->data.nCols * var->data.elSize;
+    int_T    nRows    = var->data.nRows == 0 ? 1 : var->data.nRows;
+    int_T    nColsValDims = 0;
 
-    if (isVarDims)
-    {
-        nRows = var->data.nRows + DEFAULT_BUFFER_SIZE;
+    if (var->valDims != NULL && var->valDims->dimsData != NULL) {
+        nColsValDims = var->valDims->nCols;
     }
-    else
-    {
-        nRows = var->data.nRows == 0 ? 1 : 2*var->data.nRows;
-    }
-    
-    tmp = realloc(var->data.re, nRows*nCols*elSize);
-    if (tmp == NULL) {
-        (void)fprintf(stderr,
-                      "*** Memory allocation error.\n");
-        (void)fprintf(stderr, ""
-                      "    varName          = %s%s\n"
-                      "    nRows            = %d\n"
-                      "    nCols            = %d\n"
-                      "    elementSize      = %lu\n"
-                      "    Current Size     = %.16g\n"
-                      "    Failed resize    = %.16g\n\n",
-                      var->data.name,
-                      var->data.complex ? " (real part)" : "",
-                      var->data.nRows,
-                      var->data.nCols,
-                      (unsigned long)  var->data.elSize,
-                      (double)nRows*nCols*elSize,
-                      (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
-        exit(1);
+    if (rowBytes > 0 && (size_t)nRows > LOGGING_CHUNK_MAX_BYTES/rowBytes) {
+        nRows = (int_T)(LOGGING_CHUNK_MAX_BYTES/rowBytes);
+        if (nRows == 0) nRows = 1;
     }
-    var->data.re = tmp;
-
-    if (var->data.complex) {
-        tmp = realloc(var->data.im, nRows*nCols*elSize);
-        if (tmp == NULL) {
-            (void)fprintf(stderr,
-                          "*** Memory allocation error.\n");
-            (void)fprintf(stderr, ""
-                          "    varName          = %s (complex part)\n"
-                          "    nRows            = %d\n"
-                          "    nCols            = %d\n"
-                          "    elementSize      = %lu\n"
-                          "    Current Size     = %.16g\n"
-                          "    Failed resize    = %.16g\n\n",
-                          var->data.name,
-                          var->data.nRows,
-                          var->data.nCols,
-                          (unsigned long)  var->data.elSize,
-                          (double)nRows*nCols*elSize,
-                          (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
-            exit(1);
-        }
-        var->data.im = tmp;
+    if (nRows > INT_MAX - var->data.nRows) {
+        nRows = INT_MAX - var->data.nRows;
     }
-    var->data.nRows = nRows;
 
-    /* Also reallocate memory for "valueDimensions" 
-       when logging the variable-size signal
-    */
-    if(isVarDims){
-        int_T k;
-        
-        nCols = var->valDims->nCols;
-        nRows = var->valDims->nRows + DEFAULT_BUFFER_SIZE;
-        elSize = sizeof(real_T);
-        tmp = realloc(var->valDims->dimsData, nRows*nCols*elSize);
-        if (tmp == NULL) {
-            (void)fprintf(stderr,
-                          "*** Memory allocation error.\n");
-            (void)fprintf(stderr, ""
-                          "    varName          = %s\n"
-                          "    nRows            = %d\n"
-                          "    nCols            = %d\n"
-                          "    elementSize      = %lu\n"
-                          "    Current Size     = %.16g\n"
-                          "    Failed resize    = %.16g\n\n",
-                          var->valDims->name,
-                          var->valDims->nRows,
-                          var->valDims->nCols,
-                          (unsigned long)  elSize,
-                          (double)nRows*nCols*elSize,
-                          (double)(nRows+DEFAULT_BUFFER_SIZE)*nCols*elSize);
-            exit(1);
+    if (nRows > 0 && (chunk = calloc(1, sizeof(LogChunk))) != NULL) {
+        chunk->row0  = var->data.nRows;
+        chunk->nRows = nRows;
+        chunk->re    = malloc(nRows*rowBytes);
+        if (var->data.complex) {
+            chunk->im = malloc(nRows*rowBytes);
         }
-
-        /*
-         * valueDimensions data is stored in array format and must be
-         * adjusted after reallocation (see also rt_FixupLogVar())
-         *
-         * Example: maxRows = 4; nRows = 4; nDims = 3;
-         * Before realloc of the logVar, the locations of data are as below:
-         * (x, y, z -- useful data / o -- junk, don't care)
-         * a[0] = x    a[4] = y    a[8] = z
-         * a[1] = x    a[5] = y    a[9] = z
-         * a[2] = x    a[6] = y    a[10]= z
-         * a[3] = x    a[7] = y    a[11]= z
-         *
-         * After realloc of the logVar (suppose 2 extra rows are added),
-         * the locations of data are as below:
-         * a[0] = x    a[6] = y    a[12]= o
-         * a[1] = x    a[7] = y    a[13]= o
-         * a[2] = x    a[8] = z    a[14]= o
-         * a[3] = x    a[9] = z    a[15]= o
-         * a[4] = y    a[10]= z    a[16]= o
-         * a[5] = y    a[11]= z    a[17]= o
-         *
-         * The data must be adjusted as below:
-         * a[0] = x    a[6] = y    a[12]= z
-         * a[1] = x    a[7] = y    a[13]= z
-         * a[2] = x    a[8] = y    a[14]= z
-         * a[3] = x    a[9] = y    a[15]= z
-         * a[4] = o    a[10]= o    a[16]= o
-         * a[5] = o    a[11]= o    a[17]= o
-         */
-        for(k = var->data.nDims-1; k > 0; k--){
-            (void) memcpy((real_T*)tmp + k*nRows, 
-                          (real_T*)tmp + k*var->valDims->nRows,
-                          elSize * var->valDims->nRows);
+        if (nColsValDims > 0) {
+            chunk->dimsData = malloc(nRows*nColsValDims*sizeof(real_T));
         }
-
-        var->valDims->dimsData = tmp;
-        var->valDims->nRows = nRows;
+        if (chunk->re != NULL &&
+            (chunk->im != NULL || !var->data.complex) &&
+            (chunk->dimsData != NULL || nColsValDims == 0)) {
+            if (var->chunks == NULL) {
+                var->chunks = chunk;
+            } else {
+                LogChunk *last = var->chunks;
+                while (last->next != NULL) {
+                    last = last->next;
+                }
+                last->next = chunk;
+            }
+            var->data.nRows += nRows;
+            if (nColsValDims > 0) {
+                var->valDims->nRows += nRows;
+            }
+#ifdef LOGGING_STATS
+            ++var->stats.nGrows;
+#endif
+            return;
+        }
+        FREE(chunk->re);
+        FREE(chunk->im);
+        FREE(chunk->dimsData);
+        FREE(chunk);
     }
 
+    (void)fprintf(stderr,
+                  "*** Memory allocation error.\n");
+    (void)fprintf(stderr, ""
+                  "    varName          = %s\n"
+                  "    nRows            = %d\n"
+                  "    nCols            = %d\n"
+                  "    elementSize      = %lu\n"
+                  "    Current Size     = %.16g\n"
+                  "    Failed resize    = %.16g\n"
+                  "    Logging continues in a circular buffer of %d rows\n\n",
+                  var->data.name,
+                  var->data.nRows,
+                  var->data.nCols,
+                  (unsigned long)  var->data.elSize,
+                  (double)var->data.nRows*rowBytes,
+                  ((double)var->data.nRows+nRows)*rowBytes,
+                  var->data.nRows);
+    var->okayToRealloc = 0;
+
 } /* end rt_ReallocLogVar */
 
-const char_T *rt_UpdateLogVarWithDiscontiguousData(LogVar                 *var,
-                                             int8_T**               data,
-                                             const int_T            *segmentLengths,
-                                             int_T                  nSegments,
-                                             RTWPreprocessingFcnPtr *preprocessingPtrs);
-                                             
-/* Function: rt_UpdateLogVarWithDiscontiguousData ==============================
+
+#ifdef LOGGING_STREAM
+
+/* Function: rt_WriteSpoolHeader ===============================================
  * Abstract:
- *      Log one row of the LogVar with data that is not contiguous.
+ *   Write the header that makes the spool file of a LogVar readable without
+ *   the model, for instance after a crash. It is plain text, one "key value"
+ *   line per item, padded with blanks to a multiple of
+ *   LOGGING_SPOOL_HEADER_ALIGN bytes (headerBytes) and ending in a newline:
+ *
+ *     RTW_LOG_SPOOL 1
+ *     firstBlock <blocks overwritten so far, 10 digits>
+ *     name <variable name>
+ *     mxClass <mxClassID of the elements>
+ *     elementSize <bytes per element>
+ *     complex <0|1>
+ *     logical <0|1>
+ *     byteOrder <little|big>
+ *     columns <elements per row>
+ *     dims <dimensions of one row>
+ *     blockRows <rows per block>
+ *     maxBlocks <blocks the file holds at most, 0 for no limit>
+ *     valueDimensionsColumns <0 unless variable-size>
+ *     headerBytes <offset of the first block>
+ *
+ *   The blocks follow (see rt_GetSpoolPartOffset); only whole blocks hold
+ *   valid rows. When maxBlocks is not 0, the oldest block is the one at
+ *   index firstBlock % maxBlocks (see rt_GetSpoolBlockOffset); firstBlock is
+ *   updated in place, at RT_SPOOL_FIRST_BLOCK_POS, before a block is
+ *   overwritten. Return 0 on success.
  */
-const char_T *rt_UpdateLogVarWithDiscontiguousData(LogVar                 *var,
-                                             int8_T**               data,
-                                             const int_T            *segmentLengths,
-                                             int_T                  nSegments,
-                                             RTWPreprocessingFcnPtr *preprocessingPtrs)
-{
-    size_t elSize = 0;
-    size_t offset = 0;
-    int    segIdx = 0;
-
-    if (++var->numHits % var->decimation) return(NULL);
-    var->numHits = 0;
+#define RT_SPOOL_FIRST_BLOCK_POS  27L   /* after "RTW_LOG_SPOOL 1\nfirstBlock " */
 
-    /*
-     * Reallocate or wrap the LogVar
-     */
-    if (var->rowIdx == var->data.nRows) {
-        if (var->okayToRealloc == 1) {
-            rt_ReallocLogVar(var, false);
-        } else {
-            /* Circular buffer */
-            var->rowIdx = 0;
-            ++(var->wrapped); /* increment the wrap around counter */
-        }
+static int_T rt_WriteSpoolHeader(LogVar *var)
+{
+    const uint16_T one      = 1U;
+    int_T          nValDims = (var->valDims != NULL &&
+                               var->valDims->dimsData != NULL) ?
+                              var->valDims->nCols : 0;
+    size_t         maxBytes = 512 + mxMAXNAM + 12*var->data.nDims;
+    char_T         *hdr     = malloc(maxBytes + LOGGING_SPOOL_HEADER_ALIGN);
+    size_t         n;
+    int_T          i;
+    int_T          retStat  = 1;
+
+    if (hdr == NULL) return(1);
+
+    n = (size_t)sprintf(hdr,
+                        "RTW_LOG_SPOOL 1\n"
+                        "firstBlock %010d\n"
+                        "name %s\n"
+                        "mxClass %d\n"
+                        "elementSize %lu\n"
+                        "complex %d\n"
+                        "logical %d\n"
+                        "byteOrder %s\n"
+                        "columns %d\n"
+                        "dims",
+                        (int)var->spoolFirstBlock,
+                        var->data.name, (int)var->data.mxID,
+                        (unsigned long)var->data.elSize,
+                        (int)var->data.complex, (int)var->data.logical,
+                        (*(const char *)&one == 1) ? "little" : "big",
+                        (int)var->data.nCols);
+    for (i = 0; i < var->data.nDims; i++) {
+        n += (size_t)sprintf(hdr + n, " %d", (int)var->data.dims[i]);
+    }
+    n += (size_t)sprintf(hdr + n,
+                         "\n"
+                         "blockRows %d\n"
+                         "maxBlocks %d\n"
+                         "valueDimensionsColumns %d\n"
+                         "headerBytes ",
+                         (int)var->spoolBlockRows, (int)var->spoolMaxBlocks,
+                         (int)nValDims);
+
+    /* headerBytes is the padded size of the header, counting its own digits */
+    {
+        size_t total = n + 12;
+        total = (total + LOGGING_SPOOL_HEADER_ALIGN - 1) /
+                LOGGING_SPOOL_HEADER_ALIGN * LOGGING_SPOOL_HEADER_ALIGN;
+        n += (size_t)sprintf(hdr + n, "%lu", (unsigned long)total);
+        (void)memset(hdr + n, ' ', total - n);
+        hdr[total-1] = '\n';
+        var->spoolHeaderBytes = (int_T)total;
     }
 
-    /* This function is only used to log states, there's no var-dims issue. */
-    elSize = var->data.elSize;
-    offset = (size_t)(elSize * var->rowIdx * var->data.nCols);
+    if (fwrite(hdr, 1, (size_t)var->spoolHeaderBytes, var->spool) ==
+        (size_t)var->spoolHeaderBytes) {
+        retStat = 0;
+    }
+    free(hdr);
+    return(retStat);
 
-    if (var->data.complex) {
-        char_T *dstRe = (char_T*)(var->data.re) + offset;
-        char_T *dstIm = (char_T*)(var->data.im) + offset;
+} /* end rt_WriteSpoolHeader */
 
-        for (segIdx = 0; segIdx < nSegments; segIdx++) {
-            int_T         nEl  = segmentLengths[segIdx];
-            char_T *src        = (char_T *)data[segIdx];
-            int_T         el;
 
-            /* preprocess data in-place before logging */
-            RTWPreprocessingFcnPtr preprocessingPtr = preprocessingPtrs[segIdx];
+/* Function: rt_FlushLogVar ====================================================
+ * Abstract:
+ *   Append the full buffer of a streaming log variable to its spool file
+ *   (see rt_GetSpoolPartOffset) and start refilling the buffer. The file is
+ *   flushed so that the rows logged so far survive a crash of the model.
+ *
+ *   If the spool file cannot be written, streaming is turned off and the
+ *   log variable grows in memory from then on.
+ */
+static void rt_FlushLogVar(LogVar *var)
+{
+    static int_T spoolCount  = 0;
+    size_t       rowBytes    = var->data.nCols * var->data.elSize;
+    int_T        nRows       = var->nBaseRows;
+    int_T        nBlocks     = var->nSpooledRows / var->spoolBlockRows;
+    boolean_T    ok;
+
+    if (var->spool == NULL) {
+#if LOGGING_STREAM_MAX_BYTES > 0
+        double maxBlocks = (double)LOGGING_STREAM_MAX_BYTES /
+                           (double)rt_GetSpoolPartOffset(var,3);
+
+        var->spoolMaxBlocks = (maxBlocks < 1.0) ? 1 :
+            (maxBlocks > (double)INT_MAX) ? INT_MAX : (int_T)maxBlocks;
+#endif
+        if ((var->spoolName = malloc(mxMAXNAM+32)) != NULL) {
+#ifdef LOGGING_PTHREADS
+            (void)sprintf(var->spoolName, "%s_%d_rtw_tmw.tmw", var->data.name,
+                          __atomic_fetch_add(&spoolCount, 1, __ATOMIC_RELAXED));
+#else
+            (void)sprintf(var->spoolName, "%s_%d_rtw_tmw.tmw",
+                          var->data.name, spoolCount++);
+#endif
+            var->spool = fopen(var->spoolName, "w+b");
+            if (var->spool != NULL && rt_WriteSpoolHeader(var) != 0) {
+                (void)fclose(var->spool);
+                (void)remove(var->spoolName);
+                var->spool = NULL;
+            }
+        }
+    }
+
+    ok = (var->spool != NULL);
+    if (ok && var->spoolMaxBlocks > 0 && nBlocks == var->spoolMaxBlocks) {
+        /* Spool file full: overwrite the oldest block, see rt_WriteSpoolHeader */
+        char_T digits[16];
+
+        (void)sprintf(digits, "%010d", (int)(var->spoolFirstBlock + 1));
+        ok = (fseek(var->spool, RT_SPOOL_FIRST_BLOCK_POS, SEEK_SET) == 0 &&
+              fwrite(digits, 1, 10, var->spool) == 10);
+        var->spoolFirstBlock++;
+        nBlocks--;
+        /* the oldest block is gone even if it cannot be overwritten */
+        var->nSpooledRows = nBlocks * var->spoolBlockRows;
+    }
+    ok = (ok &&
+          rt_SeekSpool(var->spool, rt_GetSpoolBlockOffset(var, nBlocks)) == 0 &&
+          fwrite(var->data.re, rowBytes, nRows, var->spool) == (size_t)nRows);
+    if (ok && var->data.complex) {
+        ok = (fwrite(var->data.im, rowBytes, nRows, var->spool) ==
+              (size_t)nRows);
+    }
+    if (ok && var->valDims != NULL && var->valDims->dimsData != NULL) {
+        size_t nEl = nRows * var->valDims->nCols;
+        ok = (fwrite(var->valDims->dimsData, sizeof(real_T), nEl,
+                     var->spool) == nEl);
+    }
+    if (ok) {
+        ok = (fflush(var->spool) == 0);
+    }
+
+    if (!ok) {
+        (void)fprintf(stderr,
+                      "*** Error writing log variable %s to the file %s, "
+                      "the remaining data is kept in memory\n",
+                      var->data.name,
+                      var->spoolName != NULL ? var->spoolName : "");
+        var->streaming     = 0;
+        var->okayToRealloc = 1;
+        return;
+    }
+    var->nSpooledRows  = (nBlocks + 1) * var->spoolBlockRows;
+    var->rowIdx        = 0;
+
+} /* end rt_FlushLogVar */
+
+#endif /* LOGGING_STREAM */
+
+
+/* Function: rt_SelectLogVarRow ================================================
+ * Abstract:
+ *   Make var->rowIdx the row to be written next: grow the log variable or
+ *   wrap the circular buffer if it is full, and move currChunk to the
+ *   chunk holding the row.
+ */
+static void rt_SelectLogVarRow(LogVar *var)
+{
+    if (var->rowIdx == var->data.nRows) {
+#ifdef LOGGING_STREAM
+        if (var->streaming) {
+            rt_FlushLogVar(var);
+        }
+#endif
+        if (var->rowIdx == var->data.nRows && var->okayToRealloc == 1) {
+            rt_ReallocLogVar(var);
+        }
+        if (var->rowIdx == var->data.nRows) {
+            /* Circular buffer */
+            var->rowIdx    = 0;
+            var->currChunk = NULL;
+            ++(var->wrapped); /* increment the wrap around counter */
+#ifdef LOGGING_STATS
+            ++var->stats.nWraps;
+#endif
+        }
+    }
+    while (var->rowIdx == ((var->currChunk == NULL) ? var->nBaseRows :
+                           var->currChunk->row0 + var->currChunk->nRows)) {
+        var->currChunk = (var->currChunk == NULL) ?
+            var->chunks : var->currChunk->next;
+    }
+#ifdef LOGGING_STATS
+    {
+        size_t rowBytes = var->data.nCols * var->data.elSize;
+
+        if (var->data.complex) rowBytes *= 2;
+        if (var->valDims != NULL && var->valDims->dimsData != NULL) {
+            rowBytes += var->valDims->nCols * sizeof(real_T);
+        }
+        ++var->stats.nSamples;
+        var->stats.nBytes += (double)rowBytes;
+    }
+#endif
+
+} /* end rt_SelectLogVarRow */
+
+
+/* Function: rt_GetLogVarRow ===================================================
+ * Abstract:
+ *   Return the address of row rowIdx of the real (imagPart == 0) or the
+ *   imaginary part of the log variable.
+ */
+static char_T *rt_GetLogVarRow(const LogVar *var, int_T imagPart)
+{
+    const LogChunk *chunk    = var->currChunk;
+    size_t         rowBytes  = var->data.nCols * var->data.elSize;
+
+    if (chunk == NULL) {
+        char_T *buf = (char_T*) (imagPart ? var->data.im : var->data.re);
+        return(buf + (size_t)var->rowIdx*rowBytes);
+    } else {
+        char_T *buf = (char_T*) (imagPart ? chunk->im : chunk->re);
+        return(buf + (size_t)(var->rowIdx - chunk->row0)*rowBytes);
+    }
+
+} /* end rt_GetLogVarRow */
+
+
+/* Function: rt_GetLogVarValDims ===============================================
+ * Abstract:
+ *   Return the address of the valueDimensions entry (rowIdx, col) of a
+ *   variable-size log variable. valueDimensions is stored column-major
+ *   within the initial buffer and within each chunk.
+ */
+static real_T *rt_GetLogVarValDims(const LogVar *var, int_T col)
+{
+    const LogChunk *chunk = var->currChunk;
+
+    if (chunk == NULL) {
+        return(var->valDims->dimsData + var->rowIdx +
+               (size_t)var->nBaseRows*col);
+    } else {
+        return(chunk->dimsData + (var->rowIdx - chunk->row0) +
+               (size_t)chunk->nRows*col);
+    }
+
+} /* end rt_GetLogVarValDims */
+
+/* Function: rt_CopyLogVarRowReal ==============================================
+ * Abstract:
+ *      Copy kernel for real signals that need no conversion: the row is a
+ *      copy of the signal.
+ */
+static void rt_CopyLogVarRowReal(LogVar *var, const char_T *data, int_T frameIdx)
+{
+    (void)frameIdx;
+    (void)memcpy(rt_GetLogVarRow(var, 0), data,
+                 var->data.nCols * var->data.elSize);
+
+} /* end rt_CopyLogVarRowReal */
+
+
+/* Function: rt_CopyLogVarRowComplexDbl ========================================
+ * Abstract:
+ *      Copy kernel for complex double signals: split the interleaved signal
+ *      into the real and imaginary rows.
+ */
+static void rt_CopyLogVarRowComplexDbl(LogVar       *var,
+                                       const char_T *data,
+                                       int_T        frameIdx)
+{
+    real_T       *re   = (real_T *)rt_GetLogVarRow(var, 0);
+    real_T       *im   = (real_T *)rt_GetLogVarRow(var, 1);
+    const real_T *src  = (const real_T *)data;
+    const int_T  nCols = var->data.nCols;
+    int_T        j;
+
+    (void)frameIdx;
+    for (j = 0; j < nCols; j++) {
+        re[j] = src[2*j];
+        im[j] = src[2*j+1];
+    }
+
+} /* end rt_CopyLogVarRowComplexDbl */
+
+
+/* Function: rt_CopyLogVarRowStrided ===========================================
+ * Abstract:
+ *      Copy kernel for the other signals that need no conversion: complex
+ *      signals and frames, whose elements are pointSize bytes apart, or
+ *      frameSize points apart for frame frameIdx.
+ */
+static void rt_CopyLogVarRowStrided(LogVar       *var,
+                                    const char_T *data,
+                                    int_T        frameIdx)
+{
+    const size_t elSize    = var->data.elSize;
+    const size_t pointSize = var->data.complex ?
+        rt_GetSizeofComplexType((BuiltInDTypeId)var->data.dTypeID) : elSize;
+    const size_t stride    = pointSize * var->data.frameSize;
+    const int_T  nCols     = var->data.nCols;
+    char_T       *re       = rt_GetLogVarRow(var, 0);
+    const char_T *src      = data + frameIdx*pointSize;
+    int_T        j;
+
+    if (var->data.complex) {
+        char_T *im = rt_GetLogVarRow(var, 1);
+
+        for (j = 0; j < nCols; j++) {
+            (void)memcpy(re, src, elSize);
+            (void)memcpy(im, src + pointSize/2, elSize);
+            re  += elSize;
+            im  += elSize;
+            src += stride;
+        }
+    } else {
+        for (j = 0; j < nCols; j++) {
+            (void)memcpy(re, src, elSize);
+            re  += elSize;
+            src += stride;
+        }
+    }
+
+} /* end rt_CopyLogVarRowStrided */
+
+
+/* Function: rt_CopyLogVarRowDblToSgl ==========================================
+ * Abstract:
+ *      Copy kernel for double signals logged as single: round each element
+ *      to real32_T. Complex signals and frames are laid out as for
+ *      rt_CopyLogVarRowStrided.
+ */
+static void rt_CopyLogVarRowDblToSgl(LogVar       *var,
+                                     const char_T *data,
+                                     int_T        frameIdx)
+{
+    const size_t pointSize = var->data.complex ?
+        rt_GetSizeofComplexType(SS_DOUBLE) : sizeof(real_T);
+    const size_t stride    = pointSize * var->data.frameSize;
+    const int_T  nCols     = var->data.nCols;
+    real32_T     *re       = (real32_T *)rt_GetLogVarRow(var, 0);
+    const char_T *src      = data + frameIdx*pointSize;
+    int_T        j;
+
+    if (var->data.complex) {
+        real32_T *im = (real32_T *)rt_GetLogVarRow(var, 1);
+
+        for (j = 0; j < nCols; j++, src += stride) {
+            re[j] = (real32_T)((const real_T *)src)[0];
+            im[j] = (real32_T)((const real_T *)(src + pointSize/2))[0];
+        }
+    } else if (stride == sizeof(real_T)) {
+        const real_T *x = (const real_T *)src;
+
+        for (j = 0; j < nCols; j++) {
+            re[j] = (real32_T)x[j];
+        }
+    } else {
+        for (j = 0; j < nCols; j++, src += stride) {
+            re[j] = (real32_T)((const real_T *)src)[0];
+        }
+    }
+
+} /* end rt_CopyLogVarRowDblToSgl */
+
+
+/* Function: rt_GetLogVarCopyRowFcn ============================================
+ * Abstract:
+ *      Choose the copy kernel rt_UpdateLogVar uses for the fixed-size rows of
+ *      a log variable. Returns NULL if the data has to be converted element
+ *      by element.
+ */
+static LogVarCopyRowFcn rt_GetLogVarCopyRowFcn(const LogVar *var)
+{
+    const RTWLogDataTypeConvert *convert = &var->data.dataTypeConvertInfo;
+
+    if (convert->conversionNeeded) {
+        /* double to single without scaling, see LOGGING_DOUBLES_AS_SINGLE */
+        if (convert->dataTypeIdOriginal  == SS_DOUBLE &&
+            convert->dataTypeIdLoggingTo == SS_SINGLE &&
+            convert->numOfChunk <= 1 && convert->fracSlope == 1.0 &&
+            convert->fixedExp == 0 && convert->bias == 0.0) {
+            return(rt_CopyLogVarRowDblToSgl);
+        }
+        return(NULL);
+    }
+    if (!var->data.frameData) {
+        if (!var->data.complex) {
+            return(rt_CopyLogVarRowReal);
+        }
+        if (var->data.dTypeID == SS_DOUBLE &&
+            var->data.elSize == sizeof(real_T) &&
+            rt_GetSizeofComplexType(SS_DOUBLE) == 2*sizeof(real_T)) {
+            return(rt_CopyLogVarRowComplexDbl);
+        }
+    }
+    return(rt_CopyLogVarRowStrided);
+
+} /* end rt_GetLogVarCopyRowFcn */
+
+const char_T *rt_UpdateLogVarWithDiscontiguousData(LogVar                 *var,
+                                             int8_T**               data,
+                                             const int_T            *segmentLengths,
+                                             int_T                  nSegments,
+                                             RTWPreprocessingFcnPtr *preprocessingPtrs);
+                                             
+/* Function: rt_UpdateLogVarWithDiscontiguousData ==============================
+ * Abstract:
+ *      Log one row of the LogVar with data that is not contiguous.
+ */
+const char_T *rt_UpdateLogVarWithDiscontiguousData(LogVar                 *var,
+                                             int8_T**               data,
+                                             const int_T            *segmentLengths,
+                                             int_T                  nSegments,
+                                             RTWPreprocessingFcnPtr *preprocessingPtrs)
+{
+    size_t elSize = 0;
+    int    segIdx = 0;
+
+    if (++var->numHits % var->decimation) return(NULL);
+    var->numHits = 0;
+
+    /*
+     * Reallocate or wrap the LogVar
+     */
+    rt_SelectLogVarRow(var);
+
+    /* This function is only used to log states, there's no var-dims issue. */
+    elSize = var->data.elSize;
+
+    if (var->data.complex) {
+        char_T *dstRe = rt_GetLogVarRow(var, 0);
+        char_T *dstIm = rt_GetLogVarRow(var, 1);
+
+        for (segIdx = 0; segIdx < nSegments; segIdx++) {
+            int_T         nEl  = segmentLengths[segIdx];
+            char_T *src        = (char_T *)data[segIdx];
+            int_T         el;
+
+            /* preprocess data in-place before logging */
+            RTWPreprocessingFcnPtr preprocessingPtr = preprocessingPtrs[segIdx];
             if (preprocessingPtr != NULL) {
                 src = malloc(elSize * nEl * 2);
                 preprocessingPtr(src, (void *)data[segIdx]);
@@ -2603,7 +3919,7 @@ const char_T *rt_UpdateLogVarWithDiscontiguousData(LogVar                 *var,
             }
         }
     } else {
-        char_T *dst = (char_T*)(var->data.re) + offset;
+        char_T *dst = rt_GetLogVarRow(var, 0);
 
         for (segIdx = 0; segIdx < nSegments; segIdx++) {
             size_t      segSize = elSize*segmentLengths[segIdx];
@@ -2637,6 +3953,90 @@ const char_T *rt_UpdateLogVarWithDiscontiguousData(LogVar                 *var,
 } /* end rt_UpdateLogVarWithDiscontiguousData */
 
 
+/* Function: rt_BuildGatherPlan ================================================
+ * Abstract:
+ *      Build the gather plan of nSegments segments of elBytes byte elements
+ *      (see LogGatherPlan). Return NULL if out of memory.
+ */
+static LogGatherPlan *rt_BuildGatherPlan(int8_T                 **segAddr,
+                                         const int_T            *segLengths,
+                                         int_T                  nSegments,
+                                         RTWPreprocessingFcnPtr *preprocessingPtrs,
+                                         size_t                 elBytes)
+{
+    LogGatherPlan *plan;
+    LogGatherRun  *run = NULL;
+    int_T         segIdx;
+
+    if ((plan = calloc(1, sizeof(LogGatherPlan))) == NULL) return(NULL);
+    if (nSegments > 0 &&
+        (plan->runs = malloc(nSegments*sizeof(LogGatherRun))) == NULL) {
+        free(plan);
+        return(NULL);
+    }
+
+    for (segIdx = 0; segIdx < nSegments; segIdx++) {
+        size_t                 segBytes   = segLengths[segIdx]*elBytes;
+        RTWPreprocessingFcnPtr preprocess = (preprocessingPtrs != NULL) ?
+            preprocessingPtrs[segIdx] : NULL;
+
+        if (segBytes == 0) continue;
+        if (run != NULL && run->preprocess == NULL && preprocess == NULL &&
+            run->src + run->nBytes == segAddr[segIdx]) {
+            run->nBytes += segBytes;
+        } else {
+            run             = &plan->runs[plan->nRuns++];
+            run->src        = segAddr[segIdx];
+            run->nBytes     = segBytes;
+            run->dstOffset  = plan->nBytes;
+            run->preprocess = preprocess;
+        }
+        plan->nBytes += segBytes;
+        plan->nEl    += segLengths[segIdx];
+    }
+    return(plan);
+
+} /* end rt_BuildGatherPlan */
+
+
+/* Function: rt_RunGatherPlan ==================================================
+ * Abstract:
+ *      Gather the runs of the plan into the row at dst.
+ */
+static void rt_RunGatherPlan(const LogGatherPlan *plan, char_T *dst)
+{
+    const LogGatherRun *run = plan->runs;
+    const LogGatherRun *end = run + plan->nRuns;
+
+    for (; run < end; run++) {
+        if (run->preprocess != NULL) {
+            run->preprocess(dst + run->dstOffset, run->src);
+        } else {
+            (void)memcpy(dst + run->dstOffset, run->src, run->nBytes);
+        }
+    }
+
+} /* end rt_RunGatherPlan */
+
+
+/* Function: rt_UpdateLogVarWithGatherPlan =====================================
+ * Abstract:
+ *      Log one row of a real LogVar gathered with a plan, which takes the
+ *      place of rt_UpdateLogVarWithDiscontiguousData for the states.
+ */
+static void rt_UpdateLogVarWithGatherPlan(LogVar              *var,
+                                          const LogGatherPlan *plan)
+{
+    if (++var->numHits % var->decimation) return;
+    var->numHits = 0;
+
+    rt_SelectLogVarRow(var);
+    rt_RunGatherPlan(plan, rt_GetLogVarRow(var, 0));
+    ++var->rowIdx;
+
+} /* end rt_UpdateLogVarWithGatherPlan */
+
+
 /*==================*
  * Visible routines *
  *==================*/
@@ -2648,7 +4048,7 @@ extern "C" {
 #endif
 
  
-/* Function: rt_CreateLogVarWithConvert ========================================
+/* Function: local_CreateLogVar ================================================
  * Abstract:
  *	Create a logging variable.
  *
@@ -2656,7 +4056,7 @@ extern "C" {
  *	~= NULL  => success, returns the log variable created.
  *	== NULL  => failure, error message set in the simstruct.
  */
-LogVar *rt_CreateLogVarWithConvert(
+static LogVar *local_CreateLogVar(
     RTWLogInfo        *li,
     const real_T      startTime,
     const real_T      finalTime,
@@ -2685,6 +4085,7 @@ LogVar *rt_CreateLogVarWithConvert(
 #else
     int_T          okayToRealloc       = 1;
 #endif
+    int_T          streaming           = 0;
     LogVar         *var                = NULL;
     /*inpDataTypeID is the rt_LoggedOutputDataTypeId*/
     BuiltInDTypeId dTypeID             = (BuiltInDTypeId)inpDataTypeID; 
@@ -2779,8 +4180,10 @@ LogVar *rt_CreateLogVarWithConvert(
             usingDefaultBufSize = 1;
             nRows = DEFAULT_BUFFER_SIZE;
             okayToRealloc = 0;  /* No realloc with infinite stop time */
+#ifndef LOGGING_STREAM
             (void)fprintf(stdout, "*** Using a default buffer of size %d for "
                           "logging variable %s\n", nRows, varName);
+#endif
         }
     }
 
@@ -2793,6 +4196,43 @@ LogVar *rt_CreateLogVarWithConvert(
      */
     nColumns = frameData ? dims[1] : nCols;
 
+#ifdef LOGGING_STREAM
+    /*
+     * Unless the user limited the number of rows, hold a block of at least
+     * DEFAULT_BUFFER_SIZE rows, but at most LOGGING_STREAM_BLOCK_BYTES, in
+     * memory and flush it to disk each time it fills up (rt_FlushLogVar).
+     */
+    if (okayToRealloc || usingDefaultBufSize) {
+        size_t rowBytes  = elementSize*nColumns;
+        int_T  blockRows = (rowBytes > 0 &&
+                            rowBytes < LOGGING_STREAM_BLOCK_BYTES) ?
+            (int_T)(LOGGING_STREAM_BLOCK_BYTES/rowBytes) : 1;
+
+        if (nRows < DEFAULT_BUFFER_SIZE) {
+            nRows = DEFAULT_BUFFER_SIZE;
+        }
+        if (nRows > blockRows) {
+            nRows = blockRows;
+        }
+        if (usingDefaultBufSize) {
+            /* Infinite stop time: only LOGGING_STREAM_MAX_BYTES bounds it */
+#if LOGGING_STREAM_MAX_BYTES > 0
+            (void)fprintf(stdout, "*** Streaming logging variable %s to disk, "
+                          "keeping its last %.0f bytes\n", varName,
+                          (double)LOGGING_STREAM_MAX_BYTES);
+#else
+            (void)fprintf(stdout, "*** Streaming logging variable %s to disk "
+                          "without a size limit (infinite stop time)\n"
+                          "    define LOGGING_STREAM_MAX_BYTES to keep only "
+                          "its last rows\n", varName);
+#endif
+        }
+        streaming           = 1;
+        okayToRealloc       = 0;
+        usingDefaultBufSize = 0;
+    }
+#endif
+
     /*
      * Error out if the size of the circular buffer is absurdly large, this
      * error message is more informative than the one we get when we try to
@@ -2898,6 +4338,7 @@ LogVar *rt_CreateLogVarWithConvert(
     var->data.complex         = (complex)   ? matCOMPLEX_BIT : 0x0;
     var->data.frameData       = frameData;
     var->data.frameSize       = (frameData) ? frameSize : 1;
+    var->copyRow              = rt_GetLogVarCopyRowFcn(var);
 
     /* fill up valDims field */
     if(logValDimsStat == NO_LOGVALDIMS){
@@ -2979,6 +4420,9 @@ LogVar *rt_CreateLogVarWithConvert(
         }
     }
 
+    var->nBaseRows            = nRows;
+    var->streaming            = streaming;
+    var->spoolBlockRows       = nRows;
     var->rowIdx               = 0;
     var->wrapped              = 0;
     var->nDataPoints          = 0;
@@ -3010,6 +4454,70 @@ LogVar *rt_CreateLogVarWithConvert(
     rt_DestroyLogVar(var);
     return(NULL);
 
+} /* end local_CreateLogVar */
+
+
+/* Function: rt_CreateLogVarWithConvert ========================================
+ * Abstract:
+ *	Create a logging variable, of single instead of double with
+ *      LOGGING_DOUBLES_AS_SINGLE.
+ *
+ * Returns:
+ *	~= NULL  => success, returns the log variable created.
+ *	== NULL  => failure, error message set in the simstruct.
+ */
+LogVar *rt_CreateLogVarWithConvert(
+    RTWLogInfo        *li,
+    const real_T      startTime,
+    const real_T      finalTime,
+    const real_T      inStepSize,
+    const char_T      **errStatus,
+    const char_T      *varName,
+    BuiltInDTypeId    inpDataTypeID,
+    const RTWLogDataTypeConvert *pDataTypeConvertInfo,
+    int_T             logical,
+    int_T             complex,
+    int_T             frameData,
+    int_T             nCols,
+    int_T             nDims,
+    const int_T       *dims,
+    LogValDimsStat    logValDimsStat,
+    void              **currSigDims,
+    int_T             *currSigDimsSize,
+    int_T             maxRows,
+    int_T             decimation,
+    real_T            sampleTime,
+    int_T             appendToLogVarsList)
+{
+#ifdef LOGGING_DOUBLES_AS_SINGLE
+    RTWLogDataTypeConvert singleConvertInfo;
+
+    pDataTypeConvertInfo = rt_GetSingleConvertInfo(&inpDataTypeID,
+                                                   pDataTypeConvertInfo,
+                                                   &singleConvertInfo);
+#endif
+    return(local_CreateLogVar(li,
+                              startTime,
+                              finalTime,
+                              inStepSize,
+                              errStatus,
+                              varName,
+                              inpDataTypeID,
+                              pDataTypeConvertInfo,
+                              logical,
+                              complex,
+                              frameData,
+                              nCols,
+                              nDims,
+                              dims,
+                              logValDimsStat,
+                              currSigDims,
+                              currSigDimsSize,
+                              maxRows,
+                              decimation,
+                              sampleTime,
+                              appendToLogVarsList));
+
 } /* end rt_CreateLogVarWithConvert */
 
 
@@ -3126,7 +4634,8 @@ StructLogVar *rt_CreateStructLogVar(RTWLogInfo              *li,
                                      decimation,
                                      sampleTime,
                                      sigInfo,
-                                     blockName));
+                                     blockName,
+                                     false));
 
 } /* end rt_CreateStructLogVar */
 
@@ -3180,14 +4689,14 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
     varName = rtliGetLogT(li);
     if (varName[0] != '\0') {
         int_T dims = 1;
-        logInfo->t = rt_CreateLogVarWithConvert(li, startTime, finalTime,
-                                                stepSize, errStatus,
-                                                varName,SS_DOUBLE,
-                                                NULL,
-                                                0,0,0,1,1,
-                                                &dims, NO_LOGVALDIMS, NULL, NULL,
-                                                maxRows,decimation,
-                                                sampleTime,1);
+        logInfo->t = local_CreateLogVar(li, startTime, finalTime,
+                                        stepSize, errStatus,
+                                        varName,SS_DOUBLE,
+                                        NULL,
+                                        0,0,0,1,1,
+                                        &dims, NO_LOGVALDIMS, NULL, NULL,
+                                        maxRows,decimation,
+                                        sampleTime,1);
         if (logInfo->t == NULL) goto ERROR_EXIT;
     }
 
@@ -3223,25 +4732,25 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
             pDTConvInfo = xInfo[0].dataTypeConvert;
 
             if (rtliGetLogX(li)[0] != '\0') {
-                logInfo->x = rt_CreateLogVarWithConvert(li, startTime, finalTime,
-                                                        stepSize, errStatus,
-                                                        rtliGetLogX(li),dataType,
-                                                        pDTConvInfo,
-                                                        0,
-                                                        isComplex,0,numCols,nDims,dims,
-                                                        NO_LOGVALDIMS, NULL, NULL,
-                                                        maxRows,decimation,sampleTime,1);
+                logInfo->x = local_CreateLogVar(li, startTime, finalTime,
+                                                stepSize, errStatus,
+                                                rtliGetLogX(li),dataType,
+                                                pDTConvInfo,
+                                                0,
+                                                isComplex,0,numCols,nDims,dims,
+                                                NO_LOGVALDIMS, NULL, NULL,
+                                                maxRows,decimation,sampleTime,1);
                 if (logInfo->x == NULL)  goto ERROR_EXIT;
             }
             if (rtliGetLogXFinal(li)[0] != '\0') {
-                logInfo->xFinal = rt_CreateLogVarWithConvert(li, startTime, finalTime,
-                                                             stepSize, errStatus,
-                                                             rtliGetLogXFinal(li),dataType,
-                                                             pDTConvInfo,
-                                                             0,isComplex,0,numCols,nDims,
-                                                             dims, NO_LOGVALDIMS, NULL, 
-                                                             NULL, 1,decimation,
-                                                             sampleTime,1);
+                logInfo->xFinal = local_CreateLogVar(li, startTime, finalTime,
+                                                     stepSize, errStatus,
+                                                     rtliGetLogXFinal(li),dataType,
+                                                     pDTConvInfo,
+                                                     0,isComplex,0,numCols,nDims,
+                                                     dims, NO_LOGVALDIMS, NULL, 
+                                                     NULL, 1,decimation,
+                                                     sampleTime,1);
                 if (logInfo->xFinal == NULL)  goto ERROR_EXIT;
             }
         } else {                                          /* Structure Format */
@@ -3250,7 +4759,8 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
                                                       stepSize, errStatus,
                                                       rtliGetLogX(li), logTime,
                                                       maxRows, decimation,
-                                                      sampleTime, xInfo, NULL);
+                                                      sampleTime, xInfo, NULL,
+                                                      true);
                 if (logInfo->x == NULL) goto ERROR_EXIT;
             }
             if (rtliGetLogXFinal(li)[0] != '\0') {
@@ -3258,7 +4768,8 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
                                                            stepSize, errStatus,
                                                            rtliGetLogXFinal(li),
                                                            logTime,1,decimation,
-                                                           sampleTime,xInfo,NULL);
+                                                           sampleTime,xInfo,NULL,
+                                                           true);
                 if (logInfo->xFinal == NULL) goto ERROR_EXIT;
             }
         }
@@ -3269,6 +4780,10 @@ const char_T *rt_StartDataLoggingWithStartTime(RTWLogInfo   *li,
                                               stepSize,errStatus);
     if (*errStatus != NULL)  goto ERROR_EXIT;
 
+#ifdef LOGGING_PTHREADS
+    rt_StartLogRing(li);
+#endif
+
     return(NULL); /* NORMAL_EXIT */
 
  ERROR_EXIT:
@@ -3329,11 +4844,15 @@ extern "C" {
 #endif
 
  
-/* Function: rt_UpdateLogVar ===================================================
+/* Function: rt_UpdateLogVarWithDims ==========================================
  * Abstract:
- *	Called to log data for a log variable.
+ *	Log data for a log variable, taking the current dimensions of a
+ *      variable-size signal from currSigDims (see rt_UpdateLogVar).
  */
-void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
+static void rt_UpdateLogVarWithDims(LogVar      *var,
+                                    const void  *data,
+                                    boolean_T   isVarDims,
+                                    void *const *currSigDims)
 {
     size_t        elSize    = var->data.elSize;
     const  char_T *cData    = data;
@@ -3342,7 +4861,6 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
     const  int_T  logWidth  = var->data.nCols;
     BuiltInDTypeId dTypeID  = var->data.dTypeID;
 
-    size_t offset        = 0;
     char_T *currRealRow  = NULL;
     char_T *currImagRow  = NULL;
     int_T  pointSize     = (int_T)((var->data.complex) ? rt_GetSizeofComplexType(dTypeID) : elSize);
@@ -3358,32 +4876,26 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
 
     /* The following variables will be used for 
        logging "valueDimensions" field */
-    size_t offset_valDims   = 0;
-    char_T *currValDimsRow  = NULL;
-    size_t elSize_valDims   = sizeof(real_T);
     real_T currentSigDims   = 0;
-    int_T  nRows_valDims    = 0;
     int_T  logWidth_valDims = 0;
 
     for (i = 0; i < frameSize; i++) {
         if (++var->numHits % var->decimation) continue;
         var->numHits = 0;
 
-        if (var->rowIdx == var->data.nRows) {
-            if (var->okayToRealloc == 1) {
-                rt_ReallocLogVar(var, isVarDims);
-            } else {
-                /* Circular buffer */
-                var->rowIdx = 0;
-                ++(var->wrapped); /* increment the wrap around counter */
-            }
+        rt_SelectLogVarRow(var);
+
+        /* fixed-size rows that need no conversion */
+        if (!isVarDims && var->copyRow != NULL) {
+            var->copyRow(var, cData, i);
+            ++var->rowIdx;
+            continue;
         }
 
         if(isVarDims){
-            currDimsPtr = (const void * const *) var->valDims->currSigDims;
+            currDimsPtr = (const void * const *) currSigDims;
             currDimsSizePtr = (const int_T*) var->valDims->currSigDimsSize;
             logWidth_valDims = frameData ? 1 : var->valDims->nCols;
-            nRows_valDims = var->valDims->nRows;
 
             var->strides[0] = 1;
             var->currStrides[0] = 1;
@@ -3406,10 +4918,8 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
             }
         }
 
-        offset       = (size_t)(elSize * var->rowIdx * logWidth);
-        currRealRow  = ((char_T*) (var->data.re)) + offset;
-        currImagRow  = (var->data.complex) ?
-                       ((char_T*) (var->data.im)) + offset :  NULL;
+        currRealRow  = rt_GetLogVarRow(var, 0);
+        currImagRow  = (var->data.complex) ? rt_GetLogVarRow(var, 1) : NULL;
 
         /* update logging data */
         for (j = 0; j < logWidth; j++) {
@@ -3786,13 +5296,9 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
                     currDimsVal = (**(((const uint32_T * const *) currDimsPtr)+j));
                     break;
                 }
-                offset_valDims  = (size_t)(elSize_valDims *( var->rowIdx + nRows_valDims * j));
-                currValDimsRow  = ((char_T*) (var->valDims->dimsData)) + offset_valDims;
-
                 /* convert int_T to real_T */
                 currentSigDims = (real_T) currDimsVal;
-                (void) memcpy(currValDimsRow, &currentSigDims, elSize_valDims);
-                currValDimsRow += elSize_valDims;
+                *rt_GetLogVarValDims(var, j) = currentSigDims;
             }
         }
         
@@ -3801,6 +5307,18 @@ void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
 
     return;
 
+} /* end rt_UpdateLogVarWithDims */
+
+
+/* Function: rt_UpdateLogVar ===================================================
+ * Abstract:
+ *	Called to log data for a log variable.
+ */
+void rt_UpdateLogVar(LogVar *var, const void *data, boolean_T isVarDims)
+{
+    rt_UpdateLogVarWithDims(var, data, isVarDims,
+                            isVarDims ? var->valDims->currSigDims : NULL);
+
 } /* end rt_UpdateLogVar */
 
 
@@ -3816,14 +5334,79 @@ extern "C" {
 #endif
  
  
-/* Function: rt_UpdateStructLogVar =============================================
+/* Function: rt_GetLogVarSourcePointSize =======================================
  * Abstract:
- *      Called to log data for a structure log variable.
+ *      Return the size of one (complex) element of the signal data
+ *      rt_UpdateLogVar reads, which differs from the logged element when the
+ *      data is converted.
  */
-void rt_UpdateStructLogVar(StructLogVar *var, const real_T *t, const void *data)
+static size_t rt_GetLogVarSourcePointSize(const LogVar *var)
 {
-    LogVar       *values = var->signals.values;
-    const char_T *signal = data;
+    const RTWLogDataTypeConvert *convert = &var->data.dataTypeConvertInfo;
+
+    if (!convert->conversionNeeded) {
+        return(var->data.complex ?
+               rt_GetSizeofComplexType((BuiltInDTypeId)var->data.dTypeID) :
+               var->data.elSize);
+    } else if (convert->numOfChunk > 1) {
+        return((size_t)(convert->bitsPerChunk*convert->numOfChunk/8) *
+               (var->data.complex ? 2 : 1));
+    } else {
+        BuiltInDTypeId dTypeID = (BuiltInDTypeId)convert->dataTypeIdOriginal;
+
+        return(var->data.complex ?
+               rt_GetSizeofComplexType(dTypeID) : rt_GetSizeofDataType(dTypeID));
+    }
+
+} /* end rt_GetLogVarSourcePointSize */
+
+
+/* Function: rt_BuildStructLogVarPlan ========================================
+ * Abstract:
+ *      Resolve the signals of a structure log variable once: their LogVars
+ *      as an array and the offset of each in the data passed to
+ *      rt_UpdateStructLogVar. Return false if out of memory.
+ */
+static boolean_T rt_BuildStructLogVarPlan(StructLogVar *var)
+{
+    int_T  nsig   = var->signals.numSignals;
+    LogVar *values = var->signals.values;
+    size_t offset = 0;
+    int_T  i;
+
+    if (nsig <= 0) return(false);
+    var->valueVars    = malloc(nsig*sizeof(LogVar *));
+    var->valueOffsets = malloc(nsig*sizeof(size_t));
+    if (var->valueVars != NULL && var->valueOffsets != NULL) {
+        for (i = 0; i < nsig && values != NULL; i++) {
+            var->valueVars[i]    = values;
+            var->valueOffsets[i] = offset;
+            offset += rt_GetLogVarSourcePointSize(values) * values->data.nCols;
+            values  = values->next;
+        }
+        if (i == nsig && values == NULL) return(true);
+    }
+
+    /* out of memory, or numSignals is not the length of the list */
+    FREE(var->valueVars);
+    FREE(var->valueOffsets);
+    var->valueVars    = NULL;
+    var->valueOffsets = NULL;
+    return(false);
+
+} /* end rt_BuildStructLogVarPlan */
+
+
+/* Function: rt_UpdateStructLogVar =============================================
+ * Abstract:
+ *      Called to log data for a structure log variable. The signals are
+ *      resolved by the first call (rt_BuildStructLogVarPlan), after which
+ *      each call only walks the arrays.
+ */
+void rt_UpdateStructLogVar(StructLogVar *var, const real_T *t, const void *data)
+{
+    LogVar       *values = var->signals.values;
+    const char_T *signal = data;
     boolean_T *isVarDims = var->signals.isVarDims;
     int i = 0;
 
@@ -3833,13 +5416,20 @@ void rt_UpdateStructLogVar(StructLogVar *var, const real_T *t, const void *data)
     }
 
     /* signals */
-    while (values) {
-        size_t elSz = values->data.elSize;
+    if (var->valueVars != NULL || rt_BuildStructLogVarPlan(var)) {
+        LogVar       **vars    = var->valueVars;
+        const size_t *offsets  = var->valueOffsets;
+        const int_T  nsig      = var->signals.numSignals;
 
+        for (i = 0; i < nsig; i++) {
+            rt_UpdateLogVar(vars[i], signal + offsets[i], isVarDims[i]);
+        }
+        return;
+    }
+    while (values) {
         rt_UpdateLogVar(values, signal, isVarDims[i]);
 
-        if (values->data.complex) elSz *= 2;
-        signal += elSz * values->data.nCols;
+        signal += rt_GetLogVarSourcePointSize(values) * values->data.nCols;
 
         values = values->next;
         i++;
@@ -3863,9 +5453,7 @@ extern "C" {
  * g1614989:Refactoring this function to accept number of elements
  *          instead of accepting signalInfo and index.
  */
-void* rt_getTempMemory(LogVar* var, int_T numEls);
-
-void* rt_getTempMemory(LogVar* var, int_T numEls)
+static size_t rt_GetTempMemorySize(const LogVar* var, int_T numEls)
 {
     size_t elSize  = var->data.elSize;
     size_t cmplxMult = var->data.complex ? 2 : 1;
@@ -3875,7 +5463,19 @@ void* rt_getTempMemory(LogVar* var, int_T numEls)
      * chunks that each multi word contains.
      */
     size_t numOfChunks = var->data.dataTypeConvertInfo.conversionNeeded ? var->data.dataTypeConvertInfo.numOfChunk : 1;
-    void* tempMemory = malloc(elSize * numEls * cmplxMult * numOfChunks);
+    /* a double logged as single is pre-processed before it is converted */
+    if (var->data.dataTypeConvertInfo.conversionNeeded &&
+        var->data.dataTypeConvertInfo.dataTypeIdOriginal == SS_DOUBLE) {
+        elSize = sizeof(real_T);
+    }
+    return elSize * numEls * cmplxMult * numOfChunks;
+}
+
+void* rt_getTempMemory(LogVar* var, int_T numEls);
+
+void* rt_getTempMemory(LogVar* var, int_T numEls)
+{
+    void* tempMemory = malloc(rt_GetTempMemorySize(var, numEls));
     return tempMemory;
 }
 
@@ -3921,21 +5521,201 @@ void rt_preProcessAndLogData(RTWLogSignalInfo signalInfo, LogVar* val, const voi
 {
     rt_preProcessAndLogDataWithIndex(&signalInfo, -1, val, data, isVarDims);
 }
- 
-/* Function: rt_UpdateTXYLogVars ===============================================
+
+#ifdef LOGGING_SNAPSHOTS
+/* Function: rt_GetLogVarSourceBytes ===========================================
  * Abstract:
- *	Update the xFinal,T,X,Y variables that are being logged.
+ *      Return the number of bytes of signal data rt_UpdateLogVar reads.
  */
-const char_T *rt_UpdateTXYLogVars(RTWLogInfo *li, time_T *tPtr)
+static size_t rt_GetLogVarSourceBytes(const LogVar *var)
 {
-    return rt_UpdateTXXFYLogVars(li, tPtr, true);
-}
+    size_t nPoints = (size_t)var->data.nCols *
+        (var->data.frameData ? var->data.frameSize : 1);
+
+    return(nPoints*rt_GetLogVarSourcePointSize(var));
+
+} /* end rt_GetLogVarSourceBytes */
+#endif
+
+
+/* Function: rt_LogTXYSignal ===================================================
+ * Abstract:
+ *      Log one signal of the T,X,Y variables, pre-processing it if signalInfo
+ *      has a function for it (see rt_preProcessAndLogDataWithIndex).
+ *
+ *      With a snapshot, the signal data and, for a variable-size signal, its
+ *      current dimensions are instead copied into the snapshot, or logged
+ *      from the copy in it.
+ */
+static void rt_LogTXYSignal(LogSnapshot            *snap,
+                            const RTWLogSignalInfo *signalInfo,
+                            int_T                  idx,
+                            LogVar                 *var,
+                            const void             *data,
+                            boolean_T              isVarDims)
+{
+#ifdef LOGGING_SNAPSHOTS
+    RTWPreprocessingFcnPtr preprocessingPtr = NULL;
+    const int_T            nDims            = var->data.nDims;
+    size_t                 nBytes;
+    size_t                 dataBytes;
+    size_t                 ptrBytes         = 0;
+    char_T                 *dst;
+    int_T                  k;
+#endif
+
+    if (snap == NULL) {
+        if (signalInfo == NULL) {
+            rt_UpdateLogVar(var, data, isVarDims);
+        } else {
+            rt_preProcessAndLogDataWithIndex(signalInfo, idx, var, data,
+                                             isVarDims);
+        }
+        return;
+    }
+
+#ifdef LOGGING_SNAPSHOTS
+    if (signalInfo != NULL) {
+        preprocessingPtr = (idx == -1) ? *(signalInfo->preprocessingPtrs) :
+            signalInfo->preprocessingPtrs[idx];
+    }
+    if (preprocessingPtr != NULL) {
+        int_T numEls = (idx == -1) ? *(signalInfo->numCols) :
+            signalInfo->numCols[idx];
+        nBytes = rt_GetTempMemorySize(var, numEls);
+    } else {
+        nBytes = rt_GetLogVarSourceBytes(var);
+    }
+    dataBytes = LOG_SNAPSHOT_ALIGN(nBytes);
+
+    /* the current dimensions are kept as pointers followed by the values */
+    if (isVarDims) {
+        ptrBytes = LOG_SNAPSHOT_ALIGN(nDims*sizeof(void *));
+    }
+
+    dst = (snap->base != NULL) ? snap->base + snap->offset : NULL;
+    snap->offset += dataBytes +
+        (isVarDims ? ptrBytes + nDims*sizeof(real_T) : 0);
+
+    if (snap->mode == LOG_SNAPSHOT_CAPTURE) {
+        if (preprocessingPtr != NULL) {
+            preprocessingPtr(dst, data);
+        } else {
+            (void)memcpy(dst, data, nBytes);
+        }
+        if (isVarDims) {
+            char_T *dimsVal = dst + dataBytes + ptrBytes;
+            for (k = 0; k < nDims; k++) {
+                (void)memcpy(dimsVal + k*sizeof(real_T),
+                             var->valDims->currSigDims[k],
+                             var->valDims->currSigDimsSize[k]);
+            }
+        }
+    } else if (snap->mode == LOG_SNAPSHOT_REPLAY) {
+        void **dimsPtr = NULL;
+
+        if (isVarDims) {
+            dimsPtr = (void **)(dst + dataBytes);
+            for (k = 0; k < nDims; k++) {
+                dimsPtr[k] = dst + dataBytes + ptrBytes + k*sizeof(real_T);
+            }
+        }
+        rt_UpdateLogVarWithDims(var, dst, isVarDims, dimsPtr);
+    }
+#endif
+
+} /* end rt_LogTXYSignal */
+
+
+/* Function: rt_LogTXYStates ===================================================
+ * Abstract:
+ *      Log the states of a matrix format log variable. The segments are
+ *      gathered with the plan of the states (see LogGatherPlan), which is
+ *      built by the first call; complex states, or states without a plan,
+ *      are logged with rt_UpdateLogVarWithDiscontiguousData. With a
+ *      snapshot, the segments are instead gathered one after the other into
+ *      the snapshot, or logged as one segment from the copy in it.
+ */
+static const char_T *rt_LogTXYStates(LogSnapshot            *snap,
+                                     LogInfo                *logInfo,
+                                     LogVar                 *var,
+                                     int8_T                 **segAddr,
+                                     const int_T            *segLengths,
+                                     int_T                  nSegments,
+                                     RTWPreprocessingFcnPtr *preprocessingPtrs)
+{
+    size_t elBytes = var->data.elSize * (var->data.complex ? 2 : 1);
+#ifdef LOGGING_SNAPSHOTS
+    char_T *dst;
+#endif
+
+    if (logInfo->xPlan == NULL && !logInfo->xPlanFailed &&
+        (snap == NULL || snap->mode != LOG_SNAPSHOT_REPLAY)) {
+        logInfo->xPlan = rt_BuildGatherPlan(segAddr, segLengths, nSegments,
+                                            preprocessingPtrs, elBytes);
+        logInfo->xPlanFailed = (logInfo->xPlan == NULL);
+    }
+
+    if (snap == NULL) {
+        if (logInfo->xPlan != NULL && !var->data.complex) {
+            rt_UpdateLogVarWithGatherPlan(var, logInfo->xPlan);
+            return(NULL);
+        }
+        return(rt_UpdateLogVarWithDiscontiguousData(var, segAddr, segLengths,
+                                                    nSegments,
+                                                    preprocessingPtrs));
+    }
+
+#ifdef LOGGING_SNAPSHOTS
+    {
+        int_T nEl = 0;
+        int_T segIdx;
+
+        for (segIdx = 0; segIdx < nSegments; segIdx++) {
+            nEl += segLengths[segIdx];
+        }
+        dst = (snap->base != NULL) ? snap->base + snap->offset : NULL;
+        snap->offset += LOG_SNAPSHOT_ALIGN(nEl*elBytes);
+
+        if (snap->mode == LOG_SNAPSHOT_CAPTURE) {
+            if (logInfo->xPlan != NULL) {
+                rt_RunGatherPlan(logInfo->xPlan, dst);
+                return(NULL);
+            }
+            for (segIdx = 0; segIdx < nSegments; segIdx++) {
+                size_t segBytes = segLengths[segIdx]*elBytes;
+
+                if (preprocessingPtrs[segIdx] != NULL) {
+                    preprocessingPtrs[segIdx](dst, segAddr[segIdx]);
+                } else {
+                    (void)memcpy(dst, segAddr[segIdx], segBytes);
+                }
+                dst += segBytes;
+            }
+        } else if (snap->mode == LOG_SNAPSHOT_REPLAY) {
+            int8_T                 *src              = (int8_T *)dst;
+            RTWPreprocessingFcnPtr preprocessingPtr  = NULL;
+
+            return(rt_UpdateLogVarWithDiscontiguousData(var, &src, &nEl, 1,
+                                                        &preprocessingPtr));
+        }
+    }
+#endif
+    return(NULL);
+
+} /* end rt_LogTXYStates */
+
  
-/* Function: rt_UpdateTXXFYLogVars =============================================
+/* Function: rt_LogTXXFYVars ==================================================
  * Abstract:
- *	Update xFinal and/or the T,X,Y variables that are being logged
+ *	Update the parts (LOG_UPDATE_TXY and/or LOG_UPDATE_XFINAL) of the log
+ *      variables that are being logged. With a snapshot, measure, capture or
+ *      replay the signal data instead (see rt_LogTXYSignal).
  */
-const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T updateTXY)
+static const char_T *rt_LogTXXFYVars(RTWLogInfo  *li,
+                                     time_T      *tPtr,
+                                     int_T       parts,
+                                     LogSnapshot *snap)
 {
     LogInfo *logInfo     = rtliGetLogInfo(li);
     int_T   matrixFormat = (rtliGetLogFormat(li) == 0);
@@ -3943,8 +5723,8 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
     const RTWLogSignalInfo* xInfo = rtliGetLogXSignalInfo(li);
 
     /* time */
-    if (logInfo->t != NULL && updateTXY) {
-        rt_UpdateLogVar(logInfo->t, tPtr, false);
+    if (logInfo->t != NULL && (parts & LOG_UPDATE_TXY)) {
+        rt_LogTXYSignal(snap, NULL, 0, logInfo->t, tPtr, false);
     }
 
     if (matrixFormat) {                                      /* MATRIX_FORMAT */
@@ -3955,21 +5735,21 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
             int_T                  nSegments   = xInfo->numSignals;
             RTWPreprocessingFcnPtr* preprocessingPtrs = xInfo->preprocessingPtrs;
 
-            if (logInfo->x != NULL && updateTXY) {
-                const char_T *errorMessage = rt_UpdateLogVarWithDiscontiguousData(logInfo->x, segAddr,
-                                                                                  segLengths, nSegments, 
-                                                                                  preprocessingPtrs);
+            if (logInfo->x != NULL && (parts & LOG_UPDATE_TXY)) {
+                const char_T *errorMessage = rt_LogTXYStates(snap, logInfo, logInfo->x, segAddr,
+                                                             segLengths, nSegments,
+                                                             preprocessingPtrs);
                 if (errorMessage != NULL) return(errorMessage);
             }
-            if (logInfo->xFinal != NULL) {
-                const char_T *errorMessage = rt_UpdateLogVarWithDiscontiguousData(logInfo->xFinal, segAddr,
-                                                                                  segLengths, nSegments, 
-                                                                                  preprocessingPtrs);
+            if (logInfo->xFinal != NULL && (parts & LOG_UPDATE_XFINAL)) {
+                const char_T *errorMessage = rt_LogTXYStates(snap, logInfo, logInfo->xFinal, segAddr,
+                                                             segLengths, nSegments,
+                                                             preprocessingPtrs);
                 if (errorMessage != NULL) return(errorMessage);
             }
         }
         /* outputs */
-        if (logInfo->y != NULL && updateTXY) {
+        if (logInfo->y != NULL && (parts & LOG_UPDATE_TXY)) {
             LogVar **var = (LogVar**) (logInfo->y);
             int_T  ny    = logInfo->ny;
             int_T  i;
@@ -3987,14 +5767,14 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
                      *          Y Signal Info instead of iterating over preprocessing 
                      *          function pointers.
                     */ 
-                    rt_preProcessAndLogData(yInfo[yIdx], var[yIdx], data[i], false);
+                    rt_LogTXYSignal(snap, &yInfo[yIdx], -1, var[yIdx], data[i], false);
                     yIdx++;
                 }
             }
         }
     } else {                                              /* STRUCTURE_FORMAT */
         /* states */
-        if (logInfo->x != NULL && updateTXY) {
+        if (logInfo->x != NULL && (parts & LOG_UPDATE_TXY)) {
             int_T             i;
             StructLogVar      *var = logInfo->x;
             LogVar            *val = var->signals.values;
@@ -4003,7 +5783,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
 
             /* time */
             if (var->logTime) {
-                rt_UpdateLogVar(var->time, tPtr, false);
+                rt_LogTXYSignal(snap, NULL, 0, var->time, tPtr, false);
             }
 
             /* signals */
@@ -4013,13 +5793,13 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
                  *         X Signal Info instead of iterating over preprocessing 
                  *         function pointers.
                  */
-                rt_preProcessAndLogDataWithIndex(xInfo, i, val, data[i], false);
+                rt_LogTXYSignal(snap, xInfo, i, val, data[i], false);
                 val = val->next;
             }
         }
 
         /* outputs */
-        if (logInfo->y != NULL && updateTXY) {
+        if (logInfo->y != NULL && (parts & LOG_UPDATE_TXY)) {
             int_T             ny      = logInfo->ny;
             LogSignalPtrsType data    = rtliGetLogYSignalPtrs(li);
             StructLogVar      **var   = (StructLogVar**) (logInfo->y);
@@ -4033,7 +5813,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
 
                 /* time */
                 if (var[0]->logTime) {
-                    rt_UpdateLogVar(var[0]->time, tPtr, false);
+                    rt_LogTXYSignal(snap, NULL, 0, var[0]->time, tPtr, false);
                 }
 
                 /* signals */
@@ -4046,7 +5826,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
                      *         Y Signal Info instead of iterating over preprocessing 
                      *         function pointers.
                      */
-                    rt_preProcessAndLogDataWithIndex(yInfo, i, val, data[dataIdx], isVarDims[i]);
+                    rt_LogTXYSignal(snap, yInfo, i, val, data[dataIdx], isVarDims[i]);
                     dataIdx++;
                     val = val->next;
                 }
@@ -4060,7 +5840,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
 
                     /* time */
                     if (var[i]->logTime) {
-                        rt_UpdateLogVar(var[i]->time, tPtr, false);
+                        rt_LogTXYSignal(snap, NULL, 0, var[i]->time, tPtr, false);
                     }
 
                     /* signals */
@@ -4072,14 +5852,14 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
                      *         Y Signal Info instead of iterating over preprocessing 
                      *         function pointers.
                      */
-                    rt_preProcessAndLogData(yInfo[i], val, data[dataIdx], isVarDims[0]);
+                    rt_LogTXYSignal(snap, &yInfo[i], -1, val, data[dataIdx], isVarDims[0]);
                     dataIdx++;
                     val = val->next;
                 }
             }
         }
         /* final state */
-        if (logInfo->xFinal != NULL) {
+        if (logInfo->xFinal != NULL && (parts & LOG_UPDATE_XFINAL)) {
             StructLogVar *xf  = logInfo->xFinal;
             LogVar       *val = xf->signals.values;
             int_T        nsig = xf->signals.numSignals;
@@ -4087,7 +5867,7 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
 
             /* time */
             if (xf->logTime) {
-                rt_UpdateLogVar(xf->time, tPtr, false);
+                rt_LogTXYSignal(snap, NULL, 0, xf->time, tPtr, false);
             }
 
             /* signals */
@@ -4098,174 +5878,1782 @@ const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T upda
                  *         X Signal Info instead of iterating over preprocessing 
                  *         function pointers.
                  */
-                rt_preProcessAndLogDataWithIndex(xInfo, i, val, data[i], false);
+                rt_LogTXYSignal(snap, xInfo, i, val, data[i], false);
                 val = val->next;
             }
         }
     }
     return(NULL);
-} /* end rt_UpdateTXXFYLogVars */
-
+} /* end rt_LogTXXFYVars */
 
-#ifdef __cplusplus
-}
-#endif
-          
-
-          
-
-#ifdef __cplusplus
-extern "C" {
-#endif
+#ifdef LOGGING_PTHREADS
 
-
-/* Function: rt_StopDataLoggingImpl =======================================
+/* Function: rt_WakeLoggerThread ===============================================
  * Abstract:
- *	Write logged data to model.mat and free memory.
+ *      Wake the logger thread if it sleeps on an empty ring. Called by the
+ *      model thread after it moved head or set stop; the sequentially
+ *      consistent accesses to head, stop and sleeping make sure that either
+ *      the logger thread sees the change before it sleeps or it is woken.
  */
-void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRaccel)
+static void rt_WakeLoggerThread(LogRing *ring)
 {
-    FILE          *fptr;
-    LogInfo       *logInfo     = (LogInfo*) rtliGetLogInfo(li);
-    LogVar        *var         = logInfo->logVarsList;
-    StructLogVar  *svar        = logInfo->structLogVarsList;
-    /* At this time, verbose is only needed if running rapid accelerator
-     * simulations. */
-    int           verbose      = isRaccel ? 0: 1;
-
-    boolean_T     emptyFile    = 1; /* assume */
-    boolean_T     errFlag      = 0;
-    const char_T  *msg;
-
-    /*******************************
-     * Create MAT file with header *
-     *******************************/
-    if ((fptr=fopen(file,"w+b")) == NULL) {
-        (void)fprintf(stderr,"*** Error opening %s",file);
-        goto EXIT_POINT;
-    }
-    if (rt_WriteMat5FileHeader(fptr)) {
-        (void)fprintf(stderr,"*** Error writing to %s",file);
-        goto EXIT_POINT;
+    if (__atomic_load_n(&ring->sleeping, __ATOMIC_SEQ_CST)) {
+        (void)pthread_mutex_lock(&ring->lock);
+        (void)pthread_cond_signal(&ring->wake);
+        (void)pthread_mutex_unlock(&ring->lock);
     }
 
-    /**************************************************
-     * First log all the variables in the LogVar list *
-     **************************************************/
-    while (var != NULL) {
-        if ( (msg = rt_FixupLogVar(var,verbose)) != NULL ) {
-            (void)fprintf(stderr,"*** Error writing %s due to: %s\n",file,msg);
-            errFlag = 1;
-            break;
-        }
-        if (var->nDataPoints > 0 || isRaccel) {
-            MatItem item;
+} /* end rt_WakeLoggerThread */
 
-            item.type   = matMATRIX;
-            item.nbytes = 0; /* not yet known */
-            item.data   = &(var->data);
-            if (rt_WriteItemToMatFile(fptr, &item, MATRIX_ITEM)) {
-                (void)fprintf(stderr,"*** Error writing log variable %s to "
-                              "file %s",var->data.name, file);
-                errFlag = 1;
-                break;
-            }
-            emptyFile = 0;
-        }
-        var = var->next;
-    }
-    /* free up some memory by destroying the log var list here */
-    rt_DestroyLogVar(logInfo->logVarsList);
-    logInfo->logVarsList = NULL;
 
-    /*******************************************************
-     * Next log all the variables in the StructLogVar list *
-     *******************************************************/
-    while (svar != NULL) {
-        MatItem item;
+/* Function: rt_LoggerThread ===================================================
+ * Abstract:
+ *      Body of the logger thread: log the snapshots pushed on the ring by
+ *      rt_UpdateTXXFYLogVars, in order, until logging stops and the ring is
+ *      empty, sleeping while the ring is empty. After an error the remaining
+ *      snapshots are dropped.
+ */
+static void *rt_LoggerThread(void *arg)
+{
+    LogRing       *ring = (LogRing *)arg;
+    unsigned long tail  = ring->tail;
 
-        if (svar->logTime) {
-            var = svar->time;
-            if ( (msg = rt_FixupLogVar(var,verbose)) != NULL ) {
-                (void)fprintf(stderr, "*** Error writing %s due to: %s\n",
-                              file, msg);
-                errFlag = 1;
+    for (;;) {
+        if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+            if (__atomic_load_n(&ring->stop, __ATOMIC_ACQUIRE) &&
+                tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
                 break;
             }
-        }
-
-        var = svar->signals.values;
-        while (var) {
-            if ( (msg = rt_FixupLogVar(var,verbose)) != NULL ) {
-                (void)fprintf(stderr, "*** Error writing %s due to: %s\n",
-                              file, msg);
-                errFlag = 1;
-                break;
+            (void)pthread_mutex_lock(&ring->lock);
+            __atomic_store_n(&ring->sleeping, 1, __ATOMIC_SEQ_CST);
+            while (tail == __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) &&
+                   !__atomic_load_n(&ring->stop, __ATOMIC_SEQ_CST)) {
+                (void)pthread_cond_wait(&ring->wake, &ring->lock);
             }
-            var = var->next;
+            __atomic_store_n(&ring->sleeping, 0, __ATOMIC_RELAXED);
+            (void)pthread_mutex_unlock(&ring->lock);
+            continue;
         }
 
-        item.type   = matMATRIX;
-        item.nbytes = 0; /* not yet known */
-        item.data   = svar;
-
-        if (rt_WriteItemToMatFile(fptr, &item, STRUCT_LOG_VAR_ITEM)) {
-            (void)fprintf(stderr,"*** Error writing structure log variable "
-                          "%s to file %s",svar->name, file);
-            errFlag = 1;
-            break;
-        }
-        emptyFile = 0;
+        if (ring->errMsg == NULL) {
+            const char_T *errMsg;
+            LogSnapshot  snap;
 
-        svar = svar->next;
-    }
+            snap.mode   = LOG_SNAPSHOT_REPLAY;
+            snap.base   = ring->slots + (tail % ring->nSlots)*ring->slotBytes;
+            snap.offset = LOG_SNAPSHOT_HEADER;
 
-    /******************
-     * Close the file *
-     ******************/
-    (void)fclose(fptr);
-    if (emptyFile || errFlag) {
-        (void)remove(file);
-    } else {
-        if( verbose ) {
-            (void)printf("** created %s **\n\n", file);
+            errMsg = rt_LogTXXFYVars(ring->li, NULL, *(int_T *)snap.base,
+                                     &snap);
+            if (errMsg != NULL) {
+                __atomic_store_n(&ring->errMsg, errMsg, __ATOMIC_RELEASE);
+            }
         }
+        __atomic_store_n(&ring->tail, ++tail, __ATOMIC_RELEASE);
     }
+    return(NULL);
 
- EXIT_POINT:
+} /* end rt_LoggerThread */
 
-    /****************
-     * free logInfo *
-     ****************/
-    rt_DestroyLogVar(logInfo->logVarsList);
-    logInfo->logVarsList = NULL;
-    rt_DestroyStructLogVar(logInfo->structLogVarsList);
-    logInfo->structLogVarsList = NULL;
-    FREE(logInfo->y);
-    logInfo->y = NULL;
-    FREE(logInfo);
-    rtliSetLogInfo(li,NULL);
 
-} /* end rt_StopDataLoggingImpl */
+/* Function: rt_PushLogRing ====================================================
+ * Abstract:
+ *      Copy the signals logged by rt_UpdateTXXFYLogVars into the next free
+ *      slot of the ring, or copy the snapshot slot, taken by the trigger,
+ *      there. If the logger thread has fallen behind by a full ring, the
+ *      update is dropped and counted instead; all the T,X,Y variables then
+ *      miss the same time step.
+ *
+ *      Returns the error of the logger thread, if any.
+ */
+static const char_T *rt_PushLogRing(LogRing      *ring,
+                                    time_T       *tPtr,
+                                    int_T        parts,
+                                    const char_T *slot)
+{
+    unsigned long head = ring->head;
+    unsigned long used = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
 
+    if (used >= ring->nSlots) {
+        ring->nDropped++;
+    } else {
+        LogSnapshot snap;
 
-#ifdef __cplusplus
-}
-#endif
+        snap.mode   = LOG_SNAPSHOT_CAPTURE;
+        snap.base   = ring->slots + (head % ring->nSlots)*ring->slotBytes;
+        snap.offset = LOG_SNAPSHOT_HEADER;
+
+        if (slot != NULL) {
+            (void)memcpy(snap.base, slot, ring->slotBytes);
+        } else {
+            *(int_T *)snap.base = parts;
+            (void)rt_LogTXXFYVars(ring->li, tPtr, parts, &snap);
+        }
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+        if (used + 1 >= ring->wakeUsed) {
+            rt_WakeLoggerThread(ring);
+        }
 
+        if (used + 1 > ring->maxUsed) {
+            ring->maxUsed = used + 1;
+        }
+    }
+    return(__atomic_load_n(&ring->errMsg, __ATOMIC_ACQUIRE));
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+} /* end rt_PushLogRing */
 
 
-/* Function: rt_StopDataLogging ================================================
+/* Function: rt_StartLogRing ===================================================
  * Abstract:
- *	Write logged data to model.mat and free memory.
+ *      Size the ring for the T,X,Y variables and start the logger thread.
+ *      If that fails, the variables are logged on the model thread.
  */
-void rt_StopDataLogging(const char_T *file, RTWLogInfo *li)
+static void rt_StartLogRing(RTWLogInfo *li)
 {
-    rt_StopDataLoggingImpl(file,li,false);
+    LogInfo     *logInfo = rtliGetLogInfo(li);
+    LogRing     *ring;
+    LogSnapshot snap;
+
+    snap.mode   = LOG_SNAPSHOT_SIZE;
+    snap.base   = NULL;
+    snap.offset = LOG_SNAPSHOT_HEADER;
+    (void)rt_LogTXXFYVars(li, NULL, LOG_UPDATE_TXY | LOG_UPDATE_XFINAL, &snap);
+    if (snap.offset == LOG_SNAPSHOT_HEADER) {
+        return; /* no T,X,Y variables */
+    }
+
+    if ((ring = calloc(1, sizeof(LogRing))) == NULL) goto ERROR_EXIT;
+    ring->li        = li;
+    ring->slotBytes = snap.offset;
+    ring->nSlots    = LOGGING_RING_SLOTS;
+    if (ring->nSlots > LOGGING_RING_MAX_BYTES / ring->slotBytes) {
+        ring->nSlots = LOGGING_RING_MAX_BYTES / ring->slotBytes;
+    }
+    if (ring->nSlots < 2) {
+        ring->nSlots = 2;
+    }
+    ring->wakeUsed = (ring->nSlots + LOGGING_RING_WAKE_DIV - 1) /
+                     LOGGING_RING_WAKE_DIV;
+    if ((ring->slots = malloc(ring->nSlots*ring->slotBytes)) == NULL) {
+        goto ERROR_EXIT;
+    }
+    if (pthread_mutex_init(&ring->lock, NULL) != 0) goto ERROR_EXIT;
+    if (pthread_cond_init(&ring->wake, NULL) != 0) {
+        (void)pthread_mutex_destroy(&ring->lock);
+        goto ERROR_EXIT;
+    }
+    if (pthread_create(&ring->thread, NULL, rt_LoggerThread, ring) != 0) {
+        (void)pthread_cond_destroy(&ring->wake);
+        (void)pthread_mutex_destroy(&ring->lock);
+        goto ERROR_EXIT;
+    }
+    logInfo->ring = ring;
+    return;
+
+ ERROR_EXIT:
+    (void)fprintf(stderr, "*** Could not start the logging thread, logging "
+                  "on the model thread\n");
+    if (ring != NULL) {
+        FREE(ring->slots);
+        free(ring);
+    }
+
+} /* end rt_StartLogRing */
+
+
+/* Function: rt_StopLogRing ====================================================
+ * Abstract:
+ *      Wait for the logger thread to log what is left on the ring, then free
+ *      the ring. Report an error of the logger thread, which may have hit it
+ *      after the last rt_PushLogRing, and the updates dropped with the ring
+ *      full. These are also logged as the scalar droppedLogUpdates, so that
+ *      the MAT-file shows that its T,X,Y variables miss time steps.
+ */
+static void rt_StopLogRing(LogInfo *logInfo, int verbose)
+{
+    LogRing      *ring = logInfo->ring;
+    const char_T *errMsg;
+
+    if (ring == NULL) return;
+
+    __atomic_store_n(&ring->stop, 1, __ATOMIC_SEQ_CST);
+    rt_WakeLoggerThread(ring);
+    (void)pthread_join(ring->thread, NULL);
+    (void)pthread_cond_destroy(&ring->wake);
+    (void)pthread_mutex_destroy(&ring->lock);
+
+    if ((errMsg = __atomic_load_n(&ring->errMsg, __ATOMIC_ACQUIRE)) != NULL) {
+        (void)fprintf(stderr, "*** Error logging on the logging thread, the "
+                      "updates after it were dropped: %s\n", errMsg);
+    }
+
+    if (ring->nDropped > 0) {
+        const char_T *errStatus = NULL;
+        real_T       nDropped   = (real_T)ring->nDropped;
+        int_T        one        = 1;
+        LogVar       *var;
+
+        (void)fprintf(stderr, "*** %lu logging updates were dropped because "
+                      "the logging thread fell behind\n"
+                      "    (ring of %lu slots, at most %lu in use)\n",
+                      ring->nDropped, ring->nSlots, ring->maxUsed);
+        var = rt_CreateLogVar(ring->li, 0.0, 0.0, 0.0, &errStatus,
+                              "droppedLogUpdates", SS_DOUBLE, 0, 0, 0, 1, 1,
+                              &one, NO_LOGVALDIMS, NULL, NULL, 1, 1, 0.0, 1);
+        if (var != NULL) {
+            rt_UpdateLogVar(var, &nDropped, 0);
+        } else if (verbose) {
+            (void)fprintf(stderr, "*** Could not log droppedLogUpdates: %s\n",
+                          errStatus != NULL ? errStatus : "");
+        }
+    }
+
+    free(ring->slots);
+    free(ring);
+    logInfo->ring = NULL;
+
+} /* end rt_StopLogRing */
+
+#endif /* LOGGING_PTHREADS */
+
+ 
+/* Function: rt_LogTXYUpdate ===================================================
+ * Abstract:
+ *      Log the parts (LOG_UPDATE_*) of one update, read from the signals or,
+ *      if slot is not NULL, from the snapshot in it. With LOGGING_THREAD,
+ *      the update is pushed on the logging ring instead.
+ */
+static const char_T *rt_LogTXYUpdate(RTWLogInfo   *li,
+                                     time_T       *tPtr,
+                                     int_T        parts,
+                                     const char_T *slot)
+{
+#ifdef LOGGING_PTHREADS
+    LogRing *ring = ((LogInfo *)rtliGetLogInfo(li))->ring;
+
+    if (ring != NULL) {
+        return(rt_PushLogRing(ring, tPtr, parts, slot));
+    }
+#endif
+#ifdef LOGGING_SNAPSHOTS
+    if (slot != NULL) {
+        LogSnapshot snap;
+
+        snap.mode   = LOG_SNAPSHOT_REPLAY;
+        snap.base   = (char_T *)slot;
+        snap.offset = LOG_SNAPSHOT_HEADER;
+        return(rt_LogTXXFYVars(li, NULL, *(const int_T *)slot, &snap));
+    }
+#else
+    (void)slot;
+#endif
+    return(rt_LogTXXFYVars(li, tPtr, parts, NULL));
+
+} /* end rt_LogTXYUpdate */
+
+
+#ifdef LOGGING_TRIGGER
+
+/* Function: rt_CheckLogTrigger ================================================
+ * Abstract:
+ *      Return true if the update at time t is a trigger event: the predicate
+ *      of the trigger holds or, without one, an element of the trigger
+ *      signal crossed the level since the previous update (the test of
+ *      UploadCheckTriggerSignals in updown.c).
+ */
+static boolean_T rt_CheckLogTrigger(LogTrigger *trigger, time_T t)
+{
+    const LogTriggerSpec *spec    = &trigger->spec;
+    const real_T         *sig     = spec->signal;
+    const real_T         *oldSig  = trigger->oldSigVals;
+    real_T               level    = spec->level;
+    boolean_T            event    = false;
+    int_T                j;
+
+    if (spec->fcn != NULL) {
+        return(spec->fcn(spec->userData, t));
+    }
+
+    if (trigger->haveOldSigVals) {
+        for (j = 0; j < spec->width && !event; j++) {
+            if (spec->lookForRising &&
+                (((sig[j] >= level) && (oldSig[j] <  level)) ||
+                 ((sig[j] >  level) && (oldSig[j] == level)))) {
+                event = true;
+            }
+            if (spec->lookForFalling &&
+                (((sig[j] <  level) && (oldSig[j] >= level)) ||
+                 ((sig[j] == level) && (oldSig[j] >  level)))) {
+                event = true;
+            }
+        }
+    }
+    (void)memcpy(trigger->oldSigVals, sig, spec->width*sizeof(real_T));
+    trigger->haveOldSigVals = true;
+    return(event);
+
+} /* end rt_CheckLogTrigger */
+
+
+/* Function: rt_FlushLogTrigger ================================================
+ * Abstract:
+ *      Log the snapshots of the pre-trigger ring, oldest first, and empty the
+ *      ring. If backgroundOnly, the snapshots of the updates that are not
+ *      background updates are dropped instead.
+ */
+static const char_T *rt_FlushLogTrigger(RTWLogInfo *li,
+                                        LogTrigger *trigger,
+                                        boolean_T  backgroundOnly)
+{
+    const char_T *errMsg = NULL;
+
+    for ( ; trigger->nUsed > 0; trigger->nUsed--) {
+        int_T idx = trigger->head;
+
+        trigger->head = (idx + 1) % trigger->spec.preTrigger;
+        if (errMsg == NULL &&
+            (!backgroundOnly || trigger->isBackground[idx])) {
+            errMsg = rt_LogTXYUpdate(li, NULL, 0,
+                                     trigger->slots + idx*trigger->slotBytes);
+        }
+    }
+    return(errMsg);
+
+} /* end rt_FlushLogTrigger */
+
+
+/* Function: rt_PushLogTrigger =================================================
+ * Abstract:
+ *      Capture the T,X,Y signals of an update into the pre-trigger ring. If
+ *      the ring is full, its oldest snapshot makes room and is logged if it
+ *      is a background update, so the log stays in time order.
+ */
+static const char_T *rt_PushLogTrigger(RTWLogInfo *li,
+                                       LogTrigger *trigger,
+                                       time_T     *tPtr,
+                                       boolean_T  background)
+{
+    const char_T *errMsg = NULL;
+    int_T        nSlots  = trigger->spec.preTrigger;
+    int_T        idx;
+    LogSnapshot  snap;
+
+    if (trigger->nUsed == nSlots) {
+        idx           = trigger->head;
+        trigger->head = (idx + 1) % nSlots;
+        trigger->nUsed--;
+        if (trigger->isBackground[idx]) {
+            errMsg = rt_LogTXYUpdate(li, NULL, 0,
+                                     trigger->slots + idx*trigger->slotBytes);
+        }
+    }
+    idx = (trigger->head + trigger->nUsed) % nSlots;
+
+    snap.mode   = LOG_SNAPSHOT_CAPTURE;
+    snap.base   = trigger->slots + idx*trigger->slotBytes;
+    snap.offset = LOG_SNAPSHOT_HEADER;
+    *(int_T *)snap.base = LOG_UPDATE_TXY;
+    (void)rt_LogTXXFYVars(li, tPtr, LOG_UPDATE_TXY, &snap);
+
+    trigger->isBackground[idx] = background;
+    trigger->nUsed++;
+    return(errMsg);
+
+} /* end rt_PushLogTrigger */
+
+
+/* Function: rt_UpdateLogTrigger ===============================================
+ * Abstract:
+ *      Evaluate the trigger at an update of the T,X,Y variables, and log the
+ *      update if it falls in a window: from preTrigger updates before an
+ *      event to duration updates after the last event of the window. The
+ *      other updates pass through the pre-trigger ring, out of which only
+ *      the background updates are logged. xFinal is updated every time.
+ */
+static const char_T *rt_UpdateLogTrigger(RTWLogInfo *li,
+                                         LogTrigger *trigger,
+                                         time_T     *tPtr)
+{
+    LogInfo              *logInfo   = rtliGetLogInfo(li);
+    const LogTriggerSpec *spec      = &trigger->spec;
+    boolean_T            event      = rt_CheckLogTrigger(trigger, *tPtr);
+    boolean_T            background = (spec->background > 0 &&
+                                       trigger->nUpdates % spec->background == 0);
+    const char_T         *errMsg    = NULL;
+    int_T                parts;
+
+    trigger->nUpdates++;
+
+    /* end of the window, then of the hold off */
+    if (trigger->state == TRIGGER_FIRED && !event) {
+        if (trigger->count > 0) {
+            trigger->count--;
+        } else if (spec->holdOff < 0) {
+            trigger->state = TRIGGER_UNARMED;
+        } else {
+            trigger->state = TRIGGER_HOLDING_OFF;
+            trigger->count = spec->holdOff;
+        }
+    }
+    if (trigger->state == TRIGGER_HOLDING_OFF) {
+        if (trigger->count > 0) {
+            trigger->count--;
+        } else {
+            trigger->state = TRIGGER_ARMED;
+        }
+    }
+
+    /* an event opens a window with the pre-trigger updates */
+    if (trigger->state == TRIGGER_ARMED && event) {
+        trigger->state = TRIGGER_FIRED;
+        trigger->nWindows++;
+        errMsg = rt_FlushLogTrigger(li, trigger, false);
+    }
+
+    if (trigger->state == TRIGGER_FIRED) {
+        if (event) {
+            trigger->count = spec->duration;
+        }
+        parts = LOG_UPDATE_TXY | LOG_UPDATE_XFINAL;
+    } else if (trigger->state == TRIGGER_UNARMED || spec->preTrigger == 0) {
+        parts = background ? (LOG_UPDATE_TXY | LOG_UPDATE_XFINAL) :
+            LOG_UPDATE_XFINAL;
+    } else {
+        errMsg = rt_PushLogTrigger(li, trigger, tPtr, background);
+        parts  = LOG_UPDATE_XFINAL;
+    }
+
+    if (errMsg == NULL &&
+        (parts != LOG_UPDATE_XFINAL || logInfo->xFinal != NULL)) {
+        errMsg = rt_LogTXYUpdate(li, tPtr, parts, NULL);
+    }
+    return(errMsg);
+
+} /* end rt_UpdateLogTrigger */
+
+
+/* Function: rt_FreeLogTrigger =================================================
+ * Abstract:
+ *      Free a trigger set by rt_SetLogTrigger.
+ */
+static void rt_FreeLogTrigger(LogTrigger *trigger)
+{
+    FREE(trigger->oldSigVals);
+    FREE(trigger->slots);
+    FREE(trigger->isBackground);
+    free(trigger);
+
+} /* end rt_FreeLogTrigger */
+
+
+/* Function: rt_SetLogTrigger ==================================================
+ * Abstract:
+ *      From now on, log the T,X,Y variables only around the trigger events
+ *      described by spec, plus a background. Call after rt_StartDataLogging
+ *      and before the first update, from the thread that calls
+ *      rt_UpdateTXXFYLogVars. The trigger is armed at once.
+ *
+ *      Returns NULL upon success, else an error message; the variables are
+ *      then logged at every update.
+ */
+const char_T *rt_SetLogTrigger(RTWLogInfo *li, const LogTriggerSpec *spec)
+{
+    LogInfo     *logInfo = rtliGetLogInfo(li);
+    LogTrigger  *trigger;
+    LogSnapshot snap;
+
+    if (logInfo == NULL) {
+        return("Data logging has not been started");
+    }
+    if (logInfo->trigger != NULL) {
+        return("The log trigger is already set");
+    }
+    if ((spec->fcn == NULL && (spec->signal == NULL || spec->width <= 0)) ||
+        spec->preTrigger < 0 || spec->duration < 0 || spec->background < 0) {
+        return("Invalid log trigger");
+    }
+
+    /* a snapshot has the size of a logging ring slot, see rt_PushLogRing */
+    snap.mode   = LOG_SNAPSHOT_SIZE;
+    snap.base   = NULL;
+    snap.offset = LOG_SNAPSHOT_HEADER;
+    (void)rt_LogTXXFYVars(li, NULL, LOG_UPDATE_TXY | LOG_UPDATE_XFINAL, &snap);
+    if (snap.offset == LOG_SNAPSHOT_HEADER) {
+        return(NULL); /* no T,X,Y variables */
+    }
+
+    if ((trigger = calloc(1, sizeof(LogTrigger))) == NULL) {
+        return(rtMemAllocError);
+    }
+    trigger->spec      = *spec;
+    trigger->state     = TRIGGER_ARMED;
+    trigger->slotBytes = snap.offset;
+
+    if (spec->fcn == NULL &&
+        (trigger->oldSigVals = malloc(spec->width*sizeof(real_T))) == NULL) {
+        goto ERROR_EXIT;
+    }
+    if (spec->preTrigger > 0) {
+        trigger->slots        = malloc(spec->preTrigger*trigger->slotBytes);
+        trigger->isBackground = malloc(spec->preTrigger*sizeof(boolean_T));
+        if (trigger->slots == NULL || trigger->isBackground == NULL) {
+            goto ERROR_EXIT;
+        }
+    }
+    logInfo->trigger = trigger;
+    return(NULL);
+
+ ERROR_EXIT:
+    rt_FreeLogTrigger(trigger);
+    return(rtMemAllocError);
+
+} /* end rt_SetLogTrigger */
+
+
+/* Function: rt_StopLogTrigger =================================================
+ * Abstract:
+ *      Log the background updates left in the pre-trigger ring and free the
+ *      trigger. If verbose, report the number of windows logged.
+ */
+static void rt_StopLogTrigger(RTWLogInfo *li, int verbose)
+{
+    LogInfo      *logInfo = rtliGetLogInfo(li);
+    LogTrigger   *trigger = logInfo->trigger;
+    const char_T *errMsg;
+
+    if (trigger == NULL) return;
+
+    if ((errMsg = rt_FlushLogTrigger(li, trigger, true)) != NULL) {
+        (void)fprintf(stderr, "*** Error logging the background updates: "
+                      "%s\n", errMsg);
+    }
+    if (verbose) {
+        (void)fprintf(stdout, "*** The log trigger fired %lu times\n",
+                      trigger->nWindows);
+    }
+    rt_FreeLogTrigger(trigger);
+    logInfo->trigger = NULL;
+
+} /* end rt_StopLogTrigger */
+
+#endif /* LOGGING_TRIGGER */
+
+
+#ifdef LOGGING_STATS
+
+static LoggingStats rtLoggingStatsAtStop;  /* see rt_GetLoggingStats */
+
+/* Function: rt_LogStatsNow ====================================================
+ * Abstract:
+ *      Monotonic time in seconds for the LOGGING_STATS timers (clock() is
+ *      wall time on Windows).
+ */
+static double rt_LogStatsNow(void)
+{
+#ifdef _WIN32
+    return((double)clock()/CLOCKS_PER_SEC);
+#else
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((double)ts.tv_sec + 1.0e-9*(double)ts.tv_nsec);
+#endif
+
+} /* end rt_LogStatsNow */
+
+
+/* Function: rt_AddLogVarStats =================================================
+ * Abstract:
+ *      Add the counts of a log variable to the totals and, if print, print
+ *      them as a row of the summary table.
+ */
+static void rt_AddLogVarStats(LoggingStats *stats,
+                              const LogVar *var,
+                              const char_T *name,
+                              int_T        print)
+{
+    stats->nLogVars++;
+    stats->total.nSamples += var->stats.nSamples;
+    stats->total.nBytes   += var->stats.nBytes;
+    stats->total.nGrows   += var->stats.nGrows;
+    stats->total.nWraps   += var->stats.nWraps;
+    if (print) {
+        (void)printf("    %-32s %12lu %14.0f %7lu %7lu\n", name,
+                     var->stats.nSamples, var->stats.nBytes,
+                     var->stats.nGrows, var->stats.nWraps);
+    }
+
+} /* end rt_AddLogVarStats */
+
+
+/* Function: rt_CollectLoggingStats ============================================
+ * Abstract:
+ *      Fill stats with the counts of all the log variables and the update
+ *      timers. If print, print them as the summary table.
+ */
+static void rt_CollectLoggingStats(const LogInfo *logInfo,
+                                   LoggingStats  *stats,
+                                   int_T         print)
+{
+    const LogVar       *var;
+    const StructLogVar *svar;
+    char_T             name[mxMAXNAM+32];
+    int_T              i;
+
+    (void)memset(stats, 0, sizeof(*stats));
+    stats->nUpdates         = logInfo->nUpdates;
+    stats->updateSeconds    = logInfo->updateSeconds;
+    stats->maxUpdateSeconds = logInfo->maxUpdateSeconds;
+
+    if (print) {
+        (void)printf("** Logging statistics **\n");
+        (void)printf("    %-32s %12s %14s %7s %7s\n",
+                     "variable", "samples", "bytes", "grows", "wraps");
+    }
+    for (var = logInfo->logVarsList; var != NULL; var = var->next) {
+        rt_AddLogVarStats(stats, var, var->data.name, print);
+    }
+    for (svar = logInfo->structLogVarsList; svar != NULL; svar = svar->next) {
+        if (svar->logTime) {
+            (void)sprintf(name, "%.*s.time", mxMAXNAM, svar->name);
+            rt_AddLogVarStats(stats, (const LogVar *)svar->time, name, print);
+        }
+        for (var = svar->signals.values, i = 1; var != NULL;
+             var = var->next, i++) {
+            (void)sprintf(name, "%.*s.signals(%d)", mxMAXNAM, svar->name, i);
+            rt_AddLogVarStats(stats, var, name, print);
+        }
+    }
+    if (print) {
+        (void)printf("    %-32s %12lu %14.0f %7lu %7lu\n", "total",
+                     stats->total.nSamples, stats->total.nBytes,
+                     stats->total.nGrows, stats->total.nWraps);
+        (void)printf("    %lu calls of rt_UpdateTXXFYLogVars took %.6f s "
+                     "(longest %.6f s)\n", stats->nUpdates,
+                     stats->updateSeconds, stats->maxUpdateSeconds);
+    }
+
+} /* end rt_CollectLoggingStats */
+
+
+/* Function: rt_ReportLoggingStats =============================================
+ * Abstract:
+ *      Called as logging stops, before the log variables are written and
+ *      freed: keep their counts for rt_GetLoggingStats and, if verbose,
+ *      print the summary table.
+ */
+static void rt_ReportLoggingStats(const LogInfo *logInfo, int verbose)
+{
+    rt_CollectLoggingStats(logInfo, &rtLoggingStatsAtStop, verbose);
+
+} /* end rt_ReportLoggingStats */
+
+
+/* Function: rt_FinishLoggingStats =============================================
+ * Abstract:
+ *      Called when the log file is written: record the time since t0 spent
+ *      stopping logging and, if verbose, print it.
+ */
+static void rt_FinishLoggingStats(double t0, int verbose)
+{
+    rtLoggingStatsAtStop.stopSeconds = rt_LogStatsNow() - t0;
+    if (verbose) {
+        (void)printf("    stopping the data logging took %.6f s\n\n",
+                     rtLoggingStatsAtStop.stopSeconds);
+    }
+
+} /* end rt_FinishLoggingStats */
+
+
+/* Function: rt_GetLogVarStats =================================================
+ * Abstract:
+ *      Return the counts of a log variable. With LOGGING_THREAD they are
+ *      updated by the logger thread, and only exact once logging stopped.
+ */
+void rt_GetLogVarStats(const LogVar *var, LogVarStats *stats)
+{
+    *stats = var->stats;
+
+} /* end rt_GetLogVarStats */
+
+
+/* Function: rt_GetLoggingStats ================================================
+ * Abstract:
+ *      Return the totals over all the log variables and the logging times:
+ *      those so far while logging, and those at the time logging stopped,
+ *      including stopSeconds, after rt_StopDataLogging.
+ */
+void rt_GetLoggingStats(RTWLogInfo *li, LoggingStats *stats)
+{
+    const LogInfo *logInfo = (const LogInfo *)rtliGetLogInfo(li);
+
+    if (logInfo != NULL) {
+        rt_CollectLoggingStats(logInfo, stats, 0);
+    } else {
+        *stats = rtLoggingStatsAtStop;
+    }
+
+} /* end rt_GetLoggingStats */
+
+#endif /* LOGGING_STATS */
+
+ 
+/* Function: rt_UpdateTXYLogVars ===============================================
+ * Abstract:
+ *	Update the xFinal,T,X,Y variables that are being logged.
+ */
+const char_T *rt_UpdateTXYLogVars(RTWLogInfo *li, time_T *tPtr)
+{
+    return rt_UpdateTXXFYLogVars(li, tPtr, true);
+}
+ 
+/* Function: rt_UpdateTXXFYLogVarsImpl =========================================
+ * Abstract:
+ *	Update xFinal and/or the T,X,Y variables, see rt_UpdateTXXFYLogVars.
+ */
+static const char_T *rt_UpdateTXXFYLogVarsImpl(RTWLogInfo *li,
+                                               time_T     *tPtr,
+                                               boolean_T  updateTXY)
+{
+#ifdef LOGGING_TRIGGER
+    LogTrigger *trigger = ((LogInfo *)rtliGetLogInfo(li))->trigger;
+
+    if (trigger != NULL && updateTXY) {
+        return(rt_UpdateLogTrigger(li, trigger, tPtr));
+    }
+#endif
+    return(rt_LogTXYUpdate(li, tPtr,
+                           updateTXY ? (LOG_UPDATE_TXY | LOG_UPDATE_XFINAL) :
+                           LOG_UPDATE_XFINAL, NULL));
+
+} /* end rt_UpdateTXXFYLogVarsImpl */
+
+ 
+/* Function: rt_UpdateTXXFYLogVars =============================================
+ * Abstract:
+ *	Update xFinal and/or the T,X,Y variables that are being logged. With
+ *      LOGGING_THREAD, the signals are copied to the logging ring and logged
+ *      by the logger thread; this must then always be called from the same
+ *      thread. With a log trigger (LOGGING_TRIGGER), the T,X,Y variables are
+ *      only logged around trigger events, see rt_UpdateLogTrigger. With
+ *      LOGGING_STATS, the calls are counted and timed.
+ */
+const char_T *rt_UpdateTXXFYLogVars(RTWLogInfo *li, time_T *tPtr, boolean_T updateTXY)
+{
+#ifdef LOGGING_STATS
+    LogInfo      *logInfo = (LogInfo *)rtliGetLogInfo(li);
+    double       t0       = rt_LogStatsNow();
+    const char_T *msg     = rt_UpdateTXXFYLogVarsImpl(li, tPtr, updateTXY);
+    double       dt       = rt_LogStatsNow() - t0;
+
+    ++logInfo->nUpdates;
+    logInfo->updateSeconds += dt;
+    if (dt > logInfo->maxUpdateSeconds) {
+        logInfo->maxUpdateSeconds = dt;
+    }
+    return(msg);
+#else
+    return(rt_UpdateTXXFYLogVarsImpl(li, tPtr, updateTXY));
+#endif
+
+} /* end rt_UpdateTXXFYLogVars */
+
+
+#ifdef __cplusplus
+}
+#endif
+          
+
+          
+
+/* Function: rt_FreeLogInfo ===================================================
+ * Abstract:
+ *	Destroy the log variables that are left and free the LogInfo.
+ */
+static void rt_FreeLogInfo(RTWLogInfo *li)
+{
+    LogInfo *logInfo = (LogInfo*) rtliGetLogInfo(li);
+
+    rt_DestroyLogVar(logInfo->logVarsList);
+    logInfo->logVarsList = NULL;
+    rt_DestroyStructLogVar(logInfo->structLogVarsList);
+    logInfo->structLogVarsList = NULL;
+    FREE(logInfo->y);
+    logInfo->y = NULL;
+    if (logInfo->xPlan != NULL) {
+        FREE(logInfo->xPlan->runs);
+        FREE(logInfo->xPlan);
+    }
+    FREE(logInfo);
+    rtliSetLogInfo(li,NULL);
+
+} /* end rt_FreeLogInfo */
+
+
+#ifdef LOGGING_MAT_WRITE_POOL
+
+/* Function: rt_FixupMatWriteJob ===============================================
+ * Abstract:
+ *	Fix up the log variables of a top level variable, see rt_FixupLogVar.
+ */
+static const char_T *rt_FixupMatWriteJob(MatWriteJob *job, int verbose)
+{
+    const char_T *msg = NULL;
+    StructLogVar *svar;
+    LogVar       *var;
+
+    if (job->itemKind == LOG_VAR_ITEM) {
+        return(rt_FixupLogVar((LogVar *)job->item.data, verbose));
+    }
+
+    svar = (StructLogVar *)job->item.data;
+    if (svar->logTime) {
+        msg = rt_FixupLogVar(svar->time, verbose);
+    }
+    for (var = svar->signals.values; var != NULL && msg == NULL;
+         var = var->next) {
+        msg = rt_FixupLogVar(var, verbose);
+    }
+    return(msg);
+
+} /* end rt_FixupMatWriteJob */
+
+
+/* Function: rt_MatWriteWorker =================================================
+ * Abstract:
+ *      Body of the threads of rt_WriteMatFileParallel: claim the jobs one at
+ *      a time and fix them up or write them. Each thread writes through a
+ *      stream of its own, positioned at the element of the job.
+ */
+static void *rt_MatWriteWorker(void *arg)
+{
+    MatWritePool *pool = (MatWritePool *)arg;
+    FILE         *fp   = NULL;
+    int_T        i;
+
+    while ((i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) <
+           pool->nJobs) {
+        MatWriteJob *job = &pool->jobs[i];
+
+        if (!pool->writing) {
+            job->fixupMsg = rt_FixupMatWriteJob(job, pool->verbose);
+        } else if (job->write) {
+            if (fp == NULL && (fp = fopen(pool->file, "r+b")) == NULL) {
+                job->writeErr = 1;
+                continue;
+            }
+            job->writeErr = (fseek(fp, job->start, SEEK_SET) != 0 ||
+                             rt_WriteItemToMatFile(fp, &job->item,
+                                                   job->itemKind) != 0 ||
+                             ftell(fp) != job->end);
+        }
+    }
+    if (fp != NULL && fclose(fp) != 0) {
+        __atomic_store_n(&pool->closeErr, 1, __ATOMIC_RELAXED);
+    }
+    return(NULL);
+
+} /* end rt_MatWriteWorker */
+
+
+/* Function: rt_RunMatWritePool ================================================
+ * Abstract:
+ *      Run the jobs of the pool on up to LOGGING_MAT_WRITE_THREADS threads,
+ *      the calling thread being one of them, and wait for them to finish.
+ */
+static void rt_RunMatWritePool(MatWritePool *pool)
+{
+    pthread_t threads[LOGGING_MAT_WRITE_THREADS];
+    int_T     nThreads = 0;
+    int_T     i;
+
+    pool->next = 0;
+    while (nThreads < LOGGING_MAT_WRITE_THREADS - 1 &&
+           nThreads < pool->nJobs - 1 &&
+           pthread_create(&threads[nThreads], NULL, rt_MatWriteWorker,
+                          pool) == 0) {
+        nThreads++;
+    }
+    (void)rt_MatWriteWorker(pool);
+    for (i = 0; i < nThreads; i++) {
+        (void)pthread_join(threads[i], NULL);
+    }
+
+} /* end rt_RunMatWritePool */
+
+
+/* Function: rt_WriteMatFileParallel ===========================================
+ * Abstract:
+ *      Write the variables of the LogVar and StructLogVar lists to the
+ *      MAT-file, whose header has been written to fptr, on a pool of
+ *      threads:
+ *        1) the log variables are fixed up in parallel,
+ *        2) the size of each variable is computed, which gives its offset
+ *           in the file, the variables being in the order they are written
+ *           in serially,
+ *        3) the variables are written in parallel, each at its offset.
+ *      The MAT-file is the same as the one written serially.
+ *
+ *      Return values is
+ *           -1 : the variables are to be written serially instead
+ *            0 : upon success
+ *            1 : upon failure
+ */
+static int_T rt_WriteMatFileParallel(const char_T *file,
+                                     FILE         *fptr,
+                                     LogInfo      *logInfo,
+                                     int          verbose,
+                                     boolean_T    isRaccel,
+                                     boolean_T    *emptyFile)
+{
+    MatWritePool pool;
+    LogVar       *var;
+    StructLogVar *svar;
+    long         pos;
+    int_T        errFlag = 0;
+    int_T        i;
+
+    (void)memset(&pool, 0, sizeof(pool));
+    pool.file    = file;
+    pool.verbose = verbose;
+
+    for (var = logInfo->logVarsList; var != NULL; var = var->next) {
+        pool.nJobs++;
+    }
+    for (svar = logInfo->structLogVarsList; svar != NULL; svar = svar->next) {
+        pool.nJobs++;
+    }
+    if (pool.nJobs < 2 || (pos = ftell(fptr)) < 0 || fflush(fptr) != 0 ||
+        (pool.jobs = calloc(pool.nJobs, sizeof(MatWriteJob))) == NULL) {
+        return(-1);
+    }
+
+    i = 0;
+    for (var = logInfo->logVarsList; var != NULL; var = var->next, i++) {
+        pool.jobs[i].item.type = matMATRIX;
+        pool.jobs[i].item.data = var;
+        pool.jobs[i].itemKind  = LOG_VAR_ITEM;
+    }
+    for (svar = logInfo->structLogVarsList; svar != NULL;
+         svar = svar->next, i++) {
+        pool.jobs[i].item.type = matMATRIX;
+        pool.jobs[i].item.data = svar;
+        pool.jobs[i].itemKind  = STRUCT_LOG_VAR_ITEM;
+    }
+
+    /****************************
+     * Fix up all the variables *
+     ****************************/
+    rt_RunMatWritePool(&pool);
+    for (i = 0; i < pool.nJobs; i++) {
+        if (pool.jobs[i].fixupMsg != NULL) {
+            (void)fprintf(stderr,"*** Error writing %s due to: %s\n",
+                          file, pool.jobs[i].fixupMsg);
+            errFlag = 1;
+        }
+    }
+    if (errFlag) goto EXIT_POINT;
+
+    /*****************************************
+     * Lay out the variables in the MAT-file *
+     *****************************************/
+    for (i = 0; i < pool.nJobs; i++) {
+        MatWriteJob *job = &pool.jobs[i];
+
+        job->write = (job->itemKind == STRUCT_LOG_VAR_ITEM ||
+                      ((const LogVar *)job->item.data)->nDataPoints > 0 ||
+                      isRaccel);
+        if (!job->write) continue;
+
+        if (rt_ProcessMatItem(NULL, &job->item, job->itemKind, 0)) {
+            (void)fprintf(stderr,"*** Error writing to %s",file);
+            errFlag = 1;
+            goto EXIT_POINT;
+        }
+        job->start = pos;
+        pos       += (long)(matTAG_SIZE + matINT64_ALIGN(job->item.nbytes));
+        job->end   = pos;
+        *emptyFile = 0;
+    }
+
+    /***********************
+     * Write the variables *
+     ***********************/
+    pool.writing = 1;
+    rt_RunMatWritePool(&pool);
+    for (i = 0; i < pool.nJobs; i++) {
+        const MatWriteJob *job = &pool.jobs[i];
+
+        if (!job->writeErr) continue;
+        if (job->itemKind == LOG_VAR_ITEM) {
+            (void)fprintf(stderr,"*** Error writing log variable %s to "
+                          "file %s",
+                          ((const LogVar *)job->item.data)->data.name, file);
+        } else {
+            (void)fprintf(stderr,"*** Error writing structure log variable "
+                          "%s to file %s",
+                          ((const StructLogVar *)job->item.data)->name, file);
+        }
+        errFlag = 1;
+    }
+    if (pool.closeErr) {
+        (void)fprintf(stderr,"*** Error writing to %s",file);
+        errFlag = 1;
+    }
+
+ EXIT_POINT:
+    free(pool.jobs);
+    return(errFlag);
+
+} /* end rt_WriteMatFileParallel */
+
+#endif /* LOGGING_MAT_WRITE_POOL */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Function: rt_StopDataLoggingImpl =======================================
+ * Abstract:
+ *	Write logged data to model.mat and free memory.
+ */
+void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T isRaccel)
+{
+    FILE          *fptr;
+    LogInfo       *logInfo     = (LogInfo*) rtliGetLogInfo(li);
+    LogVar        *var         = logInfo->logVarsList;
+    StructLogVar  *svar        = logInfo->structLogVarsList;
+    /* At this time, verbose is only needed if running rapid accelerator
+     * simulations. */
+    int           verbose      = isRaccel ? 0: 1;
+
+    boolean_T     emptyFile    = 1; /* assume */
+    boolean_T     errFlag      = 0;
+    const char_T  *msg;
+    MatFileWriter writer;
+#ifdef LOGGING_MAT_WRITE_POOL
+    int_T         parallelStat;
+#endif
+#ifdef LOGGING_STATS
+    double        t0           = rt_LogStatsNow();
+#endif
+
+#ifdef LOGGING_TRIGGER
+    rt_StopLogTrigger(li, verbose);
+#endif
+#ifdef LOGGING_PTHREADS
+    rt_StopLogRing(logInfo, verbose);
+#endif
+#ifdef LOGGING_STATS
+    rt_ReportLoggingStats(logInfo, verbose);
+#endif
+
+    /*******************************
+     * Create MAT file with header *
+     *******************************/
+    if ((fptr=fopen(file,"w+b")) == NULL) {
+        (void)fprintf(stderr,"*** Error opening %s",file);
+        goto EXIT_POINT;
+    }
+    if (rt_WriteMat5FileHeader(fptr)) {
+        (void)fprintf(stderr,"*** Error writing to %s",file);
+        goto EXIT_POINT;
+    }
+    (void)memset(&writer, 0, sizeof(writer));
+    writer.fp = fptr;
+
+#ifdef LOGGING_MAT_WRITE_POOL
+    parallelStat = rt_WriteMatFileParallel(file, fptr, logInfo, verbose,
+                                           isRaccel, &emptyFile);
+    if (parallelStat >= 0) {
+        errFlag = (parallelStat != 0);
+        var     = NULL;             /* already written */
+        svar    = NULL;
+    }
+#endif
+
+    /**************************************************
+     * First log all the variables in the LogVar list *
+     **************************************************/
+    while (var != NULL) {
+        if ( (msg = rt_FixupLogVar(var,verbose)) != NULL ) {
+            (void)fprintf(stderr,"*** Error writing %s due to: %s\n",file,msg);
+            errFlag = 1;
+            break;
+        }
+        if (var->nDataPoints > 0 || isRaccel) {
+            MatItem item;
+
+            item.type   = matMATRIX;
+            item.nbytes = 0; /* not yet known */
+            item.data   = var;
+            if (rt_WriteVarToMatFile(&writer, &item, LOG_VAR_ITEM)) {
+                (void)fprintf(stderr,"*** Error writing log variable %s to "
+                              "file %s",var->data.name, file);
+                errFlag = 1;
+                break;
+            }
+            emptyFile = 0;
+        }
+        var = var->next;
+    }
+    /* free up some memory by destroying the log var list here */
+    rt_DestroyLogVar(logInfo->logVarsList);
+    logInfo->logVarsList = NULL;
+
+    /*******************************************************
+     * Next log all the variables in the StructLogVar list *
+     *******************************************************/
+    while (svar != NULL) {
+        MatItem item;
+
+        if (svar->logTime) {
+            var = svar->time;
+            if ( (msg = rt_FixupLogVar(var,verbose)) != NULL ) {
+                (void)fprintf(stderr, "*** Error writing %s due to: %s\n",
+                              file, msg);
+                errFlag = 1;
+                break;
+            }
+        }
+
+        var = svar->signals.values;
+        while (var) {
+            if ( (msg = rt_FixupLogVar(var,verbose)) != NULL ) {
+                (void)fprintf(stderr, "*** Error writing %s due to: %s\n",
+                              file, msg);
+                errFlag = 1;
+                break;
+            }
+            var = var->next;
+        }
+
+        item.type   = matMATRIX;
+        item.nbytes = 0; /* not yet known */
+        item.data   = svar;
+
+        if (rt_WriteVarToMatFile(&writer, &item, STRUCT_LOG_VAR_ITEM)) {
+            (void)fprintf(stderr,"*** Error writing structure log variable "
+                          "%s to file %s",svar->name, file);
+            errFlag = 1;
+            break;
+        }
+        emptyFile = 0;
+
+        svar = svar->next;
+    }
+
+    /******************
+     * Close the file *
+     ******************/
+    if (rt_CloseMatFileWriter(&writer)) {
+        (void)fprintf(stderr,"*** Error writing to %s",file);
+        errFlag = 1;
+    }
+    (void)fclose(fptr);
+    if (emptyFile || errFlag) {
+        (void)remove(file);
+    } else {
+        if( verbose ) {
+            (void)printf("** created %s **\n\n", file);
+        }
+    }
+
+ EXIT_POINT:
+#ifdef LOGGING_STATS
+    rt_FinishLoggingStats(t0, verbose);
+#endif
+    rt_FreeLogInfo(li);
+
+} /* end rt_StopDataLoggingImpl */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef LOGGING_COLUMNAR
+
+/*
+ * Index of the columnar file being written. The signal descriptors and chunk
+ * table are filled in as the data is appended and written after it by
+ * rt_StopDataLoggingColumnar.
+ */
+typedef struct LogColWriter_Tag {
+    FILE         *fp;
+    long         pos;                  /* end of the data written so far     */
+    LogColSignal *signals;
+    LogColChunk  *chunks;
+    int32_T      *dims;
+    uint32_T     nSignals;
+    uint32_T     nChunks;
+    uint32_T     nDims;
+} LogColWriter;
+
+
+/* Function: rt_SetLogColOffset ================================================
+ * Abstract:
+ *      Store a file position as a LogColOffset.
+ */
+static void rt_SetLogColOffset(LogColOffset *offset, long pos)
+{
+    unsigned long upos = (unsigned long) pos;
+
+    offset->lo = (uint32_T)(upos & 0xFFFFFFFFUL);
+    offset->hi = (uint32_T)((upos >> 16) >> 16);
+
+} /* end rt_SetLogColOffset */
+
+
+/* Function: rt_CountLogColVar =================================================
+ * Abstract:
+ *      Add the index entries needed by a fixed up log variable to the totals.
+ */
+static void rt_CountLogColVar(const LogVar *var,
+                              uint32_T     *nSignals,
+                              uint32_T     *nChunks,
+                              uint32_T     *nDims)
+{
+    int_T chunkRows = LOGGING_COLUMNAR_CHUNK_ROWS;
+
+    *nSignals += 1;
+    *nChunks  += (uint32_T)((var->data.nRows + chunkRows - 1) / chunkRows);
+    *nDims    += (uint32_T) var->data.nDims;
+
+} /* end rt_CountLogColVar */
+
+
+/* Function: rt_GetLogColRows ==================================================
+ * Abstract:
+ *      Copy rows r0 to r0+n-1 of part 0 (real), 1 (imaginary) or 2
+ *      (valueDimensions) of a log variable fixed up by rt_FixupLogVar to buf,
+ *      one column of n elements after the other. The rows in memory are
+ *      found as rt_WriteLogVarPart finds them.
+ *
+ *      With LOGGING_STREAM the first nSpooledRows rows are read back from the
+ *      spool file (see rt_GetSpoolPartOffset), using stage (n rows) to
+ *      transpose them.
+ *
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_GetLogColRows(const LogVar *var,
+                              int_T        part,
+                              int_T        r0,
+                              int_T        n,
+                              char_T       *buf,
+                              char_T       *stage)
+{
+    int_T        rowMajor = (part < 2);
+    int_T        nCols    = rowMajor ? var->data.nCols : var->valDims->nCols;
+    size_t       elSize   = rowMajor ? var->data.elSize : sizeof(real_T);
+    int_T        memRow0  = 0;          /* row of the signal at the first row
+                                           in memory                          */
+    int_T        done     = 0;
+    int_T        j, k;
+
+#ifdef LOGGING_STREAM
+    if (var->nSpooledRows > 0) {
+        /* Left as logged: spool file blocks, then rowIdx rows in memory */
+        int_T blockRows = var->spoolBlockRows;
+
+        memRow0 = var->nSpooledRows;
+        while (done < n && r0 + done < var->nSpooledRows) {
+            int_T row = r0 + done;
+            int_T i   = row % blockRows;
+            int_T m   = blockRows - i;
+            SpoolOffset pos = rt_GetSpoolBlockOffset(var, row/blockRows) +
+                              rt_GetSpoolPartOffset(var,part);
+
+            if (m > n - done) m = n - done;
+            if (rowMajor) {
+                if (rt_SeekSpool(var->spool,
+                                 pos + (SpoolOffset)(i*nCols*elSize)) != 0 ||
+                    fread(stage, elSize, m*nCols, var->spool) !=
+                    (size_t)(m*nCols)) {
+                    return(1);
+                }
+                for (j = 0; j < nCols; j++) {
+                    for (k = 0; k < m; k++) {
+                        (void)memcpy(buf + (j*n + done + k)*elSize,
+                                     stage + (k*nCols + j)*elSize, elSize);
+                    }
+                }
+            } else {
+                for (j = 0; j < nCols; j++) {
+                    SpoolOffset col = (SpoolOffset)(j*blockRows + i)*elSize;
+
+                    if (rt_SeekSpool(var->spool, pos + col) != 0 ||
+                        fread(buf + (j*n + done)*elSize, elSize, m,
+                              var->spool) != (size_t)m) {
+                        return(1);
+                    }
+                }
+            }
+            done += m;
+        }
+    }
+#else
+    (void)stage;
+#endif
+
+    while (done < n) {
+        LogChunk chunk;
+        int_T    m;
+        int_T    idx = rt_LocateLogVarRow(var, r0 + done - memRow0, &chunk, &m);
+
+        if (m <= 0) return(1);
+        if (m > n - done) m = n - done;
+        for (j = 0; j < nCols; j++) {
+            char_T *dst = buf + (j*n + done)*elSize;
+
+            if (!rowMajor) {
+                (void)memcpy(dst, chunk.dimsData + (size_t)j*chunk.nRows + idx,
+                             m*elSize);
+            } else {
+                const char_T *src = (const char_T*)
+                    (part ? chunk.im : chunk.re) + (idx*nCols + j)*elSize;
+
+                for (k = 0; k < m; k++, src += nCols*elSize, dst += elSize) {
+                    (void)memcpy(dst, src, elSize);
+                }
+            }
+        }
+        done += m;
+    }
+    return(0);
+
+} /* end rt_GetLogColRows */
+
+
+/* Function: rt_WriteLogColBlock ===============================================
+ * Abstract:
+ *      Append nBytes of data to the columnar file, padded to 8 bytes, and
+ *      return its position in offset.
+ *
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_WriteLogColBlock(LogColWriter *w,
+                                 const void   *data,
+                                 size_t       nBytes,
+                                 LogColOffset *offset)
+{
+    static const char_T pad[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t              nPad   = LOGCOL_ALIGN(nBytes) - nBytes;
+
+    rt_SetLogColOffset(offset, w->pos);
+    if (fwrite(data, 1, nBytes, w->fp) != nBytes ||
+        (nPad > 0 && fwrite(pad, 1, nPad, w->fp) != nPad)) {
+        return(1);
+    }
+    w->pos += (long)(nBytes + nPad);
+    return(0);
+
+} /* end rt_WriteLogColBlock */
+
+
+/* Function: rt_WriteLogColPart ================================================
+ * Abstract:
+ *      Append part 0 (real), 1 (imaginary) or 2 (valueDimensions) of a chunk,
+ *      the nCols columns of n rows in buf. Parts of real_T values are
+ *      encoded into enc (see rt_logcolumnar_codec.h), the time vector with
+ *      delta-of-delta and the others with XOR, and stored encoded if that
+ *      makes them smaller.
+ *
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_WriteLogColPart(LogColWriter *w,
+                                LogColChunk  *chunk,
+                                int_T        part,
+                                const char_T *buf,
+                                char_T       *enc,
+                                int_T        n,
+                                int_T        nCols,
+                                size_t       elSize,
+                                int_T        isReal,
+                                int_T        isTime)
+{
+    LogColOffset *offset = (part == 0) ? &chunk->re :
+                           (part == 1) ? &chunk->im : &chunk->valDims;
+    size_t       nBytes  = n * nCols * elSize;
+
+#if LOGGING_COLUMNAR_ENCODE
+    if (isReal && nBytes > 0) {
+        size_t nEnc = rt_LogColEncode((const real_T*) buf, (uint32_T) n, nCols,
+                                      isTime, (uint8_T*) enc, nBytes - 1);
+        if (nEnc > 0) {
+            chunk->encoded      |= 1U << part;  /* LOGCOL_ENCODED_* */
+            chunk->nBytes[part]  = (uint32_T) nEnc;
+            return(rt_WriteLogColBlock(w, enc, nEnc, offset));
+        }
+    }
+#else
+    (void)enc;
+    (void)isReal;
+    (void)isTime;
+#endif
+    chunk->nBytes[part] = (uint32_T) nBytes;
+    return(rt_WriteLogColBlock(w, buf, nBytes, offset));
+
+} /* end rt_WriteLogColPart */
+
+
+/* Function: rt_WriteLogColVar =================================================
+ * Abstract:
+ *      Append the chunks of a fixed up log variable to the columnar file and
+ *      add its signal descriptor and chunks to the index.
+ *
+ *      timeSignal is the index of the time vector of the rows, -1 if none.
+ *      A signal whose index is timeSignal is a time vector: the time range of
+ *      its chunks is taken from its data. Other signals take the range of
+ *      the chunk of their time vector that has the same rows, so the time
+ *      vector has to be written first.
+ *
+ *      Return values is
+ *          == 0 : upon success
+ *          <> 0 : upon failure
+ */
+static int_T rt_WriteLogColVar(LogColWriter *w,
+                               const LogVar *var,
+                               const char_T *name,
+                               int32_T      timeSignal)
+{
+    LogColSignal *sig       = &w->signals[w->nSignals];
+    int32_T      sigIdx     = (int32_T) w->nSignals;
+    int_T        nRows      = var->data.nRows;
+    int_T        nCols      = var->data.nCols;
+    size_t       rowBytes   = nCols * var->data.elSize;
+    int_T        nValDims   = (var->valDims != NULL &&
+                               var->valDims->dimsData != NULL) ?
+                              var->valDims->nCols : 0;
+    int_T        chunkRows  = LOGGING_COLUMNAR_CHUNK_ROWS;
+    int_T        isReal     = (var->data.mxID == mxDOUBLE_CLASS &&
+                               var->data.elSize == sizeof(real_T));
+    char_T       *buf       = NULL;
+    char_T       *stage     = NULL;
+    char_T       *enc       = NULL;
+    int_T        r0, k;
+    int_T        retStat    = 1;
+
+    if (timeSignal >= 0 && timeSignal != sigIdx &&
+        w->signals[timeSignal].nRows != (uint32_T) nRows) {
+        timeSignal = -1;        /* rows do not match the time vector */
+    }
+    if (rowBytes < nValDims * sizeof(real_T)) {
+        rowBytes = nValDims * sizeof(real_T);
+    }
+
+    (void)memset(sig, 0, sizeof(*sig));
+    (void)strncpy(sig->name, name, LOGCOL_NAME_LEN-1);
+    sig->timeSignal = timeSignal;
+    sig->mxID       = (uint32_T) var->data.mxID;
+    sig->elSize     = (uint32_T) var->data.elSize;
+    sig->complex    = (var->data.complex != 0);
+    sig->logical    = (var->data.logical != 0);
+    sig->nCols      = nCols;
+    sig->nDims      = var->data.nDims;
+    sig->dims       = w->nDims;
+    sig->nValDims   = nValDims;
+    sig->nRows      = (uint32_T) nRows;
+    sig->chunkRows  = (uint32_T) chunkRows;
+    sig->chunk0     = w->nChunks;
+    for (k = 0; k < var->data.nDims; k++) {
+        w->dims[w->nDims++] = var->data.dims[k];
+    }
+
+    if (nRows > 0) {
+        if ((buf = malloc(chunkRows*rowBytes)) == NULL) goto EXIT_POINT;
+#if LOGGING_COLUMNAR_ENCODE
+        if ((enc = malloc(chunkRows*rowBytes)) == NULL) goto EXIT_POINT;
+#endif
+#ifdef LOGGING_STREAM
+        if ((stage = malloc(chunkRows*rowBytes)) == NULL) goto EXIT_POINT;
+#endif
+    }
+
+    for (r0 = 0; r0 < nRows; r0 += chunkRows) {
+        LogColChunk *chunk = &w->chunks[w->nChunks++];
+        int_T       n      = (nRows - r0 < chunkRows) ? nRows - r0 : chunkRows;
+
+        (void)memset(chunk, 0, sizeof(*chunk));
+        chunk->row0  = (uint32_T) r0;
+        chunk->nRows = (uint32_T) n;
+
+        if (rt_GetLogColRows(var, 0, r0, n, buf, stage)) goto EXIT_POINT;
+        if (timeSignal == sigIdx) {
+            const real_T *t = (const real_T*) buf;
+
+            chunk->tMin = chunk->tMax = t[0];
+            for (k = 1; k < n; k++) {
+                if (t[k] < chunk->tMin) chunk->tMin = t[k];
+                if (t[k] > chunk->tMax) chunk->tMax = t[k];
+            }
+        } else if (timeSignal >= 0) {
+            const LogColChunk *tChunk =
+                &w->chunks[w->signals[timeSignal].chunk0 + r0/chunkRows];
+
+            chunk->tMin = tChunk->tMin;
+            chunk->tMax = tChunk->tMax;
+        }
+        if (rt_WriteLogColPart(w, chunk, 0, buf, enc, n, nCols,
+                               var->data.elSize, isReal,
+                               timeSignal == sigIdx)) {
+            goto EXIT_POINT;
+        }
+        if (var->data.complex &&
+            (rt_GetLogColRows(var, 1, r0, n, buf, stage) ||
+             rt_WriteLogColPart(w, chunk, 1, buf, enc, n, nCols,
+                                var->data.elSize, isReal, 0))) {
+            goto EXIT_POINT;
+        }
+        if (nValDims > 0 &&
+            (rt_GetLogColRows(var, 2, r0, n, buf, stage) ||
+             rt_WriteLogColPart(w, chunk, 2, buf, enc, n, nValDims,
+                                sizeof(real_T), 1, 0))) {
+            goto EXIT_POINT;
+        }
+    }
+    sig->nChunks = w->nChunks - sig->chunk0;
+    w->nSignals++;
+    retStat = 0;
+
+  EXIT_POINT:
+    FREE(buf);
+    FREE(stage);
+    FREE(enc);
+    return(retStat);
+
+} /* end rt_WriteLogColVar */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Function: rt_StopDataLoggingColumnar ========================================
+ * Abstract:
+ *	Write logged data to a columnar log file (see rt_logcolumnar.h) and
+ *	free memory.
+ *
+ *	Time vectors are written before the signals they index: tout first,
+ *	then the other variables of the LogVar list (xout and yout take the
+ *	times of tout in matrix format), then for each structure its time and
+ *	its signals, named "name.time" and "name.signals(i).values".
+ */
+void rt_StopDataLoggingColumnar(const char_T *file, RTWLogInfo *li)
+{
+    LogInfo       *logInfo  = (LogInfo*) rtliGetLogInfo(li);
+    LogVar        *var;
+    StructLogVar  *svar;
+    LogColWriter  w;
+    LogColHeader  hdr;
+    uint32_T      nSignals  = 0;
+    uint32_T      nChunks   = 0;
+    uint32_T      nDims     = 0;
+    int32_T       tIdx      = -1;
+    boolean_T     errFlag   = 0;
+    const char_T  *msg      = NULL;
+    char_T        name[LOGCOL_NAME_LEN];
+#ifdef LOGGING_STATS
+    double        t0        = rt_LogStatsNow();
+#endif
+
+#ifdef LOGGING_TRIGGER
+    rt_StopLogTrigger(li, 1);
+#endif
+#ifdef LOGGING_PTHREADS
+    rt_StopLogRing(logInfo, 1);
+#endif
+#ifdef LOGGING_STATS
+    rt_ReportLoggingStats(logInfo, 1);
+#endif
+    (void)memset(&w, 0, sizeof(w));
+
+    /**********************************************
+     * Fix up all the variables to size the index *
+     **********************************************/
+    for (var = logInfo->logVarsList; var != NULL && msg == NULL;
+         var = var->next) {
+        if ((msg = rt_FixupLogVar(var,1)) == NULL && var->nDataPoints > 0) {
+            rt_CountLogColVar(var, &nSignals, &nChunks, &nDims);
+        }
+    }
+    for (svar = logInfo->structLogVarsList; svar != NULL && msg == NULL;
+         svar = svar->next) {
+        if (svar->logTime) {
+            var = svar->time;
+            if ((msg = rt_FixupLogVar(var,1)) != NULL) break;
+            rt_CountLogColVar(var, &nSignals, &nChunks, &nDims);
+        }
+        for (var = svar->signals.values; var != NULL && msg == NULL;
+             var = var->next) {
+            if ((msg = rt_FixupLogVar(var,1)) == NULL) {
+                rt_CountLogColVar(var, &nSignals, &nChunks, &nDims);
+            }
+        }
+    }
+    if (msg != NULL) {
+        (void)fprintf(stderr,"*** Error writing %s due to: %s\n",file,msg);
+        goto EXIT_POINT;
+    }
+    if (nSignals == 0) goto EXIT_POINT;
+
+    if ((w.signals = calloc(nSignals, sizeof(LogColSignal))) == NULL ||
+        (w.chunks = calloc(nChunks + 1, sizeof(LogColChunk))) == NULL ||
+        (w.dims = calloc(nDims + 1, sizeof(int32_T))) == NULL) {
+        (void)fprintf(stderr,"*** Error writing %s due to: %s\n",file,
+                      "memory allocation error");
+        goto EXIT_POINT;
+    }
+
+    /********************************************
+     * Create the file with a header to fill in *
+     ********************************************/
+    if ((w.fp = fopen(file,"w+b")) == NULL) {
+        (void)fprintf(stderr,"*** Error opening %s",file);
+        goto EXIT_POINT;
+    }
+    (void)memset(&hdr, 0, sizeof(hdr));
+    if (fwrite(&hdr, sizeof(hdr), 1, w.fp) != 1) {
+        errFlag = 1;
+        goto CLOSE_FILE;
+    }
+    w.pos = (long) sizeof(hdr);
+
+    /***************************
+     * Data of the LogVar list *
+     ***************************/
+    if (logInfo->t != NULL && logInfo->t->nDataPoints > 0) {
+        tIdx    = (int32_T) w.nSignals;
+        errFlag = (boolean_T) rt_WriteLogColVar(&w, logInfo->t,
+                                                logInfo->t->data.name, tIdx);
+    }
+    for (var = logInfo->logVarsList; var != NULL && !errFlag;
+         var = var->next) {
+        int32_T timeSignal = -1;
+        int_T   i;
+
+        if (var == logInfo->t || var->nDataPoints == 0) continue;
+        if ((void*) var == logInfo->x) timeSignal = tIdx;
+        for (i = 0; i < logInfo->ny; i++) {
+            if ((void*) var == logInfo->y[i]) timeSignal = tIdx;
+        }
+        errFlag = (boolean_T) rt_WriteLogColVar(&w, var, var->data.name,
+                                                timeSignal);
+    }
+
+    /*********************************
+     * Data of the StructLogVar list *
+     *********************************/
+    for (svar = logInfo->structLogVarsList; svar != NULL && !errFlag;
+         svar = svar->next) {
+        int32_T timeSignal = -1;
+        int_T   i          = 1;
+
+        if (svar->logTime) {
+            timeSignal = (int32_T) w.nSignals;
+            (void)sprintf(name, "%s.time", svar->name);
+            errFlag = (boolean_T) rt_WriteLogColVar(&w, svar->time, name,
+                                                    timeSignal);
+        }
+        for (var = svar->signals.values; var != NULL && !errFlag;
+             var = var->next, i++) {
+            (void)sprintf(name, "%s.signals(%d).values", svar->name, i);
+            errFlag = (boolean_T) rt_WriteLogColVar(&w, var, name, timeSignal);
+        }
+    }
+    if (errFlag) {
+        (void)fprintf(stderr,"*** Error writing to %s",file);
+        goto CLOSE_FILE;
+    }
+
+    /************************************
+     * Index, then the completed header *
+     ************************************/
+    (void)memcpy(hdr.magic, LOGCOL_MAGIC, sizeof(hdr.magic));
+    hdr.version   = LOGCOL_VERSION;
+    hdr.byteOrder = LOGCOL_BYTE_ORDER;
+    hdr.nSignals  = w.nSignals;
+    hdr.nChunks   = w.nChunks;
+    hdr.nDims     = w.nDims;
+    rt_SetLogColOffset(&hdr.indexOffset, w.pos);
+    if (fwrite(w.signals, sizeof(LogColSignal), w.nSignals, w.fp) !=
+        w.nSignals ||
+        fwrite(w.chunks, sizeof(LogColChunk), w.nChunks, w.fp) != w.nChunks ||
+        fwrite(w.dims, sizeof(int32_T), w.nDims, w.fp) != w.nDims ||
+        fseek(w.fp, 0L, SEEK_SET) != 0 ||
+        fwrite(&hdr, sizeof(hdr), 1, w.fp) != 1) {
+        (void)fprintf(stderr,"*** Error writing to %s",file);
+        errFlag = 1;
+    }
+
+  CLOSE_FILE:
+    if (fclose(w.fp) != 0) errFlag = 1;
+    if (errFlag) {
+        (void)remove(file);
+    } else {
+        (void)printf("** created %s **\n\n", file);
+    }
+
+  EXIT_POINT:
+    FREE(w.signals);
+    FREE(w.chunks);
+    FREE(w.dims);
+#ifdef LOGGING_STATS
+    rt_FinishLoggingStats(t0, 1);
+#endif
+    rt_FreeLogInfo(li);
+
+} /* end rt_StopDataLoggingColumnar */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOGGING_COLUMNAR */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Function: rt_StopDataLogging ================================================
+ * Abstract:
+ *	Write logged data to model.mat (model.rtl with LOGGING_COLUMNAR) and
+ *	free memory.
+ */
+void rt_StopDataLogging(const char_T *file, RTWLogInfo *li)
+{
+#ifdef LOGGING_COLUMNAR
+    /* model.mat -> model.rtl */
+    size_t len     = strlen(file);
+    char_T *rtlFile;
+
+    if (len >= 4 && strcmp(file + len - 4, ".mat") == 0) len -= 4;
+    if ((rtlFile = malloc(len + 5)) == NULL) {
+        (void)fprintf(stderr,"*** Error writing the log file: %s\n",
+                      "memory allocation error");
+        rt_StopDataLoggingImpl(file,li,false);
+        return;
+    }
+    (void)memcpy(rtlFile, file, len);
+    (void)strcpy(rtlFile + len, ".rtl");
+    rt_StopDataLoggingColumnar(rtlFile,li);
+    free(rtlFile);
+#else
+    rt_StopDataLoggingImpl(file,li,false);
+#endif
 
 } /* end rt_StopDataLogging */
 
@@ -13,6 +13,7 @@
 #if !defined(MAT_FILE) || (defined(MAT_FILE) && MAT_FILE == 1)
 
 #include <stddef.h>                     /* size_t */
+#include <stdio.h>                      /* FILE */
 #include "rtwtypes.h"
 #include "builtin_typeid_types.h"
 #include "multiword_types.h"
@@ -33,6 +34,9 @@
  */
 typedef double MatReal;                /* "real" data type used in model.mat  */
 typedef struct LogVar_Tag LogVar;
+typedef struct LogChunk_Tag LogChunk;
+typedef void (*LogVarCopyRowFcn)(LogVar *var, const char_T *data,
+                                 int_T frameIdx);
 typedef struct StructLogVar_Tag StructLogVar;
 
 typedef struct MatrixData_Tag {
@@ -74,6 +78,43 @@ typedef struct ValDimsData_Tag {
   real_T         *dimsData;          /* pointer to the value of dimension     */
 } ValDimsData;
 
+struct LogChunk_Tag {                 /* rows appended to a LogVar that was
+                                       * allocated too small (rt_ReallocLogVar)*/
+    int_T      row0;                  /* index of the first row in the chunk  */
+    int_T      nRows;                 /* number of rows in the chunk          */
+    void       *re;                   /* nRows x nCols, same layout as data.re*/
+    void       *im;                   /* imaginary part, if complex           */
+    real_T     *dimsData;             /* nRows x valDims->nCols, if var-size  */
+    LogChunk   *next;
+};
+
+#ifdef LOGGING_STATS
+/*
+ * Counts kept for each log variable with LOGGING_STATS, see
+ * rt_GetLogVarStats. A sample is one row of the variable.
+ */
+typedef struct LogVarStats_Tag {
+    unsigned long nSamples;           /* rows logged                          */
+    double        nBytes;             /* bytes stored for those rows          */
+    unsigned long nGrows;             /* chunks added by rt_ReallocLogVar     */
+    unsigned long nWraps;             /* times the circular buffer wrapped    */
+} LogVarStats;
+
+/*
+ * Totals over all the log variables and the time spent logging, see
+ * rt_GetLoggingStats.
+ */
+typedef struct LoggingStats_Tag {
+    int_T         nLogVars;           /* log variables, incl. struct fields   */
+    LogVarStats   total;              /* sum of their counts                  */
+    unsigned long nUpdates;           /* rt_UpdateTXXFYLogVars calls          */
+    double        updateSeconds;      /* time in rt_UpdateTXXFYLogVars        */
+    double        maxUpdateSeconds;   /* longest rt_UpdateTXXFYLogVars call   */
+    double        stopSeconds;        /* time in rt_StopDataLoggingImpl, 0
+                                         until logging has stopped            */
+} LoggingStats;
+#endif
+
 struct LogVar_Tag {
     MatrixData  data;                 /* Container for name, data etc.,       */
     ValDimsData *valDims;             /* field of valueDimensions
@@ -107,6 +148,33 @@ struct LogVar_Tag {
                                          (the size will be nDims in this case)
                                       */
 
+    int_T     nBaseRows;              /* rows in data.re/im and dimsData      */
+    LogChunk  *chunks;                /* rows nBaseRows..data.nRows-1, if the
+                                         buffer had to grow during the sim.
+                                         Written to the MAT-file in place.    */
+    LogChunk  *currChunk;             /* chunk holding rowIdx, NULL if rowIdx
+                                         is in the initial buffer             */
+
+    int_T     streaming;              /* LOGGING_STREAM: flush the buffer to
+                                         the spool file each time it fills
+                                         instead of growing or wrapping it    */
+    FILE      *spool;                 /* spool file, opened by the 1st flush  */
+    char_T    *spoolName;
+    int_T     spoolBlockRows;         /* rows per block in the spool file     */
+    int_T     spoolHeaderBytes;       /* size of the spool file header        */
+    int_T     spoolMaxBlocks;         /* blocks the spool file keeps, 0: all  */
+    int_T     spoolFirstBlock;        /* blocks overwritten by newer ones     */
+    int_T     nSpooledRows;           /* rows flushed to the spool file; they
+                                         precede the rowIdx rows in data.re   */
+
+    LogVarCopyRowFcn copyRow;         /* copies a fixed-size row of the signal
+                                         into the buffer, chosen when the var
+                                         is created. NULL if each element has
+                                         to be converted.                     */
+#ifdef LOGGING_STATS
+    LogVarStats stats;
+#endif
+
     LogVar    *next;
 };
 
@@ -137,6 +205,11 @@ struct StructLogVar_Tag {
     SignalsStruct signals;
     MatrixData    *blockName;
 
+    LogVar        **valueVars;       /* signals.values as an array             */
+    size_t        *valueOffsets;     /* offset of each signal in the data
+                                        passed to rt_UpdateStructLogVar; both
+                                        are built by its first call            */
+
     StructLogVar  *next;
 };
 
@@ -174,6 +247,32 @@ typedef enum {
     LOGVALDIMS_VARDIMS
 } LogValDimsStat;
 
+#ifdef LOGGING_TRIGGER
+/*
+ * Event triggered logging of the T,X,Y variables, see rt_SetLogTrigger. The
+ * counts are in updates of the T,X,Y variables (rt_UpdateTXYLogVars calls).
+ */
+typedef boolean_T (*LogTriggerFcn)(void *userData, time_T t);
+
+typedef struct LogTriggerSpec_Tag {
+  LogTriggerFcn  fcn;                /* event predicate evaluated at each
+                                        update, or NULL to look for crossings
+                                        of level by signal instead            */
+  void           *userData;          /* passed to fcn                         */
+  const real_T   *signal;            /* width elements, read at each update   */
+  int_T          width;
+  real_T         level;
+  boolean_T      lookForRising;
+  boolean_T      lookForFalling;
+  int_T          preTrigger;         /* updates logged before an event        */
+  int_T          duration;           /* updates logged after the last event   */
+  int_T          holdOff;            /* updates before the trigger re-arms
+                                        after a window, -1 for a one-shot     */
+  int_T          background;         /* log every background-th update
+                                        outside the windows, 0 for none       */
+} LogTriggerSpec;
+#endif
+
 
 
 #ifdef __cplusplus
@@ -265,6 +364,21 @@ extern void rt_StopDataLoggingImpl(const char_T *file, RTWLogInfo *li, boolean_T
 
 extern void rt_StopDataLogging(const char_T *file, RTWLogInfo *li);
 
+#ifdef LOGGING_TRIGGER
+extern const char_T *rt_SetLogTrigger(RTWLogInfo           *li,
+                                      const LogTriggerSpec *spec);
+#endif
+
+#ifdef LOGGING_COLUMNAR
+extern void rt_StopDataLoggingColumnar(const char_T *file, RTWLogInfo *li);
+#endif
+
+#ifdef LOGGING_STATS
+extern void rt_GetLogVarStats(const LogVar *var, LogVarStats *stats);
+
+extern void rt_GetLoggingStats(RTWLogInfo *li, LoggingStats *stats);
+#endif
+
 
 #ifdef __cplusplus
 }
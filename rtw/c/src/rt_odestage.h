@@ -0,0 +1,81 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_odestage.h
+ *
+ * Abstract:
+ *   Run-time ISA dispatch of the stage update loop shared by the fixed-step
+ *   Runge-Kutta solvers (ode3.c, ode5.c, ode8.c). The kernel of
+ *   rt_odestage_kernel.h is compiled for each ISA level of
+ *   rt_cpufeatures.h and the variant for the running processor is picked
+ *   on the first call. Set the RT_CPU_ISA environment variable to force a
+ *   lower level. Multiplies and adds are not contracted under the default
+ *   ISO C options, so every level produces the same states.
+ */
+
+#ifndef rt_odestage_h
+#define rt_odestage_h
+
+#include "tmwtypes.h"
+#include "rt_cpufeatures.h"
+
+/* States summed per stack buffer */
+#ifndef RT_ODE_STAGE_ROWS
+# define RT_ODE_STAGE_ROWS 128
+#endif
+
+typedef void (*rtODEStageKernel)(real_T *x, const real_T *y, real_T *const *f,
+                                 const real_T *hB, int_T nStages, int_T nXc);
+
+#define RT_ODE_NAME(f) f##_Generic
+#define RT_ODE_ATTR    RT_TARGET_GENERIC
+#include "rt_odestage_kernel.h"
+
+#if RT_CPU_DISPATCH
+# define RT_ODE_NAME(f) f##_Sse42
+# define RT_ODE_ATTR    RT_TARGET_SSE42
+# include "rt_odestage_kernel.h"
+# define RT_ODE_NAME(f) f##_Avx2
+# define RT_ODE_ATTR    RT_TARGET_AVX2
+# include "rt_odestage_kernel.h"
+# define RT_ODE_NAME(f) f##_Avx512
+# define RT_ODE_ATTR    RT_TARGET_AVX512
+# include "rt_odestage_kernel.h"
+#endif
+
+/* Function: rt_ODEStageUpdate =================================================
+ * Abstract:
+ *   x = y + f*hB over the first nStages derivative vectors in f, using the
+ *   kernel for the selected ISA level.
+ */
+static RT_CPU_UNUSED void rt_ODEStageUpdate(real_T        *x,
+                                            const real_T  *y,
+                                            real_T *const *f,
+                                            const real_T  *hB,
+                                            int_T          nStages,
+                                            int_T          nXc)
+{
+    static rtODEStageKernel kernel = NULL;
+
+    if (kernel == NULL) {
+        switch (rt_CpuSelectIsa(-1)) {
+#if RT_CPU_DISPATCH
+          case RT_ISA_AVX512:
+            kernel = rt_ODEStageKernel_Avx512;
+            break;
+          case RT_ISA_AVX2:
+            kernel = rt_ODEStageKernel_Avx2;
+            break;
+          case RT_ISA_SSE42:
+            kernel = rt_ODEStageKernel_Sse42;
+            break;
+#endif
+          default:
+            kernel = rt_ODEStageKernel_Generic;
+            break;
+        }
+    }
+    kernel(x, y, f, hB, nStages, nXc);
+}
+
+#endif /* rt_odestage_h */
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2019 The MathWorks, Inc.
+ *
+ * File: rt_odestage_kernel.h
+ *
+ * Abstract:
+ *   Stage update kernel of the explicit Runge-Kutta solvers, compiled by
+ *   rt_odestage.h once per ISA level. This file has no include guard;
+ *   define RT_ODE_NAME(f) and RT_ODE_ATTR before each inclusion.
+ */
+
+/* Function: RT_ODE_NAME(rt_ODEStageKernel) ====================================
+ * Abstract:
+ *   x = y + (f[0]*hB[0] + f[1]*hB[1] + ... + f[nStages-1]*hB[nStages-1]),
+ *   evaluated left to right for every state exactly as the scalar loops in
+ *   ode3.c and ode5.c. The sum is built for RT_ODE_STAGE_ROWS states at a
+ *   time in a stack buffer, so every derivative vector is streamed once
+ *   along contiguous memory.
+ */
+RT_ODE_ATTR static void RT_ODE_NAME(rt_ODEStageKernel)(real_T        *x,
+                                                       const real_T  *y,
+                                                       real_T *const *f,
+                                                       const real_T  *hB,
+                                                       int_T          nStages,
+                                                       int_T          nXc)
+{
+    real_T acc[RT_ODE_STAGE_ROWS];
+    int_T  i0;
+
+    for (i0 = 0; i0 < nXc; i0 += RT_ODE_STAGE_ROWS) {
+        const int_T nb = (nXc - i0 < RT_ODE_STAGE_ROWS) ?
+                         nXc - i0 : RT_ODE_STAGE_ROWS;
+        const real_T *f0 = f[0] + i0;
+        const real_T  hB0 = hB[0];
+        int_T i, s;
+
+        for (i = 0; i < nb; i++) {
+            acc[i] = f0[i]*hB0;
+        }
+        for (s = 1; s < nStages; s++) {
+            const real_T *fs  = f[s] + i0;
+            const real_T  hBs = hB[s];
+            for (i = 0; i < nb; i++) {
+                acc[i] += fs[i]*hBs;
+            }
+        }
+        for (i = 0; i < nb; i++) {
+            x[i0+i] = y[i0+i] + acc[i];
+        }
+    }
+}
+
+#undef RT_ODE_NAME
+#undef RT_ODE_ATTR
+
+/* [EOF] rt_odestage_kernel.h */